@@ -0,0 +1,39 @@
+// //////////////////////////////////////////////////////////
+// cpufeatures.hpp
+// runtime detection of the Intel SHA extensions
+//
+
+#pragma once
+
+// the SHA-NI kernels need GCC/Clang style target attributes and an x86 CPU
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HASHLIB_SHA_NI 1
+
+#include <cpuid.h>
+
+namespace hashlib
+{
+  /// true if the CPU has the SHA extensions (and the SSSE3/SSE4.1 they are used with)
+  inline bool detectShaExtensions()
+  {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+    // SSSE3 (pshufb) and SSE4.1 (pblendw, pextrd)
+    if (!(ecx & (1u << 9)) || !(ecx & (1u << 19)))
+      return false;
+
+    if (__get_cpuid_max(0, 0) < 7)
+      return false;
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & (1u << 29)) != 0;
+  }
+
+  /// detected once, then cached
+  inline bool hasShaExtensions()
+  {
+    static const bool has = detectShaExtensions();
+    return has;
+  }
+}
+#endif
@@ -5,6 +5,7 @@
 //
 
 #include "sha1.hpp"
+#include "cpufeatures.hpp"
 
 // big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
 #ifndef _MSC_VER
@@ -152,6 +153,106 @@ void SHA1::processBlock(const void* data)
 }
 
 
+#ifdef HASHLIB_SHA_NI
+#include <immintrin.h>
+
+namespace
+{
+  /// process numBlocks 64 byte blocks with the SHA extensions
+  __attribute__((target("sha,sse4.1,ssse3")))
+  void processBlocksShaNi(uint32_t hash[5], const uint8_t* data, size_t numBlocks)
+  {
+    // message words are big endian, the instructions want them in reverse order
+    const __m128i byteSwap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) hash), 0x1B);
+    __m128i e0   = _mm_set_epi32((int) hash[4], 0, 0, 0);
+    __m128i e1;
+
+    for (; numBlocks > 0; numBlocks--, data += 64)
+    {
+      const __m128i abcdSave = abcd;
+      const __m128i e0Save   = e0;
+
+      // the message schedule lives in 4 registers, quad i in msg[i % 4]
+      __m128i msg[4];
+      for (int i = 0; i < 20; i++)
+      {
+        __m128i& current = msg[i & 3];
+        if (i < 4)
+        {
+          current = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 16 * i)), byteSwap);
+        }
+        else
+        {
+          // W[t-16] ^ W[t-14] ^ W[t-8], then W[t-3] and the rotate
+          current = _mm_sha1msg1_epu32(current, msg[(i + 1) & 3]);
+          current = _mm_xor_si128(current, msg[(i + 2) & 3]);
+          current = _mm_sha1msg2_epu32(current, msg[(i + 3) & 3]);
+        }
+
+        // 4 rounds. e alternates between two registers
+        if (i == 0)
+        {
+          e0   = _mm_add_epi32(e0, current);
+          e1   = abcd;
+          abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+        }
+        else if (i & 1)
+        {
+          e1 = _mm_sha1nexte_epu32(e1, current);
+          e0 = abcd;
+          switch (i / 5)
+          {
+            case 0:  abcd = _mm_sha1rnds4_epu32(abcd, e1, 0); break;
+            case 1:  abcd = _mm_sha1rnds4_epu32(abcd, e1, 1); break;
+            case 2:  abcd = _mm_sha1rnds4_epu32(abcd, e1, 2); break;
+            default: abcd = _mm_sha1rnds4_epu32(abcd, e1, 3); break;
+          }
+        }
+        else
+        {
+          e0 = _mm_sha1nexte_epu32(e0, current);
+          e1 = abcd;
+          switch (i / 5)
+          {
+            case 0:  abcd = _mm_sha1rnds4_epu32(abcd, e0, 0); break;
+            case 1:  abcd = _mm_sha1rnds4_epu32(abcd, e0, 1); break;
+            case 2:  abcd = _mm_sha1rnds4_epu32(abcd, e0, 2); break;
+            default: abcd = _mm_sha1rnds4_epu32(abcd, e0, 3); break;
+          }
+        }
+      }
+
+      // the last round left the old abcd in e0
+      e0   = _mm_sha1nexte_epu32(e0, e0Save);
+      abcd = _mm_add_epi32(abcd, abcdSave);
+    }
+
+    _mm_storeu_si128((__m128i*) hash, _mm_shuffle_epi32(abcd, 0x1B));
+    hash[4] = (uint32_t) _mm_extract_epi32(e0, 3);
+  }
+}
+#endif
+
+
+/// process numBlocks consecutive 64 byte blocks
+void SHA1::processBlocks(const void* data, size_t numBlocks)
+{
+#ifdef HASHLIB_SHA_NI
+  if (hashlib::hasShaExtensions())
+  {
+    processBlocksShaNi(m_hash, (const uint8_t*) data, numBlocks);
+    return;
+  }
+#endif
+
+  const uint8_t* current = (const uint8_t*) data;
+  for (; numBlocks > 0; numBlocks--, current += BlockSize)
+    processBlock(current);
+}
+
+
 /// add arbitrary number of bytes
 void SHA1::add(const void* data, size_t numBytes)
 {
@@ -169,7 +270,7 @@ void SHA1::add(const void* data, size_t numBytes)
   // full buffer
   if (m_bufferSize == BlockSize)
   {
-    processBlock((void*)m_buffer);
+    processBlocks(m_buffer, 1);
     m_numBytes  += BlockSize;
     m_bufferSize = 0;
   }
@@ -179,12 +280,13 @@ void SHA1::add(const void* data, size_t numBytes)
     return;
 
   // process full blocks
-  while (numBytes >= BlockSize)
+  if (numBytes >= BlockSize)
   {
-    processBlock(current);
-    current    += BlockSize;
-    m_numBytes += BlockSize;
-    numBytes   -= BlockSize;
+    size_t numBlocks = numBytes / BlockSize;
+    processBlocks(current, numBlocks);
+    current    += numBlocks * BlockSize;
+    m_numBytes += numBlocks * BlockSize;
+    numBytes   -= numBlocks * BlockSize;
   }
 
   // keep remaining bytes in buffer
@@ -255,10 +357,10 @@ void SHA1::processBuffer()
   *addLength   =  msgBits        & 0xFF;
 
   // process blocks
-  processBlock(m_buffer);
+  processBlocks(m_buffer, 1);
   // flowed over into a second block ?
   if (paddedLength > BlockSize)
-    processBlock(extra);
+    processBlocks(extra, 1);
 }
 
 
@@ -57,6 +57,8 @@ public:
 private:
   /// process 64 bytes
   void processBlock(const void* data);
+  /// process numBlocks consecutive 64 byte blocks (uses the SHA extensions if available)
+  void processBlocks(const void* data, size_t numBlocks);
   /// process everything left in the internal buffer
   void processBuffer();
 
@@ -5,6 +5,7 @@
 //
 
 #include "sha256.hpp"
+#include "cpufeatures.hpp"
 
 // big endian architectures need #define __BYTE_ORDER __BIG_ENDIAN
 #ifndef _MSC_VER
@@ -237,6 +238,99 @@ void SHA256::processBlock(const void* data)
 }
 
 
+#ifdef HASHLIB_SHA_NI
+#include <immintrin.h>
+
+namespace
+{
+  /// round constants, 4 per SHA-NI round group
+  const uint32_t k256[64] =
+  {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+  };
+
+  /// process numBlocks 64 byte blocks with the SHA extensions
+  __attribute__((target("sha,sse4.1,ssse3")))
+  void processBlocksShaNi(uint32_t hash[8], const uint8_t* data, size_t numBlocks)
+  {
+    // message words are big endian
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // the instructions want the state as ABEF and CDGH
+    __m128i tmp    = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) &hash[0]), 0xB1); // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*) &hash[4]), 0x1B); // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);     // ABEF
+    state1         = _mm_blend_epi16(state1, tmp, 0xF0);  // CDGH
+
+    for (; numBlocks > 0; numBlocks--, data += 64)
+    {
+      const __m128i abefSave = state0;
+      const __m128i cdghSave = state1;
+
+      // the message schedule lives in 4 registers, quad i in msg[i % 4]
+      __m128i msg[4];
+      for (int i = 0; i < 16; i++)
+      {
+        __m128i& current = msg[i & 3];
+        if (i < 4)
+        {
+          current = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (data + 16 * i)), byteSwap);
+        }
+        else
+        {
+          // W[t-16] + s0(W[t-15]) + W[t-7], then s1(W[t-2])
+          current = _mm_sha256msg1_epu32(current, msg[(i + 1) & 3]);
+          current = _mm_add_epi32(current, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+          current = _mm_sha256msg2_epu32(current, msg[(i + 3) & 3]);
+        }
+
+        // 4 rounds, 2 at a time
+        __m128i words = _mm_add_epi32(current, _mm_loadu_si128((const __m128i*) &k256[4 * i]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+        words  = _mm_shuffle_epi32(words, 0x0E);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+      }
+
+      state0 = _mm_add_epi32(state0, abefSave);
+      state1 = _mm_add_epi32(state1, cdghSave);
+    }
+
+    // back to ABCD and EFGH
+    tmp    = _mm_shuffle_epi32(state0, 0x1B);          // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);          // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);       // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);          // HGFE
+    _mm_storeu_si128((__m128i*) &hash[0], state0);
+    _mm_storeu_si128((__m128i*) &hash[4], state1);
+  }
+}
+#endif
+
+
+/// process numBlocks consecutive 64 byte blocks
+void SHA256::processBlocks(const void* data, size_t numBlocks)
+{
+#ifdef HASHLIB_SHA_NI
+  if (hashlib::hasShaExtensions())
+  {
+    processBlocksShaNi(m_hash, (const uint8_t*) data, numBlocks);
+    return;
+  }
+#endif
+
+  const uint8_t* current = (const uint8_t*) data;
+  for (; numBlocks > 0; numBlocks--, current += BlockSize)
+    processBlock(current);
+}
+
+
 /// add arbitrary number of bytes
 void SHA256::add(const void* data, size_t numBytes)
 {
@@ -254,7 +348,7 @@ void SHA256::add(const void* data, size_t numBytes)
   // full buffer
   if (m_bufferSize == BlockSize)
   {
-    processBlock(m_buffer);
+    processBlocks(m_buffer, 1);
     m_numBytes  += BlockSize;
     m_bufferSize = 0;
   }
@@ -264,12 +358,13 @@ void SHA256::add(const void* data, size_t numBytes)
     return;
 
   // process full blocks
-  while (numBytes >= BlockSize)
+  if (numBytes >= BlockSize)
   {
-    processBlock(current);
-    current    += BlockSize;
-    m_numBytes += BlockSize;
-    numBytes   -= BlockSize;
+    size_t numBlocks = numBytes / BlockSize;
+    processBlocks(current, numBlocks);
+    current    += numBlocks * BlockSize;
+    m_numBytes += numBlocks * BlockSize;
+    numBytes   -= numBlocks * BlockSize;
   }
 
   // keep remaining bytes in buffer
@@ -340,10 +435,10 @@ void SHA256::processBuffer()
   *addLength   =  msgBits        & 0xFF;
 
   // process blocks
-  processBlock(m_buffer);
+  processBlocks(m_buffer, 1);
   // flowed over into a second block ?
   if (paddedLength > BlockSize)
-    processBlock(extra);
+    processBlocks(extra, 1);
 }
 
 
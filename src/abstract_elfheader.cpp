@@ -1,10 +1,30 @@
 #include "abstract_elfheader.hpp"
+#include "elf_view.hpp"
 
 #include <iostream>
 
 AbstractElfHeader::AbstractElfHeader() : m_is64(false),
-                                         m_header32(nullptr),
-                                         m_header64(nullptr)
+                                         m_isLE(false),
+                                         m_fileSize(0),
+                                         m_magic(),
+                                         m_class(0),
+                                         m_encoding(0),
+                                         m_fileVersion(0),
+                                         m_os(0),
+                                         m_abi(0),
+                                         m_type(0),
+                                         m_machine(0),
+                                         m_version(0),
+                                         m_entry(0),
+                                         m_programOffset(0),
+                                         m_sectionOffset(0),
+                                         m_flags(0),
+                                         m_ehSize(0),
+                                         m_programSize(0),
+                                         m_programCount(0),
+                                         m_sectionSize(0),
+                                         m_sectionCount(0),
+                                         m_stringTableIndex(0)
 {
 }
 
@@ -27,46 +47,77 @@ void AbstractElfHeader::setHeader(const char *p_data, std::size_t p_size)
   if (header->m_phentsize == sizeof(elf::program_header_32) || header->m_phentsize == ntohs(sizeof(elf::program_header_32)))
   {
     m_is64 = false;
-    m_header32 = header;
+
+    // this is hack to get around abuse of the encoding field
+    m_isLE = header->m_phentsize == sizeof(elf::program_header_32);
   }
   else
   {
-    m_is64 = true;
-    m_header64 = reinterpret_cast<const elf::elf_header_64 *>(p_data);
+    const elf::elf_header_64 *header64 = reinterpret_cast<const elf::elf_header_64 *>(p_data);
 
-    if (m_header64->m_phentsize != sizeof(elf::program_header_64) && m_header64->m_phentsize != ntohs(sizeof(elf::program_header_64)))
+    if (header64->m_phentsize != sizeof(elf::program_header_64) && header64->m_phentsize != ntohs(sizeof(elf::program_header_64)))
       throw std::runtime_error("Unable to determine 32 bit vs. 64 bit");
+
+    m_is64 = true;
+    m_isLE = header64->m_phentsize == sizeof(elf::program_header_64);
   }
+
+  elf::view::dispatch(m_is64, m_isLE, [&](auto p_class, auto p_order)
+  {
+    decode<decltype(p_class), decltype(p_order)>(p_data);
+  });
+}
+
+template <typename Class, typename Order>
+void AbstractElfHeader::decode(const char *p_data)
+{
+  const elf::view::ElfHeaderView<Class, Order> view(p_data);
+
+  m_magic[0] = view.raw().m_magic0;
+  m_magic[1] = view.raw().m_magic1;
+  m_magic[2] = view.raw().m_magic2;
+  m_magic[3] = view.raw().m_magic3;
+  m_class = view.raw().m_class;
+  m_encoding = view.raw().m_encoding;
+  m_fileVersion = view.raw().m_fileversion;
+  m_os = view.raw().m_os;
+  m_abi = view.raw().m_abi;
+
+  m_type = view.getType();
+  m_machine = view.getMachine();
+  m_version = view.getVersion();
+  m_entry = view.getEntry();
+  m_programOffset = view.getProgramOffset();
+  m_sectionOffset = view.getSectionOffset();
+  m_flags = view.getFlags();
+  m_ehSize = view.getEHSize();
+  m_programSize = view.getProgramSize();
+  m_programCount = view.getProgramCount();
+  m_sectionSize = view.getSectionSize();
+  m_sectionCount = view.getSectionCount();
+  m_stringTableIndex = view.getStringTableIndex();
 }
 
 bool AbstractElfHeader::is64() const
 {
-  assert(m_header32 != NULL || m_header64 != NULL);
   return m_is64;
 }
 
 std::string AbstractElfHeader::getMagic() const
 {
-  std::string result = std::to_string((m_is64 ? m_header64->m_magic0 : m_header32->m_magic0)) +
-                       std::to_string((m_is64 ? m_header64->m_magic1 : m_header32->m_magic1)) +
-                       std::to_string((m_is64 ? m_header64->m_magic2 : m_header32->m_magic2)) +
-                       std::to_string((m_is64 ? m_header64->m_magic3 : m_header32->m_magic3));
+  std::string result = std::to_string(m_magic[0]) +
+                       std::to_string(m_magic[1]) +
+                       std::to_string(m_magic[2]) +
+                       std::to_string(m_magic[3]);
 
   return result;
 }
 
 std::string AbstractElfHeader::getType() const
 {
-  boost::uint16_t type = 0;
-
-  if (m_is64)
-    type = ((isLE())) ? m_header64->m_type : ntohs(m_header64->m_type);
-  else
-    type = ((isLE())) ? m_header32->m_type : ntohs(m_header32->m_type);
-
   const std::string type_str = [&]()
   {
-    switch (type)
+    switch (m_type)
     {
     case elf::k_etnone:
       return "ET_NONE";
@@ -94,9 +145,7 @@ std::string AbstractElfHeader::getType() const
 std::string AbstractElfHeader::getOSABI() const
 {
   std::string os_str;
-  boost::uint8_t os = m_is64 ? m_header64->m_os : m_header32->m_os;
-
-  switch (os)
+  switch (m_os)
   {
   case 0x00:
     os_str = "System V";
@@ -137,7 +186,7 @@ std::string AbstractElfHeader::getOSABI() const
   default:
   {
     std::stringstream result;
-    result << "0x" << std::hex << static_cast<int>(os);
+    result << "0x" << std::hex << static_cast<int>(m_os);
     return result.str();
   }
   }
@@ -147,15 +196,7 @@ std::string AbstractElfHeader::getOSABI() const
 
 boost::uint64_t AbstractElfHeader::getEntryPoint() const
 {
-  boost::uint64_t entryPoint;
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    entryPoint = ((isLE())) ? m_header64->m_entry : htobe64(m_header64->m_entry);
-  else
-    entryPoint = ((isLE())) ? m_header32->m_entry : ntohl(m_header32->m_entry);
-
-  return entryPoint;
+  return m_entry;
 }
 
 std::string AbstractElfHeader::getEntryPointString() const
@@ -168,98 +209,44 @@ std::string AbstractElfHeader::getEntryPointString() const
 std::string AbstractElfHeader::getVersion() const
 {
   std::stringstream result;
-
-  if (m_is64)
-    result << (isLE() ? m_header64->m_version : ntohl(m_header64->m_version));
-  else
-    result << (isLE() ? m_header32->m_version : ntohl(m_header32->m_version));
+  result << m_version;
 
   return result.str();
 }
 
 boost::uint32_t AbstractElfHeader::getProgramOffset() const
 {
-  boost::uint32_t offset;
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    offset = (isLE()) ? m_header64->m_phoff : htobe64(m_header64->m_phoff);
-  else
-    offset = (isLE()) ? m_header32->m_phoff : ntohl(m_header32->m_phoff);
-
-  return offset;
+  return m_programOffset;
 }
 
 boost::uint16_t AbstractElfHeader::getProgramCount() const
 {
-  boost::uint16_t PC;
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    PC = (isLE()) ? m_header64->m_phnum : ntohs(m_header64->m_phnum);
-  else
-    PC = (isLE()) ? m_header32->m_phnum : ntohs(m_header32->m_phnum);
-
-  return PC;
+  return m_programCount;
 }
 
 boost::uint16_t AbstractElfHeader::getProgramSize() const
 {
-  boost::uint16_t PS;
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    PS = (isLE()) ? m_header64->m_phentsize : ntohs(m_header64->m_phentsize);
-  else
-    PS = (isLE()) ? m_header32->m_phentsize : ntohs(m_header32->m_phentsize);
-
-  return PS;
+  return m_programSize;
 }
 
 boost::uint32_t AbstractElfHeader::getSectionOffset() const
 {
-  boost::uint32_t offset;
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    offset = (isLE()) ? m_header64->m_shoff : htobe64(m_header64->m_shoff);
-  else
-    offset = (isLE()) ? m_header32->m_shoff : ntohl(m_header32->m_shoff);
-
-  return offset;
+  return m_sectionOffset;
 }
 
 boost::uint16_t AbstractElfHeader::getSectionSize() const
 {
-  boost::uint16_t size;
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    size = (isLE()) ? m_header64->m_shentsize : ntohs(m_header64->m_shentsize);
-  else
-    size = (isLE()) ? m_header32->m_shentsize : ntohs(m_header32->m_shentsize);
-
-  return size;
+  return m_sectionSize;
 }
 
 boost::uint16_t AbstractElfHeader::getSectionCount() const
 {
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    return (isLE()) ? m_header64->m_shnum : ntohs(m_header64->m_shnum);
-
-  return (isLE()) ? m_header32->m_shnum : ntohs(m_header32->m_shnum);
+  return m_sectionCount;
 }
 
 boost::uint16_t AbstractElfHeader::getStringTableIndex() const
 {
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    return (isLE()) ? m_header64->m_shtrndx : ntohs(m_header64->m_shtrndx);
-
-  return (isLE()) ? m_header32->m_shtrndx : ntohs(m_header32->m_shtrndx);
+  return m_stringTableIndex;
 }
 
 boost::uint32_t AbstractElfHeader::getStringTableOffset(const char *p_start) const
@@ -289,25 +276,19 @@ boost::uint32_t AbstractElfHeader::getStringTableOffset(const char *p_start) con
 
 bool AbstractElfHeader::isLE() const
 {
-  // this is hack to get around abuse of the encoding field
-  assert(m_header32 != NULL || m_header64 != NULL);
-
-  if (m_is64)
-    return (m_header64->m_phentsize == sizeof(elf::program_header_64) ? true : false);
+  return m_isLE;
+}
 
-  return (m_header32->m_phentsize == sizeof(elf::program_header_32) ? true : false);
+boost::uint16_t AbstractElfHeader::getMachineType() const
+{
+  return m_machine;
 }
 
 std::string AbstractElfHeader::getMachine() const
 {
-  boost::uint16_t machine = m_is64 ? m_header64->m_machine : m_header32->m_machine;
-
-  if (!(isLE()))
-    machine = ntohs(machine);
-
   const std::string machine_str = [&]()
   {
-    switch (machine)
+    switch (m_machine)
     {
     case elf::k_emM32:
       return "AT&T WE 32100";
@@ -347,10 +328,9 @@ std::string AbstractElfHeader::getMachine() const
 
 std::string AbstractElfHeader::getEncoding() const
 {
-  boost::uint8_t encoding = m_header64 != NULL ? m_header64->m_encoding : m_header32->m_encoding;
   const std::string str = [&]()
   {
-    switch (encoding)
+    switch (m_encoding)
     {
     case 0:
       return "Invalid";
@@ -372,7 +352,7 @@ std::string AbstractElfHeader::getEncoding() const
 std::string AbstractElfHeader::getABIVersion() const
 {
   std::stringstream result;
-  (m_is64) ? result << static_cast<int>(m_header64->m_abi) : result << static_cast<int>(m_header32->m_abi);
+  result << static_cast<int>(m_abi);
 
   return result.str();
 }
@@ -386,37 +366,20 @@ std::string AbstractElfHeader::getClass() const
 std::string AbstractElfHeader::getFileVersion() const
 {
   std::stringstream result;
-  result << static_cast<int>(m_is64 ? m_header64->m_fileversion : m_header32->m_fileversion);
+  result << static_cast<int>(m_fileVersion);
 
   return result.str();
 }
 
 boost::uint16_t AbstractElfHeader::getEHSize() const
 {
-  assert(m_header32 != NULL || m_header64 != NULL);
-  boost::uint16_t value = 0;
-
-  if (m_is64)
-    value = (isLE()) ? m_header64->m_ehsize : ntohs(m_header64->m_ehsize);
-  else
-    value = (isLE()) ? m_header32->m_ehsize : ntohs(m_header32->m_ehsize);
-
-  return value;
+  return m_ehSize;
 }
 
 std::string AbstractElfHeader::getFlags() const
 {
-  assert(m_header32 != NULL || m_header64 != NULL);
-  boost::uint32_t value = 0;
-
-  if (m_is64)
-    value = (isLE()) ? m_header64->m_flags : ntohl(m_header64->m_flags);
-
-  else
-    value = (isLE()) ? m_header32->m_flags : ntohl(m_header32->m_flags);
-
   std::stringstream result;
-  result << "0x" << std::hex << value;
+  result << "0x" << std::hex << m_flags;
   return result.str();
 }
 
@@ -465,17 +428,9 @@ void AbstractElfHeader::evaluate(std::vector<std::pair<boost::int32_t, std::stri
   {
     p_capabilities[elf::k_antidebug].insert("Possible compact ELF: section count 0 but section offset non-zero");
   }
-  else if (m_header32 != NULL)
-  {
-    if (m_header32->m_class != 1 && m_header32->m_class != 2)
-      p_capabilities[elf::k_antidebug].insert("Possible compact ELF: invalid class in ELF header");
-  }
-  else
+  else if (m_class != 1 && m_class != 2)
   {
-    if (m_header64->m_class != 1 && m_header64->m_class != 2)
-    {
-      p_capabilities[elf::k_antidebug].insert("Possible compact ELF: invalid class in ELF header");
-    }
+    p_capabilities[elf::k_antidebug].insert("Possible compact ELF: invalid class in ELF header");
   }
 
   if (offset >= m_fileSize || size >= m_fileSize)
@@ -38,17 +38,41 @@ private:
     AbstractElfHeader(const AbstractElfHeader &p_rhs);
     AbstractElfHeader &operator=(const AbstractElfHeader &p_rhs);
 
+    // decodes the header with the class and byte order of the binary
+    template <typename Class, typename Order>
+    void decode(const char *p_data);
+
     // indicates if the binary is 64 bit or not
     bool m_is64 : 1;
 
+    // indicates if the binary is little endian or not
+    bool m_isLE : 1;
+
     // stores the file size due to true.asm silliness
     boost::uint32_t m_fileSize;
 
-    // a pointer to the 32 bit version of the ELF header
-    const elf::elf_header_32 *m_header32;
-
-    // a pointer to the 64 bit version of the ELF header
-    const elf::elf_header_64 *m_header64;
+    // the identification bytes
+    boost::uint8_t m_magic[4];
+    boost::uint8_t m_class;
+    boost::uint8_t m_encoding;
+    boost::uint8_t m_fileVersion;
+    boost::uint8_t m_os;
+    boost::uint8_t m_abi;
+
+    // the decoded fields of the header
+    boost::uint16_t m_type;
+    boost::uint16_t m_machine;
+    boost::uint32_t m_version;
+    boost::uint64_t m_entry;
+    boost::uint64_t m_programOffset;
+    boost::uint64_t m_sectionOffset;
+    boost::uint32_t m_flags;
+    boost::uint16_t m_ehSize;
+    boost::uint16_t m_programSize;
+    boost::uint16_t m_programCount;
+    boost::uint16_t m_sectionSize;
+    boost::uint16_t m_sectionCount;
+    boost::uint16_t m_stringTableIndex;
 
 public:
     // default initialize members
@@ -128,6 +152,9 @@ public:
     // return the architecture this file is made for
     std::string getMachine() const;
 
+    // return e_machine
+    boost::uint16_t getMachineType() const;
+
     // return a string representation of the elf header
     std::string printToStdOut() const;
 
@@ -1,47 +1,46 @@
 #include "abstract_programheader.hpp"
 #include "structures/programheader.hpp"
 #include "abstract_segments.hpp"
+#include "elf_view.hpp"
 #include <sstream>
-#include <stdexcept>
 #include <boost/foreach.hpp>
-#include <iostream>
 
-#if __APPLE__ || WINDOWS
-#include "endian.hpp"
-#else
-#include <arpa/inet.h>
-#endif
-
-AbstractProgramHeader::AbstractProgramHeader(const char *p_data, boost::uint16_t p_size, bool p_is64, bool p_isLE)
+template <typename Class, typename Order>
+AbstractProgramHeader::AbstractProgramHeader(const elf::view::ProgramView<Class, Order>& p_view) :
+    m_type(p_view.getType()),
+    m_flags(p_view.getFlags()),
+    m_offset(p_view.getOffset()),
+    m_virtualAddress(p_view.getVirtualAddress()),
+    m_physicalAddress(p_view.getPhysicalAddress()),
+    m_fileSize(p_view.getFileSize()),
+    m_memorySize(p_view.getMemorySize()),
+    m_align(p_view.getAlign()),
+    m_is64(Class::k_is64),
+    m_isLE(Order::k_isLE)
+{
+}
+
+template AbstractProgramHeader::AbstractProgramHeader(
+    const elf::view::ProgramView<elf::view::Class32, elf::view::LittleEndian>&);
+template AbstractProgramHeader::AbstractProgramHeader(
+    const elf::view::ProgramView<elf::view::Class32, elf::view::BigEndian>&);
+template AbstractProgramHeader::AbstractProgramHeader(
+    const elf::view::ProgramView<elf::view::Class64, elf::view::LittleEndian>&);
+template AbstractProgramHeader::AbstractProgramHeader(
+    const elf::view::ProgramView<elf::view::Class64, elf::view::BigEndian>&);
+
+AbstractProgramHeader::AbstractProgramHeader(const AbstractProgramHeader &p_rhs) :
+    m_type(p_rhs.m_type),
+    m_flags(p_rhs.m_flags),
+    m_offset(p_rhs.m_offset),
+    m_virtualAddress(p_rhs.m_virtualAddress),
+    m_physicalAddress(p_rhs.m_physicalAddress),
+    m_fileSize(p_rhs.m_fileSize),
+    m_memorySize(p_rhs.m_memorySize),
+    m_align(p_rhs.m_align),
+    m_is64(p_rhs.m_is64),
+    m_isLE(p_rhs.m_isLE)
 {
-    m_isLE = p_isLE;
-    m_is64 = p_is64;
-
-    if (p_is64)
-    {
-        if (p_size != sizeof(elf::program_header_64))
-            throw std::runtime_error("Unexpected program header size");
-
-        m_program_header64 = reinterpret_cast<const elf::program_header_64 *>(p_data);
-    }
-    else
-    {
-        if (p_size != sizeof(elf::program_header_32))
-        {
-            std::cout << p_size << std::endl;
-            throw std::runtime_error("Unexpected program header size.");
-        }
-
-        m_program_header32 = reinterpret_cast<const elf::program_header_32 *>(p_data);
-    }
-}
-
-AbstractProgramHeader::AbstractProgramHeader(const AbstractProgramHeader &p_rhs)
-{
-    m_program_header32 = p_rhs.m_program_header32;
-    m_program_header64 = p_rhs.m_program_header64;
-    m_is64 = p_rhs.m_is64;
-    m_isLE = p_rhs.m_isLE;
 }
 
 AbstractProgramHeader::~AbstractProgramHeader()
@@ -134,26 +133,17 @@ std::string AbstractProgramHeader::getName() const
 
 boost::uint32_t AbstractProgramHeader::getType() const
 {
-    if (m_is64)
-        return (m_isLE) ? m_program_header64->m_type : ntohl(m_program_header64->m_type);
-
-    return (m_isLE) ? m_program_header32->m_type : ntohl(m_program_header32->m_type);
+    return m_type;
 }
 
 boost::uint64_t AbstractProgramHeader::getOffset() const
 {
-    if (m_is64)
-        return m_isLE ? m_program_header64->m_offset : htobe64(m_program_header64->m_offset);
-
-    return m_isLE ? m_program_header32->m_offset : ntohl(m_program_header32->m_offset);
+    return m_offset;
 }
 
 boost::uint64_t AbstractProgramHeader::getVirtualAddress() const
 {
-    if (m_is64)
-        return (m_isLE) ? m_program_header64->m_vaddr : htobe64(m_program_header64->m_vaddr);
-
-    return (m_isLE) ? m_program_header32->m_vaddr : ntohl(m_program_header32->m_vaddr);
+    return m_virtualAddress;
 }
 
 std::string AbstractProgramHeader::getVirtualAddressString() const
@@ -165,10 +155,7 @@ std::string AbstractProgramHeader::getVirtualAddressString() const
 
 boost::uint64_t AbstractProgramHeader::getPhysicalAddress() const
 {
-    if (m_is64)
-        return m_isLE ? m_program_header64->m_paddr : htobe64(m_program_header64->m_paddr);
-
-    return m_isLE ? m_program_header32->m_paddr : ntohl(m_program_header32->m_paddr);
+    return m_physicalAddress;
 }
 
 std::string AbstractProgramHeader::getPhysicalAddressString() const
@@ -180,24 +167,20 @@ std::string AbstractProgramHeader::getPhysicalAddressString() const
 
 boost::uint64_t AbstractProgramHeader::getFileSize() const
 {
-    if (m_is64)
-        return m_isLE ? m_program_header64->m_filesz : htobe64(m_program_header64->m_filesz);
-
-    return m_isLE ? m_program_header32->m_filesz : ntohl(m_program_header32->m_filesz);
+    return m_fileSize;
 }
 
 boost::uint64_t AbstractProgramHeader::getMemorySize() const
 {
-    if (m_is64)
-        return m_isLE ? m_program_header64->m_memsz : htobe64(m_program_header64->m_memsz);
+    return m_memorySize;
+}
 
-    return m_isLE ? m_program_header32->m_memsz : ntohl(m_program_header32->m_memsz);
+boost::uint64_t AbstractProgramHeader::getAlign() const
+{
+    return m_align;
 }
 
 boost::uint32_t AbstractProgramHeader::getFlags() const
 {
-    if (m_is64)
-        return m_isLE ? m_program_header64->m_flags : ntohl(m_program_header64->m_flags);
-
-    return m_isLE ? m_program_header32->m_flags : ntohl(m_program_header32->m_flags);
+    return m_flags;
 }
@@ -7,8 +7,10 @@
 
 namespace elf
 {
-    struct program_header_32;
-    struct program_header_64;
+    namespace view
+    {
+        template <typename Class, typename Order> class ProgramView;
+    }
 }
 
 class AbstractProgramHeader
@@ -18,11 +20,15 @@ class AbstractProgramHeader
         // disable evil things
         //AbstractProgramHeader& operator=(const AbstractProgramHeader& p_rhs);
 
-        //! This program header in 32 bit format
-        const elf::program_header_32* m_program_header32;
-
-        //! This program header in 64 bit format
-        const elf::program_header_64* m_program_header64;
+        //! The decoded fields of the header
+        boost::uint32_t m_type;
+        boost::uint32_t m_flags;
+        boost::uint64_t m_offset;
+        boost::uint64_t m_virtualAddress;
+        boost::uint64_t m_physicalAddress;
+        boost::uint64_t m_fileSize;
+        boost::uint64_t m_memorySize;
+        boost::uint64_t m_align;
 
         //! Indicates if the binary is 64 bit or not
         bool m_is64;
@@ -33,14 +39,11 @@ class AbstractProgramHeader
     public:
 
         /*
-        * stores the program information in a way that is hidden from aller
-        * p_data a pointer to the first entry
-        * p_count the number of expected entries
-        * p_size the expected size of a single entry
-        * p_is64 indicates if the binary is 64 bit or 32 bit
-        * p_isLE indicates if the binary is little endian
+        * decodes the header p_view points at
+        * p_view the entry, read with the class and byte order of the binary
         */
-        AbstractProgramHeader(const char* p_data, boost::uint16_t p_size, bool p_is64, bool p_isLE);
+        template <typename Class, typename Order>
+        explicit AbstractProgramHeader(const elf::view::ProgramView<Class, Order>& p_view);
         ~AbstractProgramHeader();
         AbstractProgramHeader(const AbstractProgramHeader& p_rhs);
 
@@ -58,6 +61,7 @@ class AbstractProgramHeader
         std::string getPhysicalAddressString() const;
         boost::uint64_t getFileSize() const;
         boost::uint64_t getMemorySize() const;
+        boost::uint64_t getAlign() const;
         boost::uint32_t getFlags() const;
 
 };
@@ -2,17 +2,12 @@
 #include "structures/sectionheader.hpp"
 #include "structures/noteformat.hpp"
 #include "abstract_segments.hpp"
+#include "elf_view.hpp"
 
 #include <sstream>
 #include <stdexcept>
 #include <boost/foreach.hpp>
 
-#if WINDOWS || __APPLE__
-#include "endian.hpp"
-#else
-#include <arpa/inet.h>
-#endif
-
 namespace
 {
     std::string make_name(const char* p_start, boost::uint32_t p_offset,
@@ -27,52 +22,49 @@ namespace
     }
 }
 
-AbstractSectionHeader::AbstractSectionHeader(const char* p_data,
-                                             boost::uint16_t p_size,
-                                             const char* p_fileStart,
-                                             boost::uint64_t p_fileSize,
-                                             boost::uint8_t p_strIndex,
-                                             const std::vector<AbstractSectionHeader>& p_sections,
-                                             bool p_is64,
-                                             bool p_isLE) :
-    m_sections(p_sections),
-    m_section_header32(),
-    m_section_header64(),
-    m_fileStart(p_fileStart),
-    m_size(p_fileSize),
-    m_strIndex(p_strIndex),
-    m_is64(p_is64),
-    m_isLE(p_isLE)
+template <typename Class, typename Order>
+AbstractSectionHeader::AbstractSectionHeader(const elf::view::SectionView<Class, Order>& p_view) :
+    m_name(),
+    m_nameIndex(p_view.getName()),
+    m_type(p_view.getType()),
+    m_flags(p_view.getFlags()),
+    m_address(p_view.getAddress()),
+    m_offset(p_view.getOffset()),
+    m_size(p_view.getSize()),
+    m_link(p_view.getLink()),
+    m_info(p_view.getInfo()),
+    m_addrAlign(p_view.getAddrAlign()),
+    m_entSize(p_view.getEntSize()),
+    m_is64(Class::k_is64),
+    m_isLE(Order::k_isLE)
 {
-    if (p_is64)
-    {
-        if (p_size != sizeof(elf::section_header_64))
-        {
-            throw std::runtime_error("Unexpected section header size");
-        }
-
-        m_section_header64 = reinterpret_cast<const elf::section_header_64*>(p_data);
-    }
-    else
-    {
-        if (p_size != sizeof(elf::section_header_32))
-        {
-            throw std::runtime_error("Unexpected section header size.");
-        }
-
-        m_section_header32 = reinterpret_cast<const elf::section_header_32*>(p_data);
-    }
 }
 
+template AbstractSectionHeader::AbstractSectionHeader(
+    const elf::view::SectionView<elf::view::Class32, elf::view::LittleEndian>&);
+template AbstractSectionHeader::AbstractSectionHeader(
+    const elf::view::SectionView<elf::view::Class32, elf::view::BigEndian>&);
+template AbstractSectionHeader::AbstractSectionHeader(
+    const elf::view::SectionView<elf::view::Class64, elf::view::LittleEndian>&);
+template AbstractSectionHeader::AbstractSectionHeader(
+    const elf::view::SectionView<elf::view::Class64, elf::view::BigEndian>&);
+
 AbstractSectionHeader::AbstractSectionHeader(const AbstractSectionHeader& p_rhs) :
-    m_sections(p_rhs.m_sections),
-    m_section_header32(p_rhs.m_section_header32),
-    m_section_header64(p_rhs.m_section_header64),
-    m_fileStart(p_rhs.m_fileStart),
+    m_name(p_rhs.m_name),
+    m_nameIndex(p_rhs.m_nameIndex),
+    m_type(p_rhs.m_type),
+    m_flags(p_rhs.m_flags),
+    m_address(p_rhs.m_address),
+    m_offset(p_rhs.m_offset),
     m_size(p_rhs.m_size),
-    m_strIndex(p_rhs.m_strIndex),
+    m_link(p_rhs.m_link),
+    m_info(p_rhs.m_info),
+    m_addrAlign(p_rhs.m_addrAlign),
+    m_entSize(p_rhs.m_entSize),
     m_is64(p_rhs.m_is64),
-    m_isLE(p_rhs.m_isLE){}
+    m_isLE(p_rhs.m_isLE)
+{
+}
 
 AbstractSectionHeader::~AbstractSectionHeader()
 {
@@ -106,35 +98,30 @@ bool AbstractSectionHeader::isWritable() const
     return false;
 }
 
-std::string AbstractSectionHeader::getName() const
+void AbstractSectionHeader::resolveName(const std::vector<AbstractSectionHeader>& p_sections,
+                                        boost::uint8_t p_strIndex, const char* p_fileStart,
+                                        boost::uint64_t p_fileSize)
 {
-    boost::uint32_t offset = 0;
-    if (m_is64)
-    {
-        offset = m_isLE ? m_section_header64->m_name : ntohl(m_section_header64->m_name);
-    }
-    else
+    if (p_sections.size() > p_strIndex)
     {
-        offset = m_isLE ? m_section_header32->m_name : ntohl(m_section_header32->m_name);
-    }
-    if (m_sections.size() > m_strIndex)
-    {
-        offset += m_sections[m_strIndex].getPhysOffset();
+        boost::uint32_t offset = m_nameIndex;
+        offset += p_sections[p_strIndex].getPhysOffset();
+        m_name = make_name(p_fileStart, offset, p_fileSize);
     }
     else
     {
-        return "Invalid String Index";
+        m_name.assign("Invalid String Index");
     }
-    return make_name(m_fileStart, offset, m_size);
+}
+
+const std::string& AbstractSectionHeader::getName() const
+{
+    return m_name;
 }
 
 boost::uint32_t AbstractSectionHeader::getType() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_type : ntohl(m_section_header64->m_type);
-    }
-    return m_isLE ? m_section_header32->m_type : ntohl(m_section_header32->m_type);
+    return m_type;
 }
 
 std::string AbstractSectionHeader::getTypeString() const
@@ -220,20 +207,12 @@ std::string AbstractSectionHeader::getFlagsString() const
 
 boost::uint64_t AbstractSectionHeader::getFlags() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_flags : htobe64(m_section_header64->m_flags);
-    }
-    return m_isLE ? m_section_header32->m_flags : ntohl(m_section_header32->m_flags);
+    return m_flags;
 }
 
 boost::uint64_t AbstractSectionHeader::getVirtAddress() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_addr : htobe64(m_section_header64->m_addr);
-    }
-    return m_isLE ? m_section_header32->m_addr : ntohl(m_section_header32->m_addr);
+    return m_address;
 }
 
 std::string AbstractSectionHeader::getVirtAddressString() const
@@ -245,54 +224,30 @@ std::string AbstractSectionHeader::getVirtAddressString() const
 
 boost::uint64_t AbstractSectionHeader::getPhysOffset() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_offset : htobe64(m_section_header64->m_offset);
-    }
-    return m_isLE ? m_section_header32->m_offset : ntohl(m_section_header32->m_offset);
+    return m_offset;
 }
 
 boost::uint64_t AbstractSectionHeader::getSize() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_size : htobe64(m_section_header64->m_size);
-    }
-    return m_isLE ? m_section_header32->m_size : ntohl(m_section_header32->m_size);
+    return m_size;
 }
 
 boost::uint32_t AbstractSectionHeader::getLink() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_link : ntohl(m_section_header64->m_link);
-    }
-    return m_isLE ? m_section_header32->m_link : ntohl(m_section_header32->m_link);
+    return m_link;
 }
 
 boost::uint32_t AbstractSectionHeader::getInfo() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_info : ntohl(m_section_header64->m_info);
-    }
-    return m_isLE ? m_section_header32->m_info : ntohl(m_section_header32->m_info);
+    return m_info;
 }
 
 boost::uint64_t AbstractSectionHeader::getAddrAlign() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_addralign : htobe64(m_section_header64->m_addralign);
-    }
-    return m_isLE ? m_section_header32->m_addralign : ntohl(m_section_header32->m_addralign);
+    return m_addrAlign;
 }
 
 boost::uint64_t AbstractSectionHeader::getEntSize() const
 {
-    if (m_is64)
-    {
-        return m_isLE ? m_section_header64->m_entsize : htobe64(m_section_header64->m_entsize);
-    }
-    return m_isLE ? m_section_header32->m_entsize : ntohl(m_section_header32->m_entsize);
+    return m_entSize;
 }
@@ -11,8 +11,10 @@
 
 namespace elf
 {
-    struct section_header_32;
-    struct section_header_64;
+    namespace view
+    {
+        template <typename Class, typename Order> class SectionView;
+    }
 }
 
 // abstracts away the BE vs LE and 32 bit vs 64 bit stuff
@@ -20,23 +22,22 @@ class AbstractSectionHeader
 {
     private:
 
-        // a reference to the list of section headers
-        const std::vector<AbstractSectionHeader>& m_sections;
+        // the name, once resolved
+        std::string m_name;
 
-        // this section header in 32 bit format
-        const elf::section_header_32* m_section_header32;
+        // the offset of the name in the string table
+        boost::uint32_t m_nameIndex;
 
-        // this section header in 64 bit format
-        const elf::section_header_64* m_section_header64;
-
-        // the start of the file in memory
-        const char* m_fileStart;
-
-        // the size of the file in memory
+        // the decoded fields of the header
+        boost::uint32_t m_type;
+        boost::uint64_t m_flags;
+        boost::uint64_t m_address;
+        boost::uint64_t m_offset;
         boost::uint64_t m_size;
-
-        // index of the string table
-        boost::uint8_t m_strIndex;
+        boost::uint32_t m_link;
+        boost::uint32_t m_info;
+        boost::uint64_t m_addrAlign;
+        boost::uint64_t m_entSize;
 
         // indicates if the binary is 64 bit or not
         bool m_is64;
@@ -52,13 +53,23 @@ class AbstractSectionHeader
 
     public:
 
-        AbstractSectionHeader(const char* p_data, boost::uint16_t p_size,
-                            const char* p_file, boost::uint64_t p_fileSize,
-                            boost::uint8_t p_strIndex,
-                            const std::vector<AbstractSectionHeader>& p_sections,
-                            bool p_is64, bool p_isLE);
+        // decodes the header p_view points at
+        template <typename Class, typename Order>
+        explicit AbstractSectionHeader(const elf::view::SectionView<Class, Order>& p_view);
         AbstractSectionHeader(const AbstractSectionHeader& p_rhs);
 
+        /*
+         * looks the name up in the section header string table. called once
+         * the section table is complete.
+         * p_sections the section table
+         * p_strIndex the index of the section header string table
+         * p_fileStart the start of the file in memory
+         * p_fileSize the size of the file
+         */
+        void resolveName(const std::vector<AbstractSectionHeader>& p_sections,
+                         boost::uint8_t p_strIndex, const char* p_fileStart,
+                         boost::uint64_t p_fileSize);
+
         // nothing of note
         ~AbstractSectionHeader();
 
@@ -66,7 +77,7 @@ class AbstractSectionHeader
         bool isLE() const;
         bool isExecutable() const;
         bool isWritable() const;
-        std::string getName() const;
+        const std::string& getName() const;
         std::string getTypeString() const;
         std::string getFlagsString() const;
         boost::uint32_t getType() const;
@@ -5,7 +5,6 @@
 #include "structures/sectionheader.hpp"
 #include "structures/symtable_entry.hpp"
 #include "abstract_programheader.hpp"
-#include "abstract_sectionheader.hpp"
 
 #include "segment_types/comment_segment.hpp"
 #include "segment_types/debuglink_segment.hpp"
@@ -15,6 +14,7 @@
 #include "segment_types/strtable_segment.hpp"
 
 #include <sstream>
+#include <algorithm>
 #include <boost/foreach.hpp>
 
 AbstractSegments::AbstractSegments() : m_data(NULL),
@@ -22,11 +22,16 @@ AbstractSegments::AbstractSegments() : m_data(NULL),
                                        m_sizeFile(0),
                                        m_sections(),
                                        m_programs(),
+                                       m_notePrograms(),
+                                       m_addressIndex(),
                                        m_types(),
                                        m_offsets(),
                                        m_baseAddress(0),
                                        m_dynamic(),
                                        m_dynSymbols(),
+                                       m_relocations(),
+                                       m_versions(),
+                                       m_functions(),
                                        m_otherSymbols(),
                                        m_initArray("InitArray"),
                                        m_ctorsArray("CtorsArray"),
@@ -34,7 +39,9 @@ AbstractSegments::AbstractSegments() : m_data(NULL),
                                        m_is64(false),
                                        m_isLE(false),
                                        m_isDY(false),
-                                       m_fakeDynamicStringTable(false)
+                                       m_machine(0),
+                                       m_fakeDynamicStringTable(false),
+                                       m_demangle(true)
 {
 }
 
@@ -42,6 +49,16 @@ AbstractSegments::~AbstractSegments()
 {
 }
 
+void AbstractSegments::setDemangle(bool p_demangle)
+{
+    m_demangle = p_demangle;
+    m_dynSymbols.setDemangle(p_demangle);
+    BOOST_FOREACH (Symbols &symbol, m_otherSymbols)
+    {
+        symbol.setDemangle(p_demangle);
+    }
+}
+
 std::set<std::string> AbstractSegments::getFiles() const
 {
     std::set<std::string> combined = m_dynSymbols.getFiles();
@@ -57,21 +74,20 @@ std::set<std::string> AbstractSegments::getFiles() const
 }
 
 void AbstractSegments::setStart(const char *p_data, boost::uint32_t p_size,
-                                bool p_is64, bool p_isLE, bool p_isDY)
+                                bool p_is64, bool p_isLE, bool p_isDY,
+                                boost::uint16_t p_machine)
 {
     m_data = p_data;
     m_sizeFile = p_size;
     m_is64 = p_is64;
     m_isLE = p_isLE;
     m_isDY = p_isDY;
+    m_machine = p_machine;
 }
 
-void AbstractSegments::makeSegmentFromSectionHeader(const AbstractSectionHeader &p_header)
+void AbstractSegments::setSections(const SectionTable &p_sections)
 {
-    m_sections.emplace_back(p_header.getName(), p_header.getTypeString(), p_header.getPhysOffset(),
-                            p_header.getVirtAddress(), p_header.getSize(),
-                            p_header.getLink(), p_header.isExecutable(), p_header.isWritable(),
-                            p_header.getType() == elf::k_dynamic);
+    m_sections = p_sections;
 }
 
 void AbstractSegments::makeSegmentFromProgramHeader(const AbstractProgramHeader &p_header)
@@ -86,10 +102,64 @@ void AbstractSegments::makeSegmentFromProgramHeader(const AbstractProgramHeader
                             p_header.getMemorySize() ? p_header.getMemorySize() : p_header.getFileSize(),
                             0, p_header.isExecutable(), p_header.isWritable(),
                             p_header.getType() == elf::k_pdynamic);
+
+    if (p_header.getType() == elf::k_pnote)
+    {
+        m_notePrograms.push_back(p_header);
+    }
+}
+
+void AbstractSegments::indexAddresses()
+{
+    // the programs take precedence over the sections
+    m_addressIndex.clear();
+    BOOST_FOREACH (const Segment &program, m_programs)
+    {
+        m_addressIndex.add(program.getVirtAddress(), program.getSize(), program.getPhysOffset());
+    }
+    for (std::size_t i = 0; i < m_sections.size(); ++i)
+    {
+        m_addressIndex.add(m_sections.getAddress(i), m_sections.getSize(i), m_sections.getOffset(i));
+    }
+    m_addressIndex.build();
+}
+
+void AbstractSegments::indexFunctions()
+{
+    // PT_GNU_EH_FRAME is where the loader finds .eh_frame_hdr, so it wins
+    boost::uint64_t hdr = 0;
+    BOOST_FOREACH (const Segment &program, m_programs)
+    {
+        if (program.getName() == "GNU_EH_FRAME")
+        {
+            hdr = program.getVirtAddress();
+            break;
+        }
+    }
+
+    boost::uint64_t ehFrame = 0;
+    boost::uint64_t ehFrameSize = 0;
+    for (std::size_t i = 0; i < m_sections.size(); ++i)
+    {
+        if (hdr == 0 && m_sections.getName(i) == ".eh_frame_hdr")
+        {
+            hdr = m_sections.getAddress(i);
+        }
+        else if (m_sections.getName(i) == ".eh_frame" && m_sections.getType(i) == elf::k_progbits)
+        {
+            ehFrame = m_sections.getAddress(i);
+            ehFrameSize = m_sections.getSize(i);
+        }
+    }
+
+    m_functions.createIndex(m_data, m_sizeFile, *this, hdr, ehFrame, ehFrameSize, m_is64, m_isLE);
 }
 
 void AbstractSegments::createDynamic()
 {
+    // every segment and section is known by now
+    indexAddresses();
+
     BOOST_FOREACH (const Segment &program, m_programs)
     {
         if (program.isDynamic())
@@ -99,7 +169,7 @@ void AbstractSegments::createDynamic()
 
             if (m_offset + m_size <= m_sizeFile)
             {
-                m_dynamic.createDynamic(m_data, m_offset,
+                m_dynamic.createDynamic(m_data, m_sizeFile, m_offset,
                                         m_size, m_baseAddress,
                                         m_is64, m_isLE, *this);
 
@@ -109,6 +179,9 @@ void AbstractSegments::createDynamic()
                 m_dynSymbols.createSymbols(m_data, m_sizeFile, symTab, m_dynamic.getSymbolTableSize(),
                                            strTab, m_dynamic.getStringTableSize(),
                                            *this, m_is64, m_isLE, m_isDY);
+                m_relocations.createRelocations(m_data, m_sizeFile, m_dynamic, *this, m_is64, m_isLE);
+                m_versions.createVersions(m_data, m_sizeFile, m_dynamic, *this,
+                                          m_dynSymbols.getSymbols().size(), m_is64, m_isLE);
 
                 // pull out the init array
                 if (m_dynamic.getInitArray() != 0 && m_dynamic.getInitArrayEntries() != 0)
@@ -126,16 +199,16 @@ void AbstractSegments::createDynamic()
         }
     }
 
-    BOOST_FOREACH (const Segment &section, m_sections)
+    for (std::size_t i = 0; i < m_sections.size(); ++i)
     {
-        if (section.isDynamic())
+        if (m_sections.getType(i) == elf::k_dynamic)
         {
-            m_offset = section.getPhysOffset();
-            m_size = section.getSize();
+            m_offset = m_sections.getOffset(i);
+            m_size = m_sections.getSize(i);
 
             if (m_offset <= m_sizeFile && m_size <= m_sizeFile)
             {
-                m_dynamic.createDynamic(m_data, m_offset,
+                m_dynamic.createDynamic(m_data, m_sizeFile, m_offset,
                                         m_size, m_baseAddress,
                                         m_is64, m_isLE, *this);
 
@@ -145,6 +218,9 @@ void AbstractSegments::createDynamic()
                 m_dynSymbols.createSymbols(m_data, m_sizeFile, symTab, m_dynamic.getSymbolTableSize(),
                                            strTab, m_dynamic.getStringTableSize(),
                                            *this, m_is64, m_isLE, m_isDY);
+                m_relocations.createRelocations(m_data, m_sizeFile, m_dynamic, *this, m_is64, m_isLE);
+                m_versions.createVersions(m_data, m_sizeFile, m_dynamic, *this,
+                                          m_dynSymbols.getSymbols().size(), m_is64, m_isLE);
 
                 // make sure we don't parse these again
                 m_offsets.insert(m_data + symTab);
@@ -159,173 +235,233 @@ void AbstractSegments::generateSegments()
 {
     // Track the string and symbol tables are correlate them using link after
     // the first pass through.
-    std::size_t tableIndex = 0;
     std::set<std::size_t> strTab;
     std::set<std::size_t> symTab;
-    BOOST_FOREACH (const Segment &section, m_sections)
+    for (std::size_t tableIndex = 0; tableIndex < m_sections.size(); ++tableIndex)
     {
-        m_offset = section.getPhysOffset();
-        m_size = section.getSize();
+        m_offset = m_sections.getOffset(tableIndex);
+        m_size = m_sections.getSize(tableIndex);
 
         if (m_offset != 0 && m_size != 0)
         {
             if (m_offsets.find(m_data + m_offset) == m_offsets.end())
             {
-                if (section.getType() == "K_NOTE")
+                const boost::uint32_t type = m_sections.getType(tableIndex);
+                const std::string &name = m_sections.getName(tableIndex);
+                if (type == elf::k_note)
                 {
-
-                    m_types.push_back(new NoteSegment(m_data, m_offset, section.getSize(), elf::k_note));
-                    m_offsets.insert(m_data + section.getPhysOffset());
+                    if (m_offset + m_sections.getSize(tableIndex) > m_sizeFile)
+                    {
+                        continue;
+                    }
+                    m_types.push_back(new NoteSegment(m_data, m_offset, m_sections.getSize(tableIndex), elf::k_note,
+                                                      m_sections.getAlign(tableIndex), m_machine, m_is64, m_isLE));
+                    m_offsets.insert(m_data + m_offset);
                 }
-                else if (section.getType() == "K_PROGBITS")
+                else if (type == elf::k_progbits)
                 {
-                    if (section.getName() == ".comment")
+                    if (name == ".comment")
                     {
-                        m_types.push_back(new CommentSegment(m_data, m_offset, section.getSize(), elf::k_progbits));
+                        m_types.push_back(new CommentSegment(m_data, m_offset, m_sections.getSize(tableIndex), elf::k_progbits));
                         m_offsets.insert(m_data + m_offset);
                     }
-                    else if (section.getName() == ".gnu_debuglink")
+                    else if (name == ".gnu_debuglink")
                     {
-                        m_types.push_back(new DebugLinkSegment(m_data, m_offset, section.getSize(), elf::k_progbits));
+                        m_types.push_back(new DebugLinkSegment(m_data, m_offset, m_sections.getSize(tableIndex), elf::k_progbits));
                         m_offsets.insert(m_data + m_offset);
                     }
-                    else if (section.getName() == ".interp")
+                    else if (name == ".interp")
                     {
-                        m_types.push_back(new InterpSegment(m_data, m_offset, section.getSize(), elf::k_progbits));
+                        m_types.push_back(new InterpSegment(m_data, m_offset, m_sections.getSize(tableIndex), elf::k_progbits));
                         m_offsets.insert(m_data + m_offset);
                     }
-                    else if (section.getName() == ".rodata")
+                    else if (name == ".rodata")
                     {
-                        m_types.push_back(new ReadOnlySegment(m_data, m_offset, section.getSize(), elf::k_progbits));
+                        m_types.push_back(new ReadOnlySegment(m_data, m_offset, m_sections.getSize(tableIndex), elf::k_progbits));
                         m_offsets.insert(m_data + m_offset);
                     }
-                    else if (m_ctorsArray.getOffset() == 0 && section.getName() == ".ctors")
+                    else if (m_ctorsArray.getOffset() == 0 && name == ".ctors")
                     {
                         m_ctorsArray.set(m_data, m_sizeFile, m_offset,
-                                         section.getSize() / (m_is64 ? 8 : 4), m_is64, m_isLE);
+                                         m_sections.getSize(tableIndex) / (m_is64 ? 8 : 4), m_is64, m_isLE);
                         m_offsets.insert(m_data + m_offset);
                     }
                 }
-                else if (section.getType() == "K_STRTAB")
+                else if (type == elf::k_strtab)
                 {
                     strTab.insert(tableIndex);
                 }
-                else if (section.getType() == "K_SYMTAB")
+                else if (type == elf::k_symtab)
                 {
                     symTab.insert(tableIndex);
                 }
-                else if (m_initArray.getOffset() == 0 && section.getType() == "K_INIT_ARRAY")
+                else if (m_initArray.getOffset() == 0 && type == elf::k_initArray)
                 {
                     m_initArray.set(m_data, m_sizeFile, m_offset,
-                                    section.getSize() / (m_is64 ? 8 : 4), m_is64, m_isLE);
+                                    m_sections.getSize(tableIndex) / (m_is64 ? 8 : 4), m_is64, m_isLE);
                     m_offsets.insert(m_data + m_offset);
                 }
-                else if (section.getType() == "K_DYNAMIC")
+                else if (type == elf::k_dynamic)
                 {
                     assert("should not hit here" == 0);
                 }
             }
         }
-        ++tableIndex;
+    }
+
+    // without section headers the notes are only found through the program
+    // headers. a PT_NOTE that starts at a note section was parsed with it
+    BOOST_FOREACH (const AbstractProgramHeader &program, m_notePrograms)
+    {
+        if (program.getOffset() != 0 && program.getFileSize() != 0 &&
+            program.getOffset() + program.getFileSize() <= m_sizeFile &&
+            m_offsets.find(m_data + program.getOffset()) == m_offsets.end())
+        {
+            m_types.push_back(new NoteSegment(m_data, program.getOffset(), program.getFileSize(), elf::k_note,
+                                              program.getAlign(), m_machine, m_is64, m_isLE));
+            m_offsets.insert(m_data + program.getOffset());
+        }
     }
 
     // loop over the symbol tables we saved and resolve the links.
     BOOST_FOREACH (std::size_t index, symTab)
     {
         // validate that the symtab has a good strtab
-        if (m_sections.size() > m_sections[index].getLink() &&
-            m_sections[m_sections[index].getLink()].getType() == "K_STRTAB")
+        if (m_sections.size() > m_sections.getLink(index) &&
+            m_sections.getType(m_sections.getLink(index)) == elf::k_strtab)
         {
             // create the strtab segment
-            std::size_t link = m_sections[index].getLink();
+            std::size_t link = m_sections.getLink(index);
             strTab.erase(link);
 
             // check to see if this is a fake/copied symbol table.
-            if (m_sections[link].getPhysOffset() != 0 &&
-                m_sections[link].getVirtAddress() != 0 &&
-                m_sections[link].getVirtAddress() == m_dynamic.getStringTableVirtualAddress() &&
-                m_sections[link].getPhysOffset() != getOffsetFromVirt(m_dynamic.getStringTableVirtualAddress()))
+            if (m_sections.getOffset(link) != 0 &&
+                m_sections.getAddress(link) != 0 &&
+                m_sections.getAddress(link) == m_dynamic.getStringTableVirtualAddress() &&
+                m_sections.getOffset(link) != getOffsetFromVirt(m_dynamic.getStringTableVirtualAddress()))
             {
                 m_fakeDynamicStringTable = true;
             }
             else
             {
                 m_types.push_back(new StringTableSegment(m_data,
-                                                         m_sections[link].getPhysOffset(), m_sections[link].getSize(), elf::k_strtab));
-                m_offsets.insert(m_data + m_sections[link].getPhysOffset());
+                                                         m_sections.getOffset(link), m_sections.getSize(link), elf::k_strtab));
+                m_offsets.insert(m_data + m_sections.getOffset(link));
             }
 
             // create the symtab segment
             Symbols *otherSymbols = new Symbols();
-            otherSymbols->createSymbols(m_data, m_sizeFile, m_sections[index].getPhysOffset(),
-                                        m_sections[index].getSize(),
-                                        m_sections[link].getPhysOffset(),
-                                        m_sections[link].getSize(),
+            otherSymbols->setDemangle(m_demangle);
+            otherSymbols->createSymbols(m_data, m_sizeFile, m_sections.getOffset(index),
+                                        m_sections.getSize(index),
+                                        m_sections.getOffset(link),
+                                        m_sections.getSize(link),
                                         *this, m_is64, m_isLE, m_isDY);
             m_otherSymbols.push_back(otherSymbols);
-            m_offsets.insert(m_data + m_sections[index].getPhysOffset());
+            m_offsets.insert(m_data + m_sections.getOffset(index));
         }
     }
 
     // for any remaining strtab just create the segment
     BOOST_FOREACH (std::size_t index, strTab)
     {
-        m_types.push_back(new StringTableSegment(m_data, m_sections[index].getPhysOffset(),
-                                                 m_sections[index].getSize(), elf::k_strtab));
-        m_offsets.insert(m_data + m_sections[index].getPhysOffset());
+        m_types.push_back(new StringTableSegment(m_data, m_sections.getOffset(index),
+                                                 m_sections.getSize(index), elf::k_strtab));
+        m_offsets.insert(m_data + m_sections.getOffset(index));
     }
 
+    indexFunctions();
+
     // segments are done try to resolve init array functions
     std::vector<std::pair<boost::uint64_t, std::string>> &initArray = m_initArray.getEntries();
     for (std::size_t j = 0; j < initArray.size(); ++j)
     {
-        for (std::size_t i = 0; i < m_otherSymbols.size(); ++i)
+        std::string resolved = findSymbol(initArray[j].first);
+        if (!resolved.empty())
         {
-            std::string resolved = m_otherSymbols[i].findSymbol(initArray[j].first);
-            if (!resolved.empty())
-            {
-                initArray[j].second.assign(resolved);
-            }
+            initArray[j].second.assign(resolved);
         }
     }
     std::vector<std::pair<boost::uint64_t, std::string>> &ctorsArray = m_ctorsArray.getEntries();
     for (std::size_t j = 0; j < ctorsArray.size(); ++j)
     {
-        for (std::size_t i = 0; i < m_otherSymbols.size(); ++i)
+        std::string resolved = findSymbol(ctorsArray[j].first);
+        if (!resolved.empty())
         {
-            std::string resolved = m_otherSymbols[i].findSymbol(ctorsArray[j].first);
-            if (!resolved.empty())
-            {
-                ctorsArray[j].second.assign(resolved);
-            }
+            ctorsArray[j].second.assign(resolved);
         }
     }
 }
 
-boost::uint64_t AbstractSegments::getBaseAddress() const
+std::string AbstractSegments::findSymbol(boost::uint64_t p_address) const
 {
-    return m_baseAddress;
+    // the later tables win
+    for (std::size_t i = m_otherSymbols.size(); i != 0; --i)
+    {
+        std::string resolved = m_otherSymbols[i - 1].findSymbol(p_address);
+        if (!resolved.empty())
+        {
+            return resolved;
+        }
+    }
+    return std::string();
 }
 
-boost::uint64_t AbstractSegments::getOffsetFromVirt(boost::uint64_t p_virtual) const
+const AbstractSymbol *AbstractSegments::findDynamicSymbol(boost::string_view p_name) const
 {
-    BOOST_FOREACH (const Segment &program, m_programs)
+    const std::vector<AbstractSymbol> &symbols(m_dynSymbols.getSymbols());
+    const SymbolHash &hash(m_dynamic.getHash());
+    std::size_t unhashed = symbols.size();
+    if (!hash.empty())
     {
-        if (program.getVirtAddress() <= p_virtual &&
-            (program.getVirtAddress() + program.getSize()) > p_virtual)
+        const AbstractSymbol *found = hash.lookup(p_name, symbols);
+        if (found != NULL)
         {
-            return program.getPhysOffset() + (p_virtual - program.getVirtAddress());
+            return found;
         }
+        unhashed = std::min(hash.getFirstHashed(), symbols.size());
     }
-    BOOST_FOREACH (const Segment &section, m_sections)
+
+    for (std::size_t i = 0; i < unhashed; ++i)
     {
-        if (section.getVirtAddress() <= p_virtual &&
-            (section.getVirtAddress() + section.getSize()) > p_virtual)
+        if (symbols[i].getName() == p_name)
         {
-            return section.getPhysOffset() + (p_virtual - section.getVirtAddress());
+            return &symbols[i];
         }
     }
-    return 0;
+    return NULL;
+}
+
+const AbstractSymbol *AbstractSegments::findNearestSymbol(boost::uint64_t p_address) const
+{
+    const AbstractSymbol *nearest = m_dynSymbols.findNearestSymbol(p_address);
+    BOOST_FOREACH (const Symbols &other, m_otherSymbols)
+    {
+        const AbstractSymbol *candidate = other.findNearestSymbol(p_address);
+        if (candidate != NULL && (nearest == NULL || candidate->getValue() >= nearest->getValue()))
+        {
+            nearest = candidate;
+        }
+    }
+    return nearest;
+}
+
+boost::uint64_t AbstractSegments::getBaseAddress() const
+{
+    return m_baseAddress;
+}
+
+boost::uint64_t AbstractSegments::getOffsetFromVirt(boost::uint64_t p_virtual) const
+{
+    boost::uint64_t offset = 0;
+    m_addressIndex.translate(p_virtual, offset);
+    return offset;
+}
+
+void AbstractSegments::getOffsetsFromVirt(const std::vector<boost::uint64_t> &p_virtual,
+                                          std::vector<boost::uint64_t> &p_offsets) const
+{
+    m_addressIndex.translate(p_virtual, p_offsets);
 }
 
 void AbstractSegments::evaluate(std::vector<std::pair<boost::int32_t, std::string>> &p_reasons,
@@ -333,6 +469,7 @@ void AbstractSegments::evaluate(std::vector<std::pair<boost::int32_t, std::strin
 {
     m_dynamic.evaluate(p_reasons, p_capabilities);
     m_dynSymbols.evaluate(p_reasons, p_capabilities);
+    m_relocations.evaluate(m_dynSymbols, p_capabilities);
 
     BOOST_FOREACH (const SegmentType &seg, m_types)
     {
@@ -375,6 +512,34 @@ const Symbols &AbstractSegments::getDynamicSymbols() const
     return m_dynSymbols;
 }
 
+const Relocations &AbstractSegments::getRelocations() const
+{
+    return m_relocations;
+}
+
+const SymbolVersions &AbstractSegments::getSymbolVersions() const
+{
+    return m_versions;
+}
+
+const FunctionIndex &AbstractSegments::getFunctionIndex() const
+{
+    return m_functions;
+}
+
+boost::string_view AbstractSegments::getBuildId() const
+{
+    BOOST_FOREACH (const SegmentType &segment, m_types)
+    {
+        const NoteSegment *notes = dynamic_cast<const NoteSegment *>(&segment);
+        if (notes != NULL && !notes->getBuildId().empty())
+        {
+            return notes->getBuildId();
+        }
+    }
+    return boost::string_view();
+}
+
 std::string AbstractSegments::determineFamily() const
 {
     const std::set<std::string> &files(getFiles());
@@ -400,12 +565,16 @@ std::string AbstractSegments::determineFamily() const
         return "TinySH";
     }
 
-    const std::vector<AbstractSymbol> &symbols(getAllSymbols());
-    BOOST_FOREACH (const AbstractSymbol &symbol, symbols)
+    const AbstractSymbol *tsunami = findDynamicSymbol("tsunami");
+    if (tsunami != NULL && tsunami->getType() == elf::symbol::k_function)
+    {
+        return "ELF.Kaiten";
+    }
+    BOOST_FOREACH (const Symbols &other, m_otherSymbols)
     {
-        if (symbol.getType() == elf::symbol::k_function)
+        BOOST_FOREACH (const AbstractSymbol &symbol, other.getSymbols())
         {
-            if (symbol.getName() == "tsunami")
+            if (symbol.getType() == elf::symbol::k_function && symbol.getName() == "tsunami")
             {
                 return "ELF.Kaiten";
             }
@@ -448,6 +617,9 @@ std::string AbstractSegments::printToStdOut() const
     std::stringstream returnValue;
     returnValue << m_dynamic.printToStdOut();
     returnValue << m_dynSymbols.printToStdOut();
+    returnValue << m_relocations.printToStdOut(m_dynSymbols);
+    returnValue << m_versions.printToStdOut();
+    returnValue << m_functions.printToStdOut(*this);
     returnValue << m_initArray.printToStd();
 
     BOOST_FOREACH (const SegmentType &seg, m_types)
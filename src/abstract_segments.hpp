@@ -10,12 +10,16 @@
 #include <boost/ptr_container/ptr_vector.hpp>
 
 #include "symbols.hpp"
+#include "relocations.hpp"
+#include "symbol_versions.hpp"
+#include "function_index.hpp"
 #include "initarray.hpp"
 #include "dynamicsection.hpp"
+#include "section_table.hpp"
+#include "address_index.hpp"
 #include "segment_types/segment_type.hpp"
 #include "structures/capabilities.hpp"
 
-class AbstractSectionHeader;
 class AbstractProgramHeader;
 class Segment;
 
@@ -37,9 +41,14 @@ class AbstractSegments
         std::set<std::string> getFiles() const;
 
         void setStart(const char* p_data, boost::uint32_t p_size,
-                    bool p_is64, bool p_isLE, bool p_isDY);
+                    bool p_is64, bool p_isLE, bool p_isDY,
+                    boost::uint16_t p_machine);
 
-        void makeSegmentFromSectionHeader(const AbstractSectionHeader& p_segment);
+        //! copies the decoded section table
+        void setSections(const SectionTable& p_sections);
+
+        //! displays the C++ symbol names demangled (the default) or as they are in the file
+        void setDemangle(bool p_demangle);
 
         void makeSegmentFromProgramHeader(const AbstractProgramHeader& p_header);
 
@@ -49,8 +58,18 @@ class AbstractSegments
         //! \return the base address
         boost::uint64_t getBaseAddress() const;
 
+        //! \return the file offset of p_virtual. 0 if no segment or section holds it
         boost::uint64_t getOffsetFromVirt(boost::uint64_t p_virtual) const;
 
+        /*!
+        * Translates a batch of virtual addresses into file offsets, like
+        * getOffsetFromVirt(). Sorted addresses are translated the fastest.
+        * \param[in] p_virtual the virtual addresses
+        * \param[out] p_offsets the file offsets, 0 for unmapped addresses
+        */
+        void getOffsetsFromVirt(const std::vector<boost::uint64_t>& p_virtual,
+                                std::vector<boost::uint64_t>& p_offsets) const;
+
         /*!
         * Calls into the various segments for evaluation / scoring information.
         * \param[in,out] p_reasons stores the scoring and reasons
@@ -71,8 +90,38 @@ class AbstractSegments
         std::string printToStdOut() const;
 
         std::vector<AbstractSymbol> getAllSymbols() const;
+
+        /*!
+        * \return the name of the symbol at p_address in the symbol tables
+        * (not the dynamic one). Empty if there is none.
+        */
+        std::string findSymbol(boost::uint64_t p_address) const;
+
+        /*!
+        * \return the defined symbol closest to p_address at or below it, in
+        * any symbol table. NULL if there is none.
+        */
+        const AbstractSymbol* findNearestSymbol(boost::uint64_t p_address) const;
+
+        /*!
+        * Finds a dynamic symbol by name. The defined symbols are probed for
+        * through the hash tables, the imports GNU_HASH leaves out are scanned.
+        * \return the symbol. NULL if there is none
+        */
+        const AbstractSymbol* findDynamicSymbol(boost::string_view p_name) const;
         const DynamicSection& getDynamicSection() const;
         const Symbols& getDynamicSymbols() const;
+        const Relocations& getRelocations() const;
+        const SymbolVersions& getSymbolVersions() const;
+
+        /*!
+        * \return the descriptor of the first NT_GNU_BUILD_ID note, as it is in
+        * the file. Empty if there is none.
+        */
+        boost::string_view getBuildId() const;
+
+        //! \return the functions the unwind tables describe
+        const FunctionIndex& getFunctionIndex() const;
 
     private:
 
@@ -80,18 +129,30 @@ class AbstractSegments
         AbstractSegments(const AbstractSegments& p_rhs);
         AbstractSegments& operator=(const AbstractSegments& p_rhs);
 
+        //! Indexes the address ranges of the programs and sections
+        void indexAddresses();
+
+        //! Finds the unwind tables and indexes the functions they describe
+        void indexFunctions();
+
         //! the start of the file in memory
         const char* m_data;
 
         //! the size of the file in memory
         boost::uint32_t m_sizeFile;
 
-        //! All the section segments
-        std::vector<Segment> m_sections;
+        //! The section table
+        SectionTable m_sections;
 
         //! All the program segments
         std::vector<Segment> m_programs;
 
+        //! The PT_NOTE program headers
+        std::vector<AbstractProgramHeader> m_notePrograms;
+
+        //! The address ranges of the programs (first) and the sections
+        AddressIndex m_addressIndex;
+
         //! All the sections/programs converted to subtypes
         boost::ptr_vector<SegmentType> m_types;
 
@@ -107,6 +168,15 @@ class AbstractSegments
         //! A populated list of the symbols
         Symbols m_dynSymbols;
 
+        //! The relocations of the dynamic symbols
+        Relocations m_relocations;
+
+        //! The versions of the dynamic symbols
+        SymbolVersions m_versions;
+
+        //! The functions found through .eh_frame_hdr / .eh_frame
+        FunctionIndex m_functions;
+
         //! Other symbols
         boost::ptr_vector<Symbols> m_otherSymbols;
 
@@ -128,9 +198,15 @@ class AbstractSegments
         //! indicates if this is an so or executable
         bool m_isDY;
 
+        //! the e_machine of the binary
+        boost::uint16_t m_machine;
+
         //! indicates if we detected a fake dynamic string table
         bool m_fakeDynamicStringTable;
 
+        //! indicates if the symbol names are displayed demangled
+        bool m_demangle;
+
         // offsets this section and program header
         boost::uint32_t m_offset;
         boost::uint32_t m_size;
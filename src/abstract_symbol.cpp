@@ -1,15 +1,10 @@
 #include "abstract_symbol.hpp"
 
 #include "structures/symtable_entry.hpp"
+#include "elf_view.hpp"
+#include "demangler.hpp"
 
 #include <boost/lexical_cast.hpp>
-#include <sstream>
-
-#if WINDOWS || __APPLE__
-#include "endian.hpp"
-#else
-#include <arpa/inet.h>
-#endif
 
 std::string getSymBinding(boost::uint8_t p_info)
 {
@@ -62,28 +57,35 @@ std::string getSymType(boost::uint8_t p_info)
     return str;
 }
 
-AbstractSymbol::AbstractSymbol(const char *p_data, boost::uint32_t p_offset,
-                               bool p_is64, bool p_isLE) : m_symbol32(),
-                                                           m_symbol64(),
-                                                           m_name(),
-                                                           m_is64(p_is64),
-                                                           m_isLE(p_isLE)
+template <typename Class, typename Order>
+AbstractSymbol::AbstractSymbol(const elf::view::SymbolView<Class, Order>& p_view) :
+    m_value(p_view.getValue()),
+    m_nameIndex(p_view.getName()),
+    m_sectionIndex(p_view.getSectionIndex()),
+    m_info(p_view.getInfo()),
+    m_name(),
+    m_mangled(false),
+    m_is64(Class::k_is64)
 {
-    if (m_is64)
-        m_symbol64 = reinterpret_cast<const elf::symbol::symtable_entry64 *>(p_data + p_offset);
-    else
-        m_symbol32 = reinterpret_cast<const elf::symbol::symtable_entry32 *>(p_data + p_offset);
-
-    std::stringstream value;
-    value << "0x" << std::hex << getValue();
-    m_name.assign(value.str());
 }
 
-AbstractSymbol::AbstractSymbol(const AbstractSymbol &p_rhs) :   m_symbol32(p_rhs.m_symbol32),
-    m_symbol64(p_rhs.m_symbol64),
-    m_name (p_rhs.m_name),
-    m_is64 (p_rhs.m_is64),
-    m_isLE (p_rhs.m_isLE)
+template AbstractSymbol::AbstractSymbol(
+    const elf::view::SymbolView<elf::view::Class32, elf::view::LittleEndian>&);
+template AbstractSymbol::AbstractSymbol(
+    const elf::view::SymbolView<elf::view::Class32, elf::view::BigEndian>&);
+template AbstractSymbol::AbstractSymbol(
+    const elf::view::SymbolView<elf::view::Class64, elf::view::LittleEndian>&);
+template AbstractSymbol::AbstractSymbol(
+    const elf::view::SymbolView<elf::view::Class64, elf::view::BigEndian>&);
+
+AbstractSymbol::AbstractSymbol(const AbstractSymbol &p_rhs) :
+    m_value(p_rhs.m_value),
+    m_nameIndex(p_rhs.m_nameIndex),
+    m_sectionIndex(p_rhs.m_sectionIndex),
+    m_info(p_rhs.m_info),
+    m_name(p_rhs.m_name),
+    m_mangled(p_rhs.m_mangled),
+    m_is64(p_rhs.m_is64)
 {
 }
 
@@ -93,35 +95,17 @@ AbstractSymbol::~AbstractSymbol()
 
 boost::uint32_t AbstractSymbol::getStructSize() const
 {
-    boost::uint32_t size;
-    if (m_is64)
-        size = sizeof(elf::symbol::symtable_entry64);
-    else
-        size = sizeof(elf::symbol::symtable_entry32);
-
-    return size;
+    return m_is64 ? sizeof(elf::symbol::symtable_entry64) : sizeof(elf::symbol::symtable_entry32);
 }
 
 boost::uint8_t AbstractSymbol::getType() const
 {
-    boost::uint8_t type;
-    if (m_is64)
-        type = m_symbol64->m_info & 0x0f;
-    else 
-        type = m_symbol32->m_info & 0x0f;
-
-    return type;
+    return m_info & 0x0f;
 }
 
 boost::uint8_t AbstractSymbol::getInfo() const
 {
-    boost::uint8_t info;
-    if (m_is64)
-        info = m_symbol64->m_info;
-    else
-        info = m_symbol32->m_info;
-
-    return info;
+    return m_info;
 }
 
 std::string AbstractSymbol::getTypeName() const
@@ -136,44 +120,37 @@ std::string AbstractSymbol::getBinding() const
 
 boost::uint64_t AbstractSymbol::getValue() const
 {
-    boost::uint64_t value;
-    if (m_is64)
-        value = m_isLE ? m_symbol64->m_address : htobe64(m_symbol64->m_address);
-    else 
-        value = m_isLE ? m_symbol32->m_address : ntohl(m_symbol32->m_address);
-
-    return value;
+    return m_value;
 }
 
 boost::uint32_t AbstractSymbol::getNameIndex() const
 {
-    boost::uint32_t name;
-    if (m_is64)
-        name = m_isLE ? m_symbol64->m_name : ntohl(m_symbol64->m_name);
-    else
-        name = m_isLE ? m_symbol32->m_name : ntohl(m_symbol32->m_name);
-
-    return name;
+    return m_nameIndex;
 }
 
 boost::uint16_t AbstractSymbol::getSectionIndex() const
 {
-    boost::uint16_t index;
-    if (m_is64)
-        index = m_isLE ? m_symbol64->m_shndx : ntohs(m_symbol64->m_shndx);
-    else 
-        index = m_isLE ? m_symbol32->m_shndx : ntohs(m_symbol32->m_shndx);
-
-    return index;
+    return m_sectionIndex;
 }
 
-const std::string &AbstractSymbol::getName() const
+boost::string_view AbstractSymbol::getName() const
 {
     return m_name;
 }
 
-void AbstractSymbol::setName(const std::string &p_name)
+std::string AbstractSymbol::getDemangledName() const
+{
+    if (m_mangled)
+        return Demangler::demangle(m_name);
+
+    return m_name.to_string();
+}
+
+void AbstractSymbol::setName(boost::string_view p_name, bool p_mangled)
 {
     if (!p_name.empty())
-        m_name.assign(p_name);
+    {
+        m_name = p_name;
+        m_mangled = p_mangled;
+    }
 }
@@ -3,21 +3,22 @@
 
 #include <string>
 #include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
 
 namespace elf
 {
-    namespace symbol
+    namespace view
     {
-        struct symtable_entry32;
-        struct symtable_entry64;
+        template <typename Class, typename Order> class SymbolView;
     }
 }
 
 class AbstractSymbol
 {
 public:
-    AbstractSymbol(const char* p_data, boost::uint32_t p_offset,
-                   bool p_is64, bool p_isLE);
+    // decodes the symbol p_view points at
+    template <typename Class, typename Order>
+    explicit AbstractSymbol(const elf::view::SymbolView<Class, Order>& p_view);
     AbstractSymbol(const AbstractSymbol& p_rhs);
     ~AbstractSymbol();
 
@@ -28,10 +29,17 @@ public:
     std::string getBinding() const;
     boost::uint64_t getValue() const;
     boost::uint32_t getNameIndex() const;
-    const std::string& getName() const;
+    // a view of the name in the file or in the symbol table's string pool
+    boost::string_view getName() const;
+    // the name as it is displayed. demangled (and cached) on first use if it is mangled
+    std::string getDemangledName() const;
     boost::uint16_t getSectionIndex() const;
 
-    void setName(const std::string& p_name);
+    /*
+     * p_name has to outlive the symbol. an empty name is ignored
+     * p_mangled p_name may be a mangled C++ name
+     */
+    void setName(boost::string_view p_name, bool p_mangled = false);
 
 private:
 
@@ -40,11 +48,13 @@ private:
 
 private:
 
-    const elf::symbol::symtable_entry32* m_symbol32;
-    const elf::symbol::symtable_entry64* m_symbol64;
-    std::string m_name;
+    boost::uint64_t m_value;
+    boost::uint32_t m_nameIndex;
+    boost::uint16_t m_sectionIndex;
+    boost::uint8_t m_info;
+    boost::string_view m_name;
+    bool m_mangled;
     bool m_is64;
-    bool m_isLE;
 };
 
 #endif
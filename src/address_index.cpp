@@ -0,0 +1,157 @@
+#include "address_index.hpp"
+
+#include <set>
+#include <algorithm>
+
+namespace
+{
+    // a range starting or ending
+    struct Event
+    {
+        boost::uint64_t m_position;
+        std::size_t m_range;
+        bool m_start;
+
+        bool operator<(const Event& p_rhs) const
+        {
+            return m_position < p_rhs.m_position;
+        }
+    };
+}
+
+AddressIndex::AddressIndex() :
+    m_ranges(),
+    m_starts(),
+    m_ends(),
+    m_owners()
+{
+}
+
+AddressIndex::~AddressIndex()
+{
+}
+
+void AddressIndex::add(boost::uint64_t p_address, boost::uint64_t p_size, boost::uint64_t p_offset)
+{
+    Range range = { p_address, p_address + p_size, p_offset };
+    m_ranges.push_back(range);
+}
+
+void AddressIndex::clear()
+{
+    m_ranges.clear();
+    m_starts.clear();
+    m_ends.clear();
+    m_owners.clear();
+}
+
+void AddressIndex::build()
+{
+    m_starts.clear();
+    m_ends.clear();
+    m_owners.clear();
+
+    std::vector<Event> events;
+    events.reserve(m_ranges.size() * 2);
+    for (std::size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        // an empty or wrapping range can't hold an address
+        if (m_ranges[i].m_end > m_ranges[i].m_address)
+        {
+            Event start = { m_ranges[i].m_address, i, true };
+            Event end = { m_ranges[i].m_end, i, false };
+            events.push_back(start);
+            events.push_back(end);
+        }
+    }
+    std::sort(events.begin(), events.end());
+
+    /* sweep over the boundaries. between two of them the ranges covering the
+     * addresses don't change and the one added first owns the interval */
+    std::set<std::size_t> active;
+    std::size_t i = 0;
+    while (i < events.size())
+    {
+        const boost::uint64_t position = events[i].m_position;
+        for ( ; i < events.size() && events[i].m_position == position; ++i)
+        {
+            if (events[i].m_start)
+            {
+                active.insert(events[i].m_range);
+            }
+            else
+            {
+                active.erase(events[i].m_range);
+            }
+        }
+
+        if (active.empty())
+        {
+            continue;
+        }
+
+        // something is still active, so there is a next boundary
+        const boost::uint64_t next = events[i].m_position;
+        const std::size_t owner = *active.begin();
+        if (!m_owners.empty() && m_owners.back() == owner && m_ends.back() == position)
+        {
+            m_ends.back() = next;
+        }
+        else
+        {
+            m_starts.push_back(position);
+            m_ends.push_back(next);
+            m_owners.push_back(owner);
+        }
+    }
+}
+
+std::size_t AddressIndex::find(boost::uint64_t p_address) const
+{
+    const std::size_t after = std::upper_bound(m_starts.begin(), m_starts.end(), p_address) - m_starts.begin();
+    if (after == 0 || p_address >= m_ends[after - 1])
+    {
+        return m_starts.size();
+    }
+    return after - 1;
+}
+
+bool AddressIndex::translate(boost::uint64_t p_address, boost::uint64_t& p_offset) const
+{
+    const std::size_t interval = find(p_address);
+    if (interval == m_starts.size())
+    {
+        return false;
+    }
+
+    const Range& range = m_ranges[m_owners[interval]];
+    p_offset = range.m_offset + (p_address - range.m_address);
+    return true;
+}
+
+void AddressIndex::translate(const std::vector<boost::uint64_t>& p_addresses,
+                             std::vector<boost::uint64_t>& p_offsets) const
+{
+    p_offsets.resize(p_addresses.size());
+
+    // neighbouring addresses tend to fall in the same interval
+    std::size_t interval = m_starts.size();
+    for (std::size_t i = 0; i < p_addresses.size(); ++i)
+    {
+        const boost::uint64_t address = p_addresses[i];
+        if (interval == m_starts.size() || address < m_starts[interval] || address >= m_ends[interval])
+        {
+            interval = find(address);
+        }
+
+        if (interval == m_starts.size())
+        {
+            p_offsets[i] = 0;
+        }
+        else
+        {
+            const Range& range = m_ranges[m_owners[interval]];
+            p_offsets[i] = range.m_offset + (address - range.m_address);
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef ADDRESS_INDEX_HPP
+#define ADDRESS_INDEX_HPP
+
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+/*
+ * Translates virtual addresses to file offsets. The ranges (segments and
+ * sections) may overlap, the one added first wins. build() turns them into
+ * sorted, disjoint intervals, each knowing the range that owns it, so a
+ * translation is a binary search instead of a walk over every range.
+ */
+class AddressIndex
+{
+public:
+
+    AddressIndex();
+    ~AddressIndex();
+
+    /*
+     * adds a range. ranges added earlier take precedence. an empty range, or
+     * one that wraps around the address space, never matches
+     * p_address the virtual address of the range
+     * p_size the size of the range
+     * p_offset the file offset p_address is at
+     */
+    void add(boost::uint64_t p_address, boost::uint64_t p_size, boost::uint64_t p_offset);
+
+    // builds the intervals from the ranges added so far
+    void build();
+
+    // forgets the ranges and the intervals
+    void clear();
+
+    /*
+     * translates p_address into p_offset.
+     * return false if no range holds p_address (p_offset is left alone)
+     */
+    bool translate(boost::uint64_t p_address, boost::uint64_t& p_offset) const;
+
+    /*
+     * translates every address in p_addresses. addresses no range holds are
+     * translated to 0. sorted or clustered addresses are the cheapest.
+     */
+    void translate(const std::vector<boost::uint64_t>& p_addresses,
+                   std::vector<boost::uint64_t>& p_offsets) const;
+
+private:
+
+    // return the interval p_address is in. m_starts.size() if there is none
+    std::size_t find(boost::uint64_t p_address) const;
+
+private:
+
+    // a range in the order it was added
+    struct Range
+    {
+        boost::uint64_t m_address;
+        boost::uint64_t m_end;
+        boost::uint64_t m_offset;
+    };
+
+    std::vector<Range> m_ranges;
+
+    // the intervals: [m_starts[i], m_ends[i]) belongs to m_ranges[m_owners[i]]
+    std::vector<boost::uint64_t> m_starts;
+    std::vector<boost::uint64_t> m_ends;
+    std::vector<std::size_t> m_owners;
+};
+
+#endif
@@ -0,0 +1,346 @@
+#include "batch_scanner.hpp"
+#include "elfparser.hpp"
+#include "thread_pool.hpp"
+#include "elf_carver.hpp"
+
+#include <sstream>
+#include <iostream>
+#include <thread>
+#include <memory>
+#include <stdexcept>
+#include <boost/bind/bind.hpp>
+#include <boost/filesystem.hpp>
+
+const std::size_t BatchScanner::k_inFlightPerJob;
+
+BatchScanner::BatchScanner(bool p_printReasons, bool p_printCapabilities, bool p_printELF) :
+    m_printReasons(p_printReasons),
+    m_printCapabilities(p_printCapabilities),
+    m_printELF(p_printELF),
+    m_failFast(false),
+    m_digests(ELFParser::k_allDigests),
+    m_printEntropy(false),
+    m_entropyWindow(EntropyProfile::k_defaultWindow),
+    m_entropyStride(EntropyProfile::k_defaultStride),
+    m_carve(false),
+    m_carveDepth(ElfCarver::k_defaultMaxDepth),
+    m_carveBytes(ElfCarver::k_defaultMaxBytes),
+    m_demangle(true),
+    m_checkpointPath(),
+    m_checkpoint(),
+    m_finished(),
+    m_outputLock(),
+    m_reportWritten(),
+    m_pendingReports(),
+    m_nextReport(0),
+    m_errors(),
+    m_scanned(0),
+    m_skipped(0),
+    m_abort(false)
+{
+}
+
+BatchScanner::~BatchScanner()
+{
+}
+
+void BatchScanner::setFailFast(bool p_failFast)
+{
+    m_failFast = p_failFast;
+}
+
+void BatchScanner::setDigests(unsigned int p_digests)
+{
+    m_digests = p_digests;
+}
+
+void BatchScanner::setEntropy(bool p_print, std::size_t p_window, std::size_t p_stride)
+{
+    m_printEntropy = p_print;
+    m_entropyWindow = p_window;
+    m_entropyStride = p_stride;
+}
+
+void BatchScanner::setCarve(bool p_carve, std::size_t p_maxDepth, boost::uint64_t p_maxBytes)
+{
+    m_carve = p_carve;
+    m_carveDepth = p_maxDepth;
+    m_carveBytes = p_maxBytes;
+}
+
+void BatchScanner::setDemangle(bool p_demangle)
+{
+    m_demangle = p_demangle;
+}
+
+void BatchScanner::setCheckpoint(const std::string &p_checkpoint)
+{
+    m_checkpointPath.assign(p_checkpoint);
+}
+
+const std::vector<BatchScanner::ScanError> &BatchScanner::getErrors() const
+{
+    return m_errors;
+}
+
+void BatchScanner::scanFile(const std::string &p_fileName, std::ostream &p_output) const
+{
+    ELFParser parser;
+    parser.setDigests(m_digests);
+    parser.setEntropyWindow(m_entropyWindow, m_entropyStride);
+    parser.setDemangle(m_demangle);
+    parser.parse(p_fileName);
+    parser.evaluate();
+
+    p_output << std::dec << "Overview : " << std::endl <<
+    " - Score: " << parser.getScore() << std::endl <<
+    " - Entropy: " << parser.getEntropy() << std::endl;
+
+    const std::string buildId(parser.getBuildId());
+    if (!buildId.empty())
+    {
+        p_output << " - Build ID: " << buildId << std::endl;
+    }
+
+    const std::string family(parser.getFamily());
+    if (!family.empty())
+    {
+        p_output << " - Family: " << family << std::endl;
+        if (m_digests & ELFParser::k_sha256)
+            p_output << " - SHA256: " << std::hex << parser.getSha256() << std::endl;
+        if (m_digests & ELFParser::k_sha1)
+            p_output << " - SHA1:   " << std::hex << parser.getSha1() << std::endl;
+        if (m_digests & ELFParser::k_md5)
+            p_output << " - MD5:    " << std::hex << parser.getMD5() << std::endl;
+    }
+    if (m_printReasons)
+        parser.printReasons(p_output);
+
+    if (m_printCapabilities)
+        parser.printCapabilities(p_output);
+
+    if (m_carve)
+    {
+        ElfCarver carver;
+        carver.setMaxDepth(m_carveDepth);
+        carver.setMaxBytes(m_carveBytes);
+        carver.carve(parser);
+
+        if (!parser.getChildren().empty() || !carver.getNotes().empty())
+        {
+            p_output << "Embedded Binaries : " << std::endl;
+            parser.printChildren(p_output);
+            BOOST_FOREACH (const std::string &note, carver.getNotes())
+                p_output << " - " << note << std::endl;
+        }
+    }
+
+    if (m_printEntropy)
+        parser.printEntropy(p_output);
+
+    if (m_printELF)
+        parser.printAll(p_output);
+}
+
+void BatchScanner::openCheckpoint()
+{
+    m_finished.clear();
+    if (m_checkpoint.is_open())
+        m_checkpoint.close();
+
+    if (m_checkpointPath.empty())
+        return;
+
+    // a missing checkpoint simply means nothing has been scanned yet
+    std::ifstream previous(m_checkpointPath.c_str());
+    std::string line;
+    while (std::getline(previous, line))
+    {
+        if (!line.empty())
+            m_finished.insert(line);
+    }
+    previous.close();
+
+    m_checkpoint.open(m_checkpointPath.c_str(), std::ios::out | std::ios::app);
+    if (!m_checkpoint.is_open())
+        throw std::runtime_error("Could not open the checkpoint file " + m_checkpointPath);
+}
+
+bool BatchScanner::scanDirectory(const std::string &p_directory, std::size_t p_jobs, bool p_ordered)
+{
+    m_abort = false;
+    m_nextReport = 0;
+    m_pendingReports.clear();
+    m_errors.clear();
+    m_scanned = 0;
+    m_skipped = 0;
+    openCheckpoint();
+
+    boost::system::error_code error;
+    boost::filesystem::recursive_directory_iterator iter(p_directory, error);
+    boost::filesystem::recursive_directory_iterator end;
+    if (error)
+        recordError(p_directory, "could not read the directory: " + error.message());
+
+    if (p_jobs == 0)
+        p_jobs = std::thread::hardware_concurrency();
+
+    // with a single job everything runs on the calling thread, in order
+    std::unique_ptr<ThreadPool> pool;
+    if (p_jobs > 1)
+        pool.reset(new ThreadPool(p_jobs));
+    else
+        p_ordered = true;
+
+    std::size_t index = 0;
+    boost::system::error_code walkError;
+    for (; iter != end && !m_abort && !walkError; iter.increment(walkError))
+    {
+        const std::string fileName(iter->path().string());
+
+        // failing to descend into a directory ends the walk, so look before
+        // leaping and step over the ones that can't be read
+        if (boost::filesystem::is_directory(iter->symlink_status(error)))
+        {
+            boost::filesystem::directory_iterator probe(iter->path(), error);
+            if (error)
+            {
+                recordError(fileName, "could not read the directory: " + error.message());
+                iter.no_push();
+            }
+            continue;
+        }
+
+        if (!boost::filesystem::is_regular_file(iter->status(error)))
+            continue;
+
+        if (m_finished.find(fileName) != m_finished.end())
+        {
+            ++m_skipped;
+            continue;
+        }
+
+        if (pool)
+        {
+            // a slow file holds back every report behind it. don't let the
+            // walk run away from the reports
+            {
+                std::unique_lock<std::mutex> guard(m_outputLock);
+                while (index - m_nextReport >= p_jobs * k_inFlightPerJob)
+                    m_reportWritten.wait(guard);
+            }
+            pool->submit(boost::bind(&BatchScanner::scanJob, this, index++,
+                                     fileName, p_ordered));
+        }
+        else
+            scanJob(index++, fileName, p_ordered);
+    }
+
+    // the walk can't go on past an error. whatever was left is not scanned
+    if (walkError)
+        recordError(p_directory, "could not read the directory: " + walkError.message());
+
+    if (pool)
+        pool->wait();
+
+    m_checkpoint.close();
+    return m_errors.empty();
+}
+
+void BatchScanner::scanJob(std::size_t p_index, const std::string &p_fileName, bool p_ordered)
+{
+    // an earlier file failed in fail fast mode, the scan is being abandoned
+    if (m_abort)
+    {
+        writeReport(p_index, std::string(), std::string(), p_ordered);
+        return;
+    }
+
+    // the reports of a directory scan can come out in any order. each one
+    // starts with the file it belongs to
+    std::stringstream report;
+    report << "File : " << p_fileName << std::endl;
+    try
+    {
+        scanFile(p_fileName, report);
+    }
+    catch (const std::exception &e)
+    {
+        recordError(p_fileName, e.what());
+
+        // a file that failed stays out of the checkpoint so the next run
+        // tries it again
+        writeReport(p_index, std::string(), std::string(), p_ordered);
+        return;
+    }
+
+    ++m_scanned;
+    writeReport(p_index, p_fileName, report.str(), p_ordered);
+}
+
+void BatchScanner::recordError(const std::string &p_fileName, const std::string &p_error)
+{
+    if (m_failFast)
+        m_abort = true;
+
+    std::lock_guard<std::mutex> guard(m_outputLock);
+    std::cerr << "Error in parsing " << p_fileName << ": " << p_error << std::endl;
+    m_errors.push_back(ScanError(p_fileName, p_error));
+}
+
+void BatchScanner::writeReport(std::size_t p_index, const std::string &p_fileName,
+                               const std::string &p_report, bool p_ordered)
+{
+    std::lock_guard<std::mutex> guard(m_outputLock);
+    if (!p_ordered)
+    {
+        std::cout << p_report << std::flush;
+        markFinished(p_fileName);
+        ++m_nextReport;
+        m_reportWritten.notify_all();
+        return;
+    }
+
+    if (p_index != m_nextReport)
+    {
+        m_pendingReports[p_index] = std::make_pair(p_fileName, p_report);
+        return;
+    }
+
+    std::cout << p_report << std::flush;
+    markFinished(p_fileName);
+    ++m_nextReport;
+
+    // flush everything that was waiting on this report
+    std::map<std::size_t, std::pair<std::string, std::string> >::iterator next = m_pendingReports.begin();
+    while (next != m_pendingReports.end() && next->first == m_nextReport)
+    {
+        std::cout << next->second.second << std::flush;
+        markFinished(next->second.first);
+        m_pendingReports.erase(next++);
+        ++m_nextReport;
+    }
+    m_reportWritten.notify_all();
+}
+
+void BatchScanner::markFinished(const std::string &p_fileName)
+{
+    // the report is out. only now is it safe to tell the next run to skip it
+    if (p_fileName.empty() || !m_checkpoint.is_open())
+        return;
+
+    m_checkpoint << p_fileName << std::endl;
+}
+
+void BatchScanner::printSummary(std::ostream &p_output) const
+{
+    p_output << std::dec << "Scan Summary : " << std::endl <<
+    " - Scanned: " << m_scanned << std::endl <<
+    " - Skipped: " << m_skipped << std::endl <<
+    " - Failed: " << m_errors.size() << std::endl;
+
+    for (std::vector<ScanError>::const_iterator it = m_errors.begin(); it != m_errors.end(); ++it)
+    {
+        p_output << "   " << it->m_file << ": " << it->m_error << std::endl;
+    }
+}
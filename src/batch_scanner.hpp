@@ -0,0 +1,216 @@
+#ifndef BATCH_SCANNER_HPP
+#define BATCH_SCANNER_HPP
+
+#include <set>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <ostream>
+#include <fstream>
+#include <boost/cstdint.hpp>
+
+/*
+ * Drives the parser from the command line. Takes care of a single file or of
+ * a whole directory tree. Directory scans can be spread over a pool of
+ * worker threads where every file gets its own ELFParser on the thread that
+ * parses it, so no parser state is ever shared between threads.
+ *
+ * A directory scan keeps going when a file fails to parse (unless fail fast
+ * is requested). Every failure is recorded and listed in a summary once the
+ * scan is over. A directory that can't be read is recorded the same way and
+ * stepped over. With a checkpoint file, each finished file is appended to it
+ * so an interrupted scan can be restarted without redoing the finished files.
+ * Files that failed are left out of it and get retried.
+ */
+class BatchScanner
+{
+public:
+
+    // the files a directory scan has queued or parsed but not written, per job
+    static const std::size_t k_inFlightPerJob = 4;
+
+    // a file that couldn't be scanned and why
+    struct ScanError
+    {
+        ScanError(const std::string& p_file, const std::string& p_error) :
+            m_file(p_file),
+            m_error(p_error)
+        {
+        }
+
+        std::string m_file;
+        std::string m_error;
+    };
+
+    /*
+     * p_printReasons indicates if we should print the score reasons
+     * p_printCapabilities print extra knowledge about the binary
+     * p_printELF print the various data structures we parse
+     */
+    BatchScanner(bool p_printReasons, bool p_printCapabilities, bool p_printELF);
+
+    // nothing of note
+    ~BatchScanner();
+
+    /*
+     * stop the directory scan at the first file that fails to parse instead
+     * of recording the error and moving on
+     */
+    void setFailFast(bool p_failFast);
+
+    /*
+     * the digests to compute and print for every file
+     * p_digests a mask of ELFParser::Digest
+     */
+    void setDigests(unsigned int p_digests);
+
+    /*
+     * print the section / segment entropy of every file
+     * p_print print the entropy profile
+     * p_window the number of bytes in a sliding window
+     * p_stride the number of bytes between the start of two windows
+     */
+    void setEntropy(bool p_print, std::size_t p_window, std::size_t p_stride);
+
+    /*
+     * carve the embedded ELF binaries out of every file and report them too
+     * p_carve carve or not
+     * p_maxDepth how deep binaries can be nested and still get carved
+     * p_maxBytes the number of bytes carved from a single file at most
+     */
+    void setCarve(bool p_carve, std::size_t p_maxDepth, boost::uint64_t p_maxBytes);
+
+    /*
+     * print the C++ symbol names demangled or as they are in the file
+     * p_demangle demangle or not. on by default
+     */
+    void setDemangle(bool p_demangle);
+
+    /*
+     * the file that records the finished files. the files listed in it when
+     * the scan starts are skipped
+     * p_checkpoint path to the checkpoint file. empty disables checkpointing
+     */
+    void setCheckpoint(const std::string& p_checkpoint);
+
+    /*
+     * parses and evaluates a single file and writes the report to p_output.
+     * p_fileName the file to parse
+     * p_output where the report goes
+     * throws std::exception if the file can't be parsed
+     */
+    void scanFile(const std::string& p_fileName, std::ostream& p_output) const;
+
+    /*
+     * walks p_directory recursively and scans every regular file in it. each
+     * report starts with a "File : " line naming the file it's for.
+     * p_directory the directory to look through
+     * p_jobs the number of worker threads. 1 scans on the calling thread and
+     *        0 starts one worker per core
+     * p_ordered write the reports in directory order instead of the order
+     *           the workers finish them. the walk waits while
+     *           k_inFlightPerJob * p_jobs files are waiting to be written
+     * return false if a file failed to parse
+     */
+    bool scanDirectory(const std::string& p_directory, std::size_t p_jobs, bool p_ordered);
+
+    // return the files that failed during the last directory scan
+    const std::vector<ScanError>& getErrors() const;
+
+    // writes the scanned / skipped / failed counts and the failures to p_output
+    void printSummary(std::ostream& p_output) const;
+
+private:
+
+    // disable evil things
+    BatchScanner(const BatchScanner& p_rhs);
+    BatchScanner& operator=(const BatchScanner& p_rhs);
+
+    // reads the finished files out of the checkpoint and opens it for appending
+    void openCheckpoint();
+
+    // runs on a worker: scans the file and hands the report to the writer
+    void scanJob(std::size_t p_index, const std::string& p_fileName, bool p_ordered);
+
+    // records a file or directory that couldn't be scanned and reports it on stderr
+    void recordError(const std::string& p_fileName, const std::string& p_error);
+
+    // writes out the report for the p_index'th file
+    void writeReport(std::size_t p_index, const std::string& p_fileName,
+                     const std::string& p_report, bool p_ordered);
+
+    // the file's report hit the output. record it in the checkpoint
+    void markFinished(const std::string& p_fileName);
+
+private:
+
+    // print the scoring reasons
+    bool m_printReasons;
+
+    // print the capabilities
+    bool m_printCapabilities;
+
+    // print the parsed structures
+    bool m_printELF;
+
+    // abort the scan on the first error
+    bool m_failFast;
+
+    // the digests to print (a mask of ELFParser::Digest)
+    unsigned int m_digests;
+
+    // print the entropy profile
+    bool m_printEntropy;
+
+    // the sliding window of the entropy profile
+    std::size_t m_entropyWindow;
+    std::size_t m_entropyStride;
+
+    // carve the embedded binaries, and the limits to do it with
+    bool m_carve;
+    std::size_t m_carveDepth;
+    boost::uint64_t m_carveBytes;
+
+    // print the symbol names demangled
+    bool m_demangle;
+
+    // path to the checkpoint file
+    std::string m_checkpointPath;
+
+    // the checkpoint file, opened for appending
+    std::ofstream m_checkpoint;
+
+    // the files the checkpoint says are done
+    std::set<std::string> m_finished;
+
+    // serializes writes to stdout / stderr / the checkpoint
+    std::mutex m_outputLock;
+
+    // signaled whenever a report has been written
+    std::condition_variable m_reportWritten;
+
+    // reports (and their file names) that finished ahead of their turn
+    std::map<std::size_t, std::pair<std::string, std::string> > m_pendingReports;
+
+    // the number of reports written. in ordered mode also the index of the
+    // next report to write
+    std::size_t m_nextReport;
+
+    // the files that failed to parse and the directories that couldn't be read
+    std::vector<ScanError> m_errors;
+
+    // the number of files scanned successfully
+    std::atomic<std::size_t> m_scanned;
+
+    // the number of files skipped thanks to the checkpoint
+    std::size_t m_skipped;
+
+    // set once a file fails to parse in fail fast mode. stops the remaining jobs
+    std::atomic<bool> m_abort;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "byte_histogram.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // flush well before a 32 bit sub-histogram entry can overflow
+    const boost::uint64_t k_flushLimit = 0x80000000ULL;
+
+    // counts the 8 bytes of p_word, two per sub-histogram
+    inline void countWord(boost::uint32_t p_sub[4][256], boost::uint64_t p_word)
+    {
+        ++p_sub[0][p_word & 0xff];
+        ++p_sub[1][(p_word >> 8) & 0xff];
+        ++p_sub[2][(p_word >> 16) & 0xff];
+        ++p_sub[3][(p_word >> 24) & 0xff];
+        ++p_sub[0][(p_word >> 32) & 0xff];
+        ++p_sub[1][(p_word >> 40) & 0xff];
+        ++p_sub[2][(p_word >> 48) & 0xff];
+        ++p_sub[3][p_word >> 56];
+    }
+
+    // counts 32 bytes
+    inline void countBlock(boost::uint32_t p_sub[4][256], const unsigned char* p_data)
+    {
+        boost::uint64_t words[4];
+        std::memcpy(words, p_data, sizeof(words));
+        countWord(p_sub, words[0]);
+        countWord(p_sub, words[1]);
+        countWord(p_sub, words[2]);
+        countWord(p_sub, words[3]);
+    }
+
+    void countBytes(boost::uint32_t p_sub[4][256], const unsigned char* p_data,
+                    std::size_t p_length)
+    {
+        std::size_t i = 0;
+        for ( ; i + 32 <= p_length; i += 32)
+        {
+#if defined(__AVX2__)
+            // a run of one value (ie, padding) is counted with a single add
+            const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_data + i));
+            const __m256i first = _mm256_set1_epi8(static_cast<char>(p_data[i]));
+            if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, first)) == -1)
+            {
+                p_sub[0][p_data[i]] += 32;
+                continue;
+            }
+#endif
+            countBlock(p_sub, p_data + i);
+        }
+
+        for ( ; i < p_length; ++i)
+        {
+            ++p_sub[i & 3][p_data[i]];
+        }
+    }
+}
+
+ByteHistogram::ByteHistogram() :
+    m_pending(0),
+    m_total(0)
+{
+    std::memset(m_sub, 0, sizeof(m_sub));
+    std::memset(m_counts, 0, sizeof(m_counts));
+}
+
+void ByteHistogram::add(const unsigned char* p_data, std::size_t p_length)
+{
+    m_total += p_length;
+    while (p_length != 0)
+    {
+        const std::size_t length = static_cast<std::size_t>(
+            std::min<boost::uint64_t>(p_length, k_flushLimit - m_pending));
+        countBytes(m_sub, p_data, length);
+        p_data += length;
+        p_length -= length;
+
+        m_pending += length;
+        if (m_pending == k_flushLimit)
+        {
+            flush();
+        }
+    }
+}
+
+void ByteHistogram::flush()
+{
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        m_counts[i] += static_cast<boost::uint64_t>(m_sub[0][i]) + m_sub[1][i] +
+                       m_sub[2][i] + m_sub[3][i];
+    }
+    std::memset(m_sub, 0, sizeof(m_sub));
+    m_pending = 0;
+}
+
+void ByteHistogram::getCounts(boost::uint64_t p_counts[256]) const
+{
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        p_counts[i] = m_counts[i] + m_sub[0][i] + m_sub[1][i] + m_sub[2][i] + m_sub[3][i];
+    }
+}
+
+boost::uint64_t ByteHistogram::getTotal() const
+{
+    return m_total;
+}
@@ -0,0 +1,52 @@
+#ifndef BYTE_HISTOGRAM_HPP
+#define BYTE_HISTOGRAM_HPP
+
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+/*
+ * Counts how often each byte value shows up. Incrementing a single 256 entry
+ * array stalls whenever the same byte repeats (ie, zero padding): every
+ * increment has to wait for the previous store to the same counter. The
+ * bytes are instead spread over four interleaved 32 bit sub-histograms that
+ * are only added up when the counts are read (or before they can overflow).
+ *
+ * When built for AVX2 (-march=native in release builds) a 32 byte run of a
+ * single value is recognized with one compare and counted in one go.
+ */
+class ByteHistogram
+{
+public:
+
+    ByteHistogram();
+
+    // counts the bytes of p_data
+    void add(const unsigned char* p_data, std::size_t p_length);
+
+    // writes the count of every byte value to p_counts
+    void getCounts(boost::uint64_t p_counts[256]) const;
+
+    // return the number of bytes counted
+    boost::uint64_t getTotal() const;
+
+private:
+
+    // moves the sub-histograms into m_counts
+    void flush();
+
+private:
+
+    // the interleaved sub-histograms
+    boost::uint32_t m_sub[4][256];
+
+    // the counts flushed out of the sub-histograms
+    boost::uint64_t m_counts[256];
+
+    // the number of bytes in the sub-histograms
+    boost::uint64_t m_pending;
+
+    // the number of bytes counted
+    boost::uint64_t m_total;
+};
+
+#endif
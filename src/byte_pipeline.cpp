@@ -0,0 +1,102 @@
+#include "byte_pipeline.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <boost/foreach.hpp>
+
+const std::size_t BytePipeline::k_blockSize;
+
+BytePipeline::BytePipeline() :
+    m_consumers()
+{
+}
+
+BytePipeline::~BytePipeline()
+{
+}
+
+void BytePipeline::addConsumer(ByteConsumer& p_consumer)
+{
+    m_consumers.push_back(&p_consumer);
+}
+
+void BytePipeline::run(const char* p_data, std::size_t p_length)
+{
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(p_data);
+    for (std::size_t offset = 0; offset < p_length; offset += k_blockSize)
+    {
+        const std::size_t length = std::min(k_blockSize, p_length - offset);
+        BOOST_FOREACH (ByteConsumer* consumer, m_consumers)
+        {
+            consumer->consume(data + offset, length, offset);
+        }
+    }
+
+    BOOST_FOREACH (ByteConsumer* consumer, m_consumers)
+    {
+        consumer->finish();
+    }
+}
+
+HistogramConsumer::HistogramConsumer() :
+    m_histogram()
+{
+    std::memset(m_counts, 0, sizeof(m_counts));
+}
+
+void HistogramConsumer::consume(const unsigned char* p_block, std::size_t p_length, std::size_t)
+{
+    m_histogram.add(p_block, p_length);
+}
+
+void HistogramConsumer::finish()
+{
+    m_histogram.getCounts(m_counts);
+}
+
+const boost::uint64_t* HistogramConsumer::getCounts() const
+{
+    return m_counts;
+}
+
+boost::uint64_t HistogramConsumer::getTotal() const
+{
+    return m_histogram.getTotal();
+}
+
+double HistogramConsumer::getEntropy() const
+{
+    return calcEntropy(m_counts, m_histogram.getTotal());
+}
+
+double HistogramConsumer::calcEntropy(const boost::uint64_t* p_counts, boost::uint64_t p_total)
+{
+    if (p_total == 0)
+    {
+        return 0.;
+    }
+
+    double entropy = 0.;
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        if (p_counts[i] != 0)
+        {
+            const double probability = static_cast<double>(p_counts[i]) / p_total;
+            entropy -= probability * std::log2(probability);
+        }
+    }
+    return entropy;
+}
+
+SearchConsumer::SearchConsumer(const SearchTree& p_tree, std::vector<SearchMatch>& p_matches) :
+    m_tree(p_tree),
+    m_state(),
+    m_matches(p_matches)
+{
+}
+
+void SearchConsumer::consume(const unsigned char* p_block, std::size_t p_length, std::size_t)
+{
+    m_tree.search(m_state, p_block, p_length, m_matches);
+}
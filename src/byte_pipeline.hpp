@@ -0,0 +1,152 @@
+#ifndef BYTE_PIPELINE_HPP
+#define BYTE_PIPELINE_HPP
+
+#include "byte_histogram.hpp"
+#include "datastructures/search_tree.hpp"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+/*
+ * Something that wants to see every byte of the file. Consumers are fed the
+ * file in order, one block at a time.
+ */
+class ByteConsumer
+{
+public:
+
+    virtual ~ByteConsumer()
+    {
+    }
+
+    /*
+     * p_block the next bytes of the file
+     * p_length the number of bytes in the block
+     * p_offset the file offset of the block's first byte
+     */
+    virtual void consume(const unsigned char* p_block, std::size_t p_length,
+                         std::size_t p_offset) = 0;
+
+    // called once the last block has been consumed
+    virtual void finish()
+    {
+    }
+};
+
+/*
+ * Reads a buffer once, in blocks small enough to stay in the L1/L2 cache, and
+ * hands each block to every consumer before moving on. Hashing, counting and
+ * searching the file then cost one trip through memory instead of one each.
+ */
+class BytePipeline
+{
+public:
+
+    // the size of the blocks handed to the consumers
+    static const std::size_t k_blockSize = 32 * 1024;
+
+    BytePipeline();
+    ~BytePipeline();
+
+    // adds a consumer. it must stay alive until run() returns
+    void addConsumer(ByteConsumer& p_consumer);
+
+    // feeds p_data to every consumer and finishes them
+    void run(const char* p_data, std::size_t p_length);
+
+private:
+
+    // disable evil things
+    BytePipeline(const BytePipeline& p_rhs);
+    BytePipeline& operator=(const BytePipeline& p_rhs);
+
+private:
+
+    // the consumers, in the order they were added
+    std::vector<ByteConsumer*> m_consumers;
+};
+
+// feeds the bytes to one of the hash-lib hashes (MD5, SHA1, SHA256)
+template <typename Hash>
+class HashConsumer : public ByteConsumer
+{
+public:
+
+    HashConsumer() :
+        m_hash(),
+        m_digest()
+    {
+    }
+
+    virtual void consume(const unsigned char* p_block, std::size_t p_length, std::size_t)
+    {
+        m_hash.add(p_block, p_length);
+    }
+
+    virtual void finish()
+    {
+        m_digest = m_hash.getHash();
+    }
+
+    // return the hex digest. empty until the pipeline has run
+    const std::string& getDigest() const
+    {
+        return m_digest;
+    }
+
+private:
+
+    Hash m_hash;
+    std::string m_digest;
+};
+
+// counts how often each byte value shows up
+class HistogramConsumer : public ByteConsumer
+{
+public:
+
+    HistogramConsumer();
+
+    virtual void consume(const unsigned char* p_block, std::size_t p_length, std::size_t p_offset);
+
+    virtual void finish();
+
+    // return the count of every byte value. valid once the pipeline has run
+    const boost::uint64_t* getCounts() const;
+
+    // return the number of bytes counted
+    boost::uint64_t getTotal() const;
+
+    // return the shannon entropy (bits per byte) of the counted bytes
+    double getEntropy() const;
+
+    // return the shannon entropy (bits per byte) of p_total bytes counted in p_counts
+    static double calcEntropy(const boost::uint64_t* p_counts, boost::uint64_t p_total);
+
+private:
+
+    ByteHistogram m_histogram;
+
+    // the counts of m_histogram, added up by finish()
+    boost::uint64_t m_counts[256];
+};
+
+// runs a compiled SearchTree over the bytes and collects the matches
+class SearchConsumer : public ByteConsumer
+{
+public:
+
+    SearchConsumer(const SearchTree& p_tree, std::vector<SearchMatch>& p_matches);
+
+    virtual void consume(const unsigned char* p_block, std::size_t p_length, std::size_t p_offset);
+
+private:
+
+    const SearchTree& m_tree;
+    SearchTree::ScanState m_state;
+    std::vector<SearchMatch>& m_matches;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "capability_table.hpp"
+
+#include <cstring>
+
+CapabilityTable::CapabilityTable(const CapabilityEntry* p_entries, std::size_t p_count) :
+    m_slots(),
+    m_mask(0)
+{
+    std::size_t size = 16;
+    while (size < p_count * 2)
+    {
+        size *= 2;
+    }
+    const Slot empty = { 0, 0, NULL };
+    m_slots.assign(size, empty);
+    m_mask = size - 1;
+
+    for (std::size_t i = 0; i < p_count; ++i)
+    {
+        const boost::string_view name(p_entries[i].m_name);
+        if (find(name) != NULL)
+        {
+            continue;
+        }
+
+        const boost::uint32_t nameHash = hash(name);
+        std::size_t index = nameHash & m_mask;
+        while (m_slots[index].m_entry != NULL)
+        {
+            index = (index + 1) & m_mask;
+        }
+
+        Slot& slot = m_slots[index];
+        slot.m_hash = nameHash;
+        slot.m_length = static_cast<boost::uint32_t>(name.size());
+        slot.m_entry = &p_entries[i];
+    }
+}
+
+CapabilityTable::~CapabilityTable()
+{
+}
+
+const CapabilityEntry* CapabilityTable::find(boost::string_view p_name) const
+{
+    const boost::uint32_t nameHash = hash(p_name);
+    for (std::size_t index = nameHash & m_mask; m_slots[index].m_entry != NULL; index = (index + 1) & m_mask)
+    {
+        const Slot& slot = m_slots[index];
+        if (slot.m_hash == nameHash && slot.m_length == p_name.size() &&
+            std::memcmp(slot.m_entry->m_name, p_name.data(), p_name.size()) == 0)
+        {
+            return slot.m_entry;
+        }
+    }
+    return NULL;
+}
+
+boost::uint32_t CapabilityTable::hash(boost::string_view p_name)
+{
+    boost::uint32_t result = 2166136261u;
+    for (std::size_t i = 0; i < p_name.size(); ++i)
+    {
+        result ^= static_cast<boost::uint8_t>(p_name[i]);
+        result *= 16777619u;
+    }
+    return result;
+}
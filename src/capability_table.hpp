@@ -0,0 +1,66 @@
+#ifndef CAPABILITY_TABLE_HPP
+#define CAPABILITY_TABLE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
+
+#include "structures/capabilities.hpp"
+
+// a name (function, source file) that marks a capability
+struct CapabilityEntry
+{
+    const char* m_name;
+    elf::Capabilties m_capability;
+    const char* m_reason;
+};
+
+/*
+ * Looks names up in a static list of CapabilityEntry. The entries are put in
+ * an open addressed (FNV-1a, linear probing) table that is at most half full
+ * when the table is built, so a lookup is one hash and usually a single
+ * compare. Nothing is allocated by find(), so the names can be looked up
+ * straight out of the mapped string table.
+ */
+class CapabilityTable
+{
+public:
+
+    /*
+     * p_entries the entries. they must outlive the table. if a name is
+     * listed twice the first entry wins
+     * p_count the number of entries
+     */
+    CapabilityTable(const CapabilityEntry* p_entries, std::size_t p_count);
+    ~CapabilityTable();
+
+    // return the entry for p_name. NULL if there is none
+    const CapabilityEntry* find(boost::string_view p_name) const;
+
+    // return the 32 bit FNV-1a hash of p_name
+    static boost::uint32_t hash(boost::string_view p_name);
+
+private:
+
+    // disable evil things
+    CapabilityTable(const CapabilityTable& p_rhs);
+    CapabilityTable& operator=(const CapabilityTable& p_rhs);
+
+private:
+
+    struct Slot
+    {
+        boost::uint32_t m_hash;
+        boost::uint32_t m_length;
+        const CapabilityEntry* m_entry;
+    };
+
+    // a power of two number of slots. empty slots have no entry
+    std::vector<Slot> m_slots;
+
+    // the number of slots - 1
+    std::size_t m_mask;
+};
+
+#endif
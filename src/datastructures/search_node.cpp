@@ -23,17 +23,17 @@ void SearchNode::setNext(const unsigned char p_value, SearchNode* p_node)
     m_next[p_value] = p_node;
 }
 
-const std::set<void*>& SearchNode::getStoredData() const
+const std::set<boost::uint32_t>& SearchNode::getStoredData() const
 {
     return m_storedData;
 }
 
-void SearchNode::addReturnValues(const std::set<void*>& p_dataSet)
+void SearchNode::addReturnValues(const std::set<boost::uint32_t>& p_dataSet)
 {
     m_storedData.insert(p_dataSet.begin(), p_dataSet.end());
 }
 
-void SearchNode::addReturnValue(void* p_data)
+void SearchNode::addReturnValue(boost::uint32_t p_data)
 {
     m_storedData.insert(p_data);
 }
@@ -1,7 +1,8 @@
 #ifndef ELFPARSER_SEARCHNODE_HPP
 #define ELFPARSER_SEARCHNODE_HPP
 
-#include <set>
+#include <set>
+#include <boost/cstdint.hpp>
 
 class SearchNode
 {
@@ -10,7 +11,7 @@ class SearchNode
         SearchNode(const SearchNode& p_rhs);
         SearchNode& operator=(const SearchNode& p_rhs);
 
-        std::set<void*> m_storedData;
+        std::set<boost::uint32_t> m_storedData;
         SearchNode* m_next[256];
         SearchNode* m_failureNode;
 
@@ -25,9 +26,9 @@ class SearchNode
 
         void setNext(const unsigned char p_value, SearchNode* p_node);
 
-        const std::set<void*>& getStoredData() const;
-        void addReturnValues(const std::set<void*>& p_dataSet);
-        void addReturnValue(void* p_data);
+        const std::set<boost::uint32_t>& getStoredData() const;
+        void addReturnValues(const std::set<boost::uint32_t>& p_dataSet);
+        void addReturnValue(boost::uint32_t p_data);
 
         SearchNode* getFailure() const;
         void setFailure(SearchNode* const p_node);
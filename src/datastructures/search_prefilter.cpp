@@ -0,0 +1,158 @@
+#include "search_prefilter.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace
+{
+    // with this many first bytes most positions are candidates anyway
+    const std::size_t k_maxUsefulBytes = 128;
+}
+
+SearchPrefilter::SearchPrefilter() :
+    m_byteCount(0),
+    m_enabled(false)
+{
+    std::memset(m_table, 0, sizeof(m_table));
+    std::memset(m_bytes, 0, sizeof(m_bytes));
+}
+
+SearchPrefilter::~SearchPrefilter()
+{
+}
+
+void SearchPrefilter::build(const bool p_firstBytes[256])
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        m_table[i] = p_firstBytes[i];
+        if (m_table[i])
+        {
+            if (count < k_maxVectorBytes)
+            {
+                m_bytes[count] = static_cast<boost::uint8_t>(i);
+            }
+            ++count;
+        }
+    }
+
+    m_byteCount = count <= k_maxVectorBytes ? count : 0;
+    m_enabled = count != 0 && count <= k_maxUsefulBytes;
+}
+
+std::size_t SearchPrefilter::findScalar(const unsigned char* p_input, std::size_t p_start,
+                                        std::size_t p_length) const
+{
+    for ( ; p_start < p_length; ++p_start)
+    {
+        if (m_table[p_input[p_start]])
+        {
+            return p_start;
+        }
+    }
+    return p_length;
+}
+
+#if defined(__AVX2__)
+
+std::size_t SearchPrefilter::find(const unsigned char* p_input, std::size_t p_start,
+                                  std::size_t p_length) const
+{
+    if (m_byteCount == 0)
+    {
+        return findScalar(p_input, p_start, p_length);
+    }
+
+    __m256i needles[k_maxVectorBytes];
+    for (std::size_t i = 0; i < m_byteCount; ++i)
+    {
+        needles[i] = _mm256_set1_epi8(static_cast<char>(m_bytes[i]));
+    }
+
+    for ( ; p_start + 32 <= p_length; p_start += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p_input + p_start));
+        __m256i hits = _mm256_cmpeq_epi8(block, needles[0]);
+        for (std::size_t i = 1; i < m_byteCount; ++i)
+        {
+            hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, needles[i]));
+        }
+
+        const boost::uint32_t mask = static_cast<boost::uint32_t>(_mm256_movemask_epi8(hits));
+        if (mask != 0)
+        {
+#ifdef _MSC_VER
+            unsigned long bit = 0;
+            _BitScanForward(&bit, mask);
+            return p_start + bit;
+#else
+            return p_start + __builtin_ctz(mask);
+#endif
+        }
+    }
+    return findScalar(p_input, p_start, p_length);
+}
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+std::size_t SearchPrefilter::find(const unsigned char* p_input, std::size_t p_start,
+                                  std::size_t p_length) const
+{
+    if (m_byteCount == 0)
+    {
+        return findScalar(p_input, p_start, p_length);
+    }
+
+    __m128i needles[k_maxVectorBytes];
+    for (std::size_t i = 0; i < m_byteCount; ++i)
+    {
+        needles[i] = _mm_set1_epi8(static_cast<char>(m_bytes[i]));
+    }
+
+    for ( ; p_start + 16 <= p_length; p_start += 16)
+    {
+        const __m128i block = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p_input + p_start));
+        __m128i hits = _mm_cmpeq_epi8(block, needles[0]);
+        for (std::size_t i = 1; i < m_byteCount; ++i)
+        {
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[i]));
+        }
+
+        const int mask = _mm_movemask_epi8(hits);
+        if (mask != 0)
+        {
+#ifdef _MSC_VER
+            unsigned long bit = 0;
+            _BitScanForward(&bit, mask);
+            return p_start + bit;
+#else
+            return p_start + __builtin_ctz(mask);
+#endif
+        }
+    }
+    return findScalar(p_input, p_start, p_length);
+}
+
+#else
+
+std::size_t SearchPrefilter::find(const unsigned char* p_input, std::size_t p_start,
+                                  std::size_t p_length) const
+{
+    return findScalar(p_input, p_start, p_length);
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef ELFPARSER_SEARCH_PREFILTER_HPP
+#define ELFPARSER_SEARCH_PREFILTER_HPP
+
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+/*
+ * Skips over bytes that can't start a match. While the automaton sits in
+ * its root state only a byte that begins one of the words moves it, so
+ * everything up to the next such byte can be jumped over without walking
+ * the transition table.
+ *
+ * With a handful of distinct first bytes the input is compared against each
+ * of them 32 (AVX2) or 16 (SSE2) bytes at a time. Anything else uses a
+ * lookup table one byte at a time. The vector width is picked at compile
+ * time from the target flags (-march=native in release builds).
+ */
+class SearchPrefilter
+{
+public:
+
+    SearchPrefilter();
+    ~SearchPrefilter();
+
+    /*
+     * p_firstBytes a 256 entry table. non-zero for the bytes that start a word
+     */
+    void build(const bool p_firstBytes[256]);
+
+    // return false if the prefilter can't skip anything (ie, any byte can start a word)
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /*
+     * return the index of the first byte in [p_start, p_length) that can start
+     * a word or p_length if there is none
+     */
+    std::size_t find(const unsigned char* p_input, std::size_t p_start,
+                     std::size_t p_length) const;
+
+private:
+
+    std::size_t findScalar(const unsigned char* p_input, std::size_t p_start,
+                           std::size_t p_length) const;
+
+private:
+
+    // the most first bytes we compare against with vectors
+    static const std::size_t k_maxVectorBytes = 16;
+
+    // non-zero for every byte that starts a word
+    bool m_table[256];
+
+    // the distinct first bytes (only when there are few enough)
+    boost::uint8_t m_bytes[k_maxVectorBytes];
+
+    // the number of entries in m_bytes. 0 means use the table
+    std::size_t m_byteCount;
+
+    // indicates if there is any point in prefiltering
+    bool m_enabled;
+};
+
+#endif
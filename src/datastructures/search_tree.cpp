@@ -1,11 +1,23 @@
 #include "search_tree.hpp"
-#include <boost/concept_check.hpp>
+
+#include <map>
+#include <cassert>
+#include <cstring>
+#include <stdexcept>
 
 SearchTree::SearchTree() :
     m_rootNode(),
     m_ready(false),
-    m_nodeVector()
+    m_nodeVector(),
+    m_patterns(),
+    m_stride(0),
+    m_transitions(),
+    m_firstAccepting(0),
+    m_outputIndex(),
+    m_outputs(),
+    m_prefilter()
 {
+    std::memset(m_classes, 0, sizeof(m_classes));
 }
 
 SearchTree::~SearchTree()
@@ -28,41 +40,156 @@ void SearchTree::addWord(const unsigned char* p_input,
                          unsigned char p_length, void* p_storeData)
 {
     assert(!m_ready);
-    doAddWord(&m_rootNode, p_input, p_length, p_storeData);
+    if (p_length == 0)
+    {
+        return;
+    }
+
+    Pattern pattern = { p_storeData, p_length };
+    m_patterns.push_back(pattern);
+    doAddWord(&m_rootNode, p_input, p_length, m_patterns.size() - 1);
+}
+
+std::size_t SearchTree::getStateCount() const
+{
+    return m_stride == 0 ? 0 : m_transitions.size() / m_stride;
+}
+
+std::size_t SearchTree::getClassCount() const
+{
+    return m_stride;
+}
+
+const boost::uint32_t* SearchTree::outputBegin(boost::uint32_t p_state) const
+{
+    return &m_outputs[0] + m_outputIndex[(p_state - m_firstAccepting) / m_stride];
+}
+
+const boost::uint32_t* SearchTree::outputEnd(boost::uint32_t p_state) const
+{
+    return &m_outputs[0] + m_outputIndex[(p_state - m_firstAccepting) / m_stride + 1];
+}
+
+void* SearchTree::getStoredData(boost::uint32_t p_pattern) const
+{
+    return m_patterns[p_pattern].m_storedData;
+}
+
+std::size_t SearchTree::getLength(boost::uint32_t p_pattern) const
+{
+    return m_patterns[p_pattern].m_length;
+}
+
+namespace
+{
+    // visitor that appends the hits to a vector
+    struct AppendMatches
+    {
+        AppendMatches(const SearchTree& p_tree, std::vector<SearchMatch>& p_matches) :
+            m_tree(p_tree),
+            m_matches(p_matches)
+        {
+        }
+
+        void operator()(boost::uint32_t p_pattern, std::size_t p_offset)
+        {
+            m_matches.push_back(SearchMatch(p_pattern, p_offset, m_tree.getLength(p_pattern)));
+        }
+
+        const SearchTree& m_tree;
+        std::vector<SearchMatch>& m_matches;
+    };
+
+    // visitor that records which patterns were seen
+    struct MarkPatterns
+    {
+        explicit MarkPatterns(std::vector<bool>& p_seen) :
+            m_seen(p_seen)
+        {
+        }
+
+        void operator()(boost::uint32_t p_pattern, std::size_t)
+        {
+            m_seen[p_pattern] = true;
+        }
+
+        std::vector<bool>& m_seen;
+    };
+
+    // visitor that records the start of every hit
+    struct CollectOffsets
+    {
+        CollectOffsets(const char* p_base, std::set<const char*>& p_offsets) :
+            m_base(p_base),
+            m_offsets(p_offsets)
+        {
+        }
+
+        void operator()(boost::uint32_t, std::size_t p_offset)
+        {
+            m_offsets.insert(m_base + p_offset);
+        }
+
+        const char* m_base;
+        std::set<const char*>& m_offsets;
+    };
+}
+
+void SearchTree::search(const char* const p_inputString, const std::size_t p_inputLength,
+                        std::vector<SearchMatch>& p_matches) const
+{
+    AppendMatches visitor(*this, p_matches);
+    scan(reinterpret_cast<const unsigned char*>(p_inputString), p_inputLength, visitor);
+}
+
+void SearchTree::search(ScanState& p_state, const unsigned char* const p_inputString,
+                        const std::size_t p_inputLength, std::vector<SearchMatch>& p_matches) const
+{
+    AppendMatches visitor(*this, p_matches);
+    scan(p_state, p_inputString, p_inputLength, visitor);
+}
+
+void SearchTree::removeDuplicates(std::vector<SearchMatch>& p_matches)
+{
+    std::set<boost::uint32_t> seen;
+    std::vector<SearchMatch>::iterator out = p_matches.begin();
+    for (std::vector<SearchMatch>::iterator it = p_matches.begin(); it != p_matches.end(); ++it)
+    {
+        if (seen.insert(it->m_pattern).second)
+        {
+            *out++ = *it;
+        }
+    }
+    p_matches.erase(out, p_matches.end());
 }
 
 std::set<void*> SearchTree::search(const char* const p_inputString,
-                                          const std::size_t p_inputLength)
+                                          const std::size_t p_inputLength) const
 {
     return search(reinterpret_cast<const unsigned char* const>(p_inputString),
                   p_inputLength);
 }
 
 std::set<void*> SearchTree::search(const unsigned char* const p_inputString,
-                                          const std::size_t p_inputLength)
+                                          const std::size_t p_inputLength) const
 {
-    assert(m_ready && p_inputString != NULL);
+    std::vector<bool> seen(m_patterns.size(), false);
+    MarkPatterns visitor(seen);
+    scan(p_inputString, p_inputLength, visitor);
 
     std::set<void*> returnValue;
-    SearchNode* currentNode = &m_rootNode;
-    const unsigned char* end = p_inputString + p_inputLength;
-    for (const unsigned char* start = p_inputString; start < end; ++start)
+    for (std::size_t i = 0; i < seen.size(); ++i)
     {
-        currentNode = currentNode->getNext(*start);
-        if (!currentNode->getStoredData().empty())
+        if (seen[i])
         {
-            const std::set<void*>& mergeThis(currentNode->getStoredData());
-            returnValue.insert(mergeThis.begin(), mergeThis.end());
+            returnValue.insert(m_patterns[i].m_storedData);
         }
     }
-
     return returnValue;
 }
 
-void SearchTree::compile()
+void SearchTree::linkFailures()
 {
-    assert(!m_ready);
-
     // at the top level assign root as the failure node
     std::queue<SearchNode*> nodesByLevel;
     for (std::size_t i = 0; i < m_rootNode.getNextSize(); ++i)
@@ -106,12 +233,121 @@ void SearchTree::compile()
         }
         nodesByLevel.pop();
     }
+}
+
+void SearchTree::buildClasses(const std::vector<const SearchNode*>& p_nodes,
+                              bool p_compressAlphabet)
+{
+    if (!p_compressAlphabet)
+    {
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            m_classes[i] = static_cast<boost::uint8_t>(i);
+        }
+        m_stride = 256;
+        return;
+    }
+
+    // two bytes share a class when they lead to the same node from every node
+    std::map<std::vector<const SearchNode*>, boost::uint8_t> columns;
+    std::vector<const SearchNode*> column(p_nodes.size());
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        for (std::size_t j = 0; j < p_nodes.size(); ++j)
+        {
+            column[j] = p_nodes[j]->getNext(static_cast<unsigned char>(i));
+        }
+
+        std::map<std::vector<const SearchNode*>, boost::uint8_t>::const_iterator found =
+            columns.find(column);
+        if (found == columns.end())
+        {
+            found = columns.insert(std::make_pair(column,
+                                   static_cast<boost::uint8_t>(columns.size()))).first;
+        }
+        m_classes[i] = found->second;
+    }
+    m_stride = columns.size();
+}
+
+void SearchTree::compile(bool p_compressAlphabet)
+{
+    assert(!m_ready);
+
+    linkFailures();
+
+    // number the nodes. root is state 0 and the accepting states go last
+    std::vector<const SearchNode*> nodes;
+    nodes.push_back(&m_rootNode);
+    for (std::size_t i = 0; i < m_nodeVector.size(); ++i)
+    {
+        if (m_nodeVector[i].getStoredData().empty())
+        {
+            nodes.push_back(&m_nodeVector[i]);
+        }
+    }
+    const std::size_t firstAccepting = nodes.size();
+    for (std::size_t i = 0; i < m_nodeVector.size(); ++i)
+    {
+        if (!m_nodeVector[i].getStoredData().empty())
+        {
+            nodes.push_back(&m_nodeVector[i]);
+        }
+    }
+
+    buildClasses(nodes, p_compressAlphabet);
+    if (static_cast<boost::uint64_t>(nodes.size()) * m_stride > 0xffffffffULL)
+    {
+        throw std::runtime_error("The search automaton has too many states");
+    }
 
+    std::map<const SearchNode*, boost::uint32_t> stateOf;
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        stateOf[nodes[i]] = static_cast<boost::uint32_t>(i * m_stride);
+    }
+
+    // fill in the rows. every byte of a class shares the same transition
+    m_transitions.assign(nodes.size() * m_stride, 0);
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        boost::uint32_t* row = &m_transitions[i * m_stride];
+        for (std::size_t j = 0; j < 256; ++j)
+        {
+            row[m_classes[j]] = stateOf[nodes[i]->getNext(static_cast<unsigned char>(j))];
+        }
+    }
+
+    m_firstAccepting = static_cast<boost::uint32_t>(firstAccepting * m_stride);
+    m_outputIndex.push_back(0);
+    for (std::size_t i = firstAccepting; i < nodes.size(); ++i)
+    {
+        const std::set<boost::uint32_t>& stored(nodes[i]->getStoredData());
+        m_outputs.insert(m_outputs.end(), stored.begin(), stored.end());
+        m_outputIndex.push_back(static_cast<boost::uint32_t>(m_outputs.size()));
+    }
+
+    // the bytes that move the automaton out of the root state
+    bool firstBytes[256];
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        firstBytes[i] = m_transitions[m_classes[i]] != 0;
+    }
+    m_prefilter.build(firstBytes);
+
+    // a tree without words never accepts
+    if (m_outputs.empty())
+    {
+        m_firstAccepting = static_cast<boost::uint32_t>(m_transitions.size());
+    }
+
+    // the trie isn't needed anymore
+    m_nodeVector.clear();
     m_ready = true;
 }
 
 void SearchTree::doAddWord(SearchNode* p_node, const unsigned char* p_input,
-                           unsigned char p_length, void* p_return)
+                           unsigned char p_length, boost::uint32_t p_return)
 {
     if (p_node->getNext(p_input[0]) == NULL)
     {
@@ -139,18 +375,10 @@ void SearchTree::doAddWord(SearchNode* p_node, const unsigned char* p_input,
 }
 
 std::set<const char*> SearchTree::findOffsets(const char* const p_inputString,
-                                              const std::size_t p_inputLength)
+                                              const std::size_t p_inputLength) const
 {
     std::set<const char*> returnValue;
-    SearchNode* currentNode = &m_rootNode;
-    const char* end = p_inputString + p_inputLength;
-    for (const char* start = p_inputString; start < end; ++start)
-    {
-        currentNode = currentNode->getNext(*start);
-        if (!currentNode->getStoredData().empty())
-        {
-            returnValue.insert(start - 3);
-        }
-    }
+    CollectOffsets visitor(p_inputString, returnValue);
+    scan(reinterpret_cast<const unsigned char*>(p_inputString), p_inputLength, visitor);
     return returnValue;
 }
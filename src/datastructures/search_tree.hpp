@@ -1,53 +1,246 @@
-#ifndef ELFPARSER_SEARCH_HPP
-#define ELFPARSER_SEARCH_HPP
-
-#include "search_node.hpp"
-
-#include <set>
-#include <queue>
-#include <string>
-
-#include <boost/ptr_container/ptr_vector.hpp>
-
-/*
- *  This is a basic automata implemenation. Used for efficient searching.
- */
-class SearchTree
-{
-public:
-
-    SearchTree();
-    ~SearchTree();
-
-    void addWord(const unsigned char* p_input,
-                    unsigned char p_length, void* p_storeData);
-    void addWord(const char* p_input, unsigned char p_length, void* p_storeData);
-    void addWord(const std::string& p_string,
-                    void* p_storeData);
-
-    std::set<const char*> findOffsets(const char* const p_inputString,
-                                      const std::size_t p_inputLength);
-    std::set<void*> search(const char* const p_inputString,
-                           const std::size_t p_inputLength);
-
-    std::set<void*> search(const unsigned char* const p_inputString,
-                                  const std::size_t p_inputLength);
-
-    void compile();
-
-private:
-
-    void doAddWord(SearchNode* p_node, const unsigned char* p_input,
-                        unsigned char p_length, void* p_storeData);
-
-private:
-
-    SearchNode m_rootNode;
-
-    bool m_ready;
-
-    boost::ptr_vector<SearchNode> m_nodeVector;
-};
-
-#endif
-
+#ifndef ELFPARSER_SEARCH_HPP
+#define ELFPARSER_SEARCH_HPP
+
+#include "search_node.hpp"
+#include "search_prefilter.hpp"
+
+#include <set>
+#include <queue>
+#include <string>
+#include <vector>
+#include <cassert>
+
+#include <boost/cstdint.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+/*
+ * A single hit reported by SearchTree::search. m_pattern is the index of the
+ * word (in the order it was added), m_offset the offset of its first byte
+ * from the start of the searched buffer.
+ */
+struct SearchMatch
+{
+    SearchMatch(boost::uint32_t p_pattern, std::size_t p_offset, std::size_t p_length) :
+        m_pattern(p_pattern),
+        m_offset(p_offset),
+        m_length(p_length)
+    {
+    }
+
+    boost::uint32_t m_pattern;
+    std::size_t m_offset;
+    std::size_t m_length;
+};
+
+/*
+ *  This is a basic automata implemenation. Used for efficient searching.
+ *  Once compiled the tree is read only, so a single tree can be searched by
+ *  many threads at once.
+ *
+ *  The words are added to a trie of SearchNodes. compile() computes the
+ *  failure links and then flattens the whole thing into a DFA table: one
+ *  contiguous array of 32 bit states where every state is a row of
+ *  transitions. The states are stored premultiplied (ie, as the offset of
+ *  their row) so a transition is a single load. With alphabet compression the
+ *  bytes that behave the same in every state share a column, which shrinks a
+ *  row from 256 entries to the number of distinct byte classes. Accepting
+ *  states are numbered last so "did we match" is a single compare, and their
+ *  pattern indexes live in one array addressed by per state ranges. The trie
+ *  is thrown away afterwards.
+ *
+ *  While the DFA is in the root state a SearchPrefilter jumps ahead to the
+ *  next byte that can start a word.
+ *
+ *  Matches are reported as they are found, either to a visitor or appended to
+ *  a vector of SearchMatch. Nothing is allocated while walking the input
+ *  (other than the vector growing); removing duplicates is a separate pass.
+ */
+class SearchTree
+{
+public:
+
+    SearchTree();
+    ~SearchTree();
+
+    void addWord(const unsigned char* p_input,
+                    unsigned char p_length, void* p_storeData);
+    void addWord(const char* p_input, unsigned char p_length, void* p_storeData);
+    void addWord(const std::string& p_string,
+                    void* p_storeData);
+
+    /*
+     * where a scan is at. lets the input be fed in blocks, a match that
+     * straddles two blocks is still found.
+     */
+    struct ScanState
+    {
+        ScanState() :
+            m_state(0),
+            m_offset(0)
+        {
+        }
+
+        // the premultiplied DFA state
+        boost::uint32_t m_state;
+
+        // the offset of the next byte from the start of the whole input
+        std::size_t m_offset;
+    };
+
+    /*
+     * walks the input and calls p_visitor(pattern index, start offset) for
+     * every occurrence of every word, in the order the occurrences end.
+     */
+    template <typename Visitor>
+    void scan(const unsigned char* const p_inputString,
+              const std::size_t p_inputLength, Visitor& p_visitor) const;
+
+    /*
+     * like scan() but continues from p_state. offsets are from the start of
+     * the first block.
+     */
+    template <typename Visitor>
+    void scan(ScanState& p_state, const unsigned char* const p_inputString,
+              const std::size_t p_inputLength, Visitor& p_visitor) const;
+
+    // appends every occurrence of every word to p_matches
+    void search(const char* const p_inputString, const std::size_t p_inputLength,
+                std::vector<SearchMatch>& p_matches) const;
+
+    // appends every occurrence of every word to p_matches. continues from p_state
+    void search(ScanState& p_state, const unsigned char* const p_inputString,
+                const std::size_t p_inputLength, std::vector<SearchMatch>& p_matches) const;
+
+    // keeps only the first occurrence of each word
+    static void removeDuplicates(std::vector<SearchMatch>& p_matches);
+
+    // return the data stored with the p_pattern'th word
+    void* getStoredData(boost::uint32_t p_pattern) const;
+
+    // return the length of the p_pattern'th word
+    std::size_t getLength(boost::uint32_t p_pattern) const;
+
+    // return the start of every occurrence of every word
+    std::set<const char*> findOffsets(const char* const p_inputString,
+                                      const std::size_t p_inputLength) const;
+    // return the stored data of every word found
+    std::set<void*> search(const char* const p_inputString,
+                           const std::size_t p_inputLength) const;
+
+    std::set<void*> search(const unsigned char* const p_inputString,
+                                  const std::size_t p_inputLength) const;
+
+    /*
+     * builds the DFA. no words can be added afterwards
+     * p_compressAlphabet merge the bytes that share every transition into
+     *                    byte classes
+     */
+    void compile(bool p_compressAlphabet = true);
+
+    // return the number of DFA states
+    std::size_t getStateCount() const;
+
+    // return the number of transitions per state (256 without compression)
+    std::size_t getClassCount() const;
+
+private:
+
+    void doAddWord(SearchNode* p_node, const unsigned char* p_input,
+                        unsigned char p_length, boost::uint32_t p_pattern);
+
+    // computes the failure links and fills in the missing trie transitions
+    void linkFailures();
+
+    // assigns the byte classes. identity mapping without compression
+    void buildClasses(const std::vector<const SearchNode*>& p_nodes,
+                      bool p_compressAlphabet);
+
+    // returns the pattern indexes of a premultiplied accepting state
+    const boost::uint32_t* outputBegin(boost::uint32_t p_state) const;
+    const boost::uint32_t* outputEnd(boost::uint32_t p_state) const;
+
+private:
+
+    // a word added to the tree
+    struct Pattern
+    {
+        void* m_storedData;
+        boost::uint32_t m_length;
+    };
+
+    SearchNode m_rootNode;
+
+    bool m_ready;
+
+    boost::ptr_vector<SearchNode> m_nodeVector;
+
+    // the words, indexed by pattern index
+    std::vector<Pattern> m_patterns;
+
+    // maps a byte to its column in the transition table
+    boost::uint8_t m_classes[256];
+
+    // the number of columns in a row
+    boost::uint32_t m_stride;
+
+    // the transition table. entries are premultiplied states
+    std::vector<boost::uint32_t> m_transitions;
+
+    // premultiplied states at or above this one are accepting
+    boost::uint32_t m_firstAccepting;
+
+    // the patterns of accepting state n are [m_outputIndex[n], m_outputIndex[n + 1])
+    std::vector<boost::uint32_t> m_outputIndex;
+
+    // the pattern indexes of all the accepting states, back to back
+    std::vector<boost::uint32_t> m_outputs;
+
+    // skips the bytes that leave the root state where it is
+    SearchPrefilter m_prefilter;
+};
+
+template <typename Visitor>
+void SearchTree::scan(const unsigned char* const p_inputString,
+                      const std::size_t p_inputLength, Visitor& p_visitor) const
+{
+    ScanState state;
+    scan(state, p_inputString, p_inputLength, p_visitor);
+}
+
+template <typename Visitor>
+void SearchTree::scan(ScanState& p_state, const unsigned char* const p_inputString,
+                      const std::size_t p_inputLength, Visitor& p_visitor) const
+{
+    assert(m_ready && p_inputString != NULL);
+
+    const boost::uint32_t* transitions = &m_transitions[0];
+    const bool prefilter = m_prefilter.isEnabled();
+    boost::uint32_t state = p_state.m_state;
+    for (std::size_t i = 0; i < p_inputLength; ++i)
+    {
+        if (state == 0 && prefilter)
+        {
+            i = m_prefilter.find(p_inputString, i, p_inputLength);
+            if (i == p_inputLength)
+            {
+                break;
+            }
+        }
+
+        state = transitions[state + m_classes[p_inputString[i]]];
+        if (state >= m_firstAccepting)
+        {
+            const std::size_t offset = p_state.m_offset + i + 1;
+            const boost::uint32_t* end = outputEnd(state);
+            for (const boost::uint32_t* pattern = outputBegin(state); pattern != end; ++pattern)
+            {
+                p_visitor(*pattern, offset - m_patterns[*pattern].m_length);
+            }
+        }
+    }
+
+    p_state.m_state = state;
+    p_state.m_offset += p_inputLength;
+}
+
+#endif
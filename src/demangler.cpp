@@ -0,0 +1,75 @@
+#include "demangler.hpp"
+
+#include <mutex>
+#include <cstdlib>
+#include <unordered_map>
+
+#ifndef WINDOWS
+#include <cxxabi.h>
+#endif
+
+const std::size_t Demangler::k_maxCached;
+
+namespace
+{
+    std::mutex s_cacheLock;
+
+    // mangled name -> demangled name (the mangled one if it doesn't demangle)
+    std::unordered_map<std::string, std::string> s_cache;
+
+#ifndef WINDOWS
+    // the output buffer of __cxa_demangle. malloc'ed, grown with realloc
+    struct Buffer
+    {
+        Buffer() : m_data(NULL), m_size(0)
+        {
+        }
+
+        ~Buffer()
+        {
+            free(m_data);
+        }
+
+        char* m_data;
+        std::size_t m_size;
+    };
+
+    thread_local Buffer t_buffer;
+#endif
+}
+
+std::string Demangler::demangle(boost::string_view p_mangled)
+{
+    const std::string mangled(p_mangled.data(), p_mangled.size());
+    {
+        std::lock_guard<std::mutex> lock(s_cacheLock);
+        std::unordered_map<std::string, std::string>::const_iterator it = s_cache.find(mangled);
+        if (it != s_cache.end())
+        {
+            return it->second;
+        }
+    }
+
+    std::string demangled(mangled);
+#ifndef WINDOWS
+    // the buffer is reallocated if the name doesn't fit and left alone on failure
+    int status = 0;
+    char* result = abi::__cxa_demangle(mangled.c_str(), t_buffer.m_data, &t_buffer.m_size, &status);
+    if (result != NULL)
+    {
+        t_buffer.m_data = result;
+        if (status == 0)
+        {
+            demangled.assign(result);
+        }
+    }
+#endif
+
+    std::lock_guard<std::mutex> lock(s_cacheLock);
+    if (s_cache.size() >= k_maxCached)
+    {
+        s_cache.clear();
+    }
+    s_cache.insert(std::make_pair(mangled, demangled));
+    return demangled;
+}
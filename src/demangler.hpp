@@ -0,0 +1,40 @@
+#ifndef DEMANGLER_HPP
+#define DEMANGLER_HPP
+
+#include <string>
+#include <cstddef>
+#include <boost/utility/string_view.hpp>
+
+/*
+ * Demangles C++ names when they are displayed. Parsing and scoring work on
+ * the names as they are in the file, so a binary that is never printed never
+ * pays for demangling.
+ *
+ * The results are cached for the whole process, keyed by the mangled name,
+ * since the same names show up in binary after binary (libstdc++, boost). The
+ * cache is shared by the scanning threads. Every thread demangles into a
+ * buffer of its own that only ever grows.
+ */
+class Demangler
+{
+public:
+
+    // the cache is emptied once it holds this many names
+    static const std::size_t k_maxCached = 64 * 1024;
+
+    /*
+     * p_mangled a mangled name
+     * return the demangled name. p_mangled if it doesn't demangle (or on
+     * Windows)
+     */
+    static std::string demangle(boost::string_view p_mangled);
+
+private:
+
+    // disable evil things
+    Demangler();
+    Demangler(const Demangler& p_rhs);
+    Demangler& operator=(const Demangler& p_rhs);
+};
+
+#endif
@@ -19,6 +19,21 @@ DynamicSection::DynamicSection() : m_offset(0),
                                    m_symbolTableSize(0),
                                    m_initArrayVirtAddress(0),
                                    m_initArrayEntries(0),
+                                   m_relVirtAddress(0),
+                                   m_relSize(0),
+                                   m_relaVirtAddress(0),
+                                   m_relaSize(0),
+                                   m_jmpRelVirtAddress(0),
+                                   m_pltRelSize(0),
+                                   m_pltRel(0),
+                                   m_versymVirtAddress(0),
+                                   m_verneedVirtAddress(0),
+                                   m_verneedCount(0),
+                                   m_verdefVirtAddress(0),
+                                   m_verdefCount(0),
+                                   m_hashVirtAddress(0),
+                                   m_gnuHashVirtAddress(0),
+                                   m_hash(),
                                    m_entries(),
                                    m_fileSize(0)
 {
@@ -33,7 +48,7 @@ boost::uint64_t DynamicSection::getOffset() const
     return m_offset;
 }
 
-void DynamicSection::createDynamic(const char *p_start, boost::uint32_t p_offset,
+void DynamicSection::createDynamic(const char *p_start, boost::uint64_t p_fileSize, boost::uint32_t p_offset,
                                    boost::uint32_t p_size, boost::uint64_t p_baseAddress,
                                    bool p_is64, bool p_isLE, const AbstractSegments &p_segments)
 {
@@ -96,21 +111,10 @@ void DynamicSection::createDynamic(const char *p_start, boost::uint32_t p_offset
             m_stringTableSize =  value;
             break;
         case elf::dynamic::k_hash:
+            m_hashVirtAddress = value;
+            break;
         case elf::dynamic::k_gnuhash:
-            if (m_symbolTableSize == 0 && value <= m_fileSize)
-            {
-                if (value - p_baseAddress > m_fileSize) {
-                    throw std::runtime_error("Unexpected dynamic entry value.");
-                }
-
-                const boost::uint32_t *hashStart = reinterpret_cast<const boost::uint32_t *>(p_start + (value - p_baseAddress));
-                ++hashStart;
-                m_symbolTableSize = *hashStart;
-                if (!p_isLE)
-                {
-                    m_symbolTableSize = ntohl(m_symbolTableSize);
-                }
-            }
+            m_gnuHashVirtAddress = value;
             break;
         case elf::dynamic::k_initarray:
             m_initArrayVirtAddress =  value;
@@ -118,10 +122,53 @@ void DynamicSection::createDynamic(const char *p_start, boost::uint32_t p_offset
         case elf::dynamic::k_init_arraysz:
             m_initArrayEntries =  value / (p_is64 ? 8 : 4);
             break;
+        case elf::dynamic::k_rel:
+            m_relVirtAddress = value;
+            break;
+        case elf::dynamic::k_relsz:
+            m_relSize = value;
+            break;
+        case elf::dynamic::k_rela:
+            m_relaVirtAddress = value;
+            break;
+        case elf::dynamic::k_relasz:
+            m_relaSize = value;
+            break;
+        case elf::dynamic::k_jmprel:
+            m_jmpRelVirtAddress = value;
+            break;
+        case elf::dynamic::k_pltrelsz:
+            m_pltRelSize = value;
+            break;
+        case elf::dynamic::k_pltrel:
+            m_pltRel = value;
+            break;
+        case elf::dynamic::k_versym:
+            m_versymVirtAddress = value;
+            break;
+        case elf::dynamic::k_verneed:
+            m_verneedVirtAddress = value;
+            break;
+        case elf::dynamic::k_verneednum:
+            m_verneedCount = value;
+            break;
+        case elf::dynamic::k_verdef:
+            m_verdefVirtAddress = value;
+            break;
+        case elf::dynamic::k_verdefnum:
+            m_verdefCount = value;
+            break;
         default:
             break;
         }
     }
+
+    // the hash tables know how many dynamic symbols there are
+    m_hash.createHash(p_start, p_fileSize,
+                      m_hashVirtAddress != 0 ? p_segments.getOffsetFromVirt(m_hashVirtAddress) : 0,
+                      m_gnuHashVirtAddress != 0 ? p_segments.getOffsetFromVirt(m_gnuHashVirtAddress) : 0,
+                      p_is64, p_isLE);
+    m_symbolTableSize = m_hash.getSymbolCount();
 }
 
 void DynamicSection::doDynamic64(const elf::dynamic::dynamic_64 *p_dynamic,
@@ -178,6 +225,11 @@ boost::uint32_t DynamicSection::getSymbolTableSize() const
     return m_symbolTableSize;
 }
 
+const SymbolHash &DynamicSection::getHash() const
+{
+    return m_hash;
+}
+
 boost::uint64_t DynamicSection::getInitArray() const
 {
     return m_initArrayVirtAddress;
@@ -188,6 +240,70 @@ boost::uint32_t DynamicSection::getInitArrayEntries() const
     return m_initArrayEntries;
 }
 
+boost::uint64_t DynamicSection::getRelVirtAddress() const
+{
+    return m_relVirtAddress;
+}
+
+boost::uint64_t DynamicSection::getRelSize() const
+{
+    return m_relSize;
+}
+
+boost::uint64_t DynamicSection::getRelaVirtAddress() const
+{
+    return m_relaVirtAddress;
+}
+
+boost::uint64_t DynamicSection::getRelaSize() const
+{
+    return m_relaSize;
+}
+
+boost::uint64_t DynamicSection::getJmpRelVirtAddress() const
+{
+    return m_jmpRelVirtAddress;
+}
+
+boost::uint64_t DynamicSection::getPltRelSize() const
+{
+    return m_pltRelSize;
+}
+
+boost::uint64_t DynamicSection::getVersymVirtAddress() const
+{
+    return m_versymVirtAddress;
+}
+
+boost::uint64_t DynamicSection::getVerneedVirtAddress() const
+{
+    return m_verneedVirtAddress;
+}
+
+boost::uint64_t DynamicSection::getVerneedCount() const
+{
+    return m_verneedCount;
+}
+
+boost::uint64_t DynamicSection::getVerdefVirtAddress() const
+{
+    return m_verdefVirtAddress;
+}
+
+boost::uint64_t DynamicSection::getVerdefCount() const
+{
+    return m_verdefCount;
+}
+
+bool DynamicSection::isPltRela(bool p_is64) const
+{
+    if (m_pltRel == 0)
+    {
+        return p_is64;
+    }
+    return m_pltRel == elf::dynamic::k_rela;
+}
+
 void DynamicSection::evaluate(std::vector<std::pair<boost::int32_t, std::string>> &p_reasons,
                               std::map<elf::Capabilties, std::set<std::string>> &p_capabilities) const
 {
@@ -8,6 +8,7 @@
 #include <boost/cstdint.hpp>
 
 #include "abstract_dynamic.hpp"
+#include "symbol_hash.hpp"
 #include "structures/capabilities.hpp"
 
 namespace elf
@@ -27,7 +28,7 @@ public:
     DynamicSection();
     ~DynamicSection();
 
-    void createDynamic(const char* p_start, boost::uint32_t p_offset,
+    void createDynamic(const char* p_start, boost::uint64_t p_fileSize, boost::uint32_t p_offset,
                        boost::uint32_t p_size, boost::uint64_t p_baseAddress,
                        bool p_is64, bool p_isLE, const AbstractSegments& p_segments);
 
@@ -35,10 +36,32 @@ public:
     boost::uint64_t getSymbolTableVirtAddress() const;
     boost::uint64_t getStringTableVirtualAddress() const;
     boost::uint64_t getStringTableSize() const;
+    // the number of dynamic symbols according to the hash tables. 0 if there are none
     boost::uint32_t getSymbolTableSize() const;
+
+    // return the decoded DT_HASH / DT_GNU_HASH tables
+    const SymbolHash& getHash() const;
     boost::uint64_t getInitArray() const;
     boost::uint32_t getInitArrayEntries() const;
 
+    // the DT_REL, DT_RELA and DT_JMPREL tables. 0 if there is none
+    boost::uint64_t getRelVirtAddress() const;
+    boost::uint64_t getRelSize() const;
+    boost::uint64_t getRelaVirtAddress() const;
+    boost::uint64_t getRelaSize() const;
+    boost::uint64_t getJmpRelVirtAddress() const;
+    boost::uint64_t getPltRelSize() const;
+
+    // the DT_VERSYM, DT_VERNEED and DT_VERDEF tables. 0 if there is none
+    boost::uint64_t getVersymVirtAddress() const;
+    boost::uint64_t getVerneedVirtAddress() const;
+    boost::uint64_t getVerneedCount() const;
+    boost::uint64_t getVerdefVirtAddress() const;
+    boost::uint64_t getVerdefCount() const;
+
+    // return true if DT_JMPREL holds RELA entries. DT_PLTREL says so, or the class if it is missing
+    bool isPltRela(bool p_is64) const;
+
     /*!
      * Calls into the various segments for evaluation / scoring information.
      * \param[in,out] p_reasons stores the scoring and reasons
@@ -73,6 +96,21 @@ private:
     boost::uint32_t m_symbolTableSize;
     boost::uint64_t m_initArrayVirtAddress;
     boost::uint32_t m_initArrayEntries;
+    boost::uint64_t m_relVirtAddress;
+    boost::uint64_t m_relSize;
+    boost::uint64_t m_relaVirtAddress;
+    boost::uint64_t m_relaSize;
+    boost::uint64_t m_jmpRelVirtAddress;
+    boost::uint64_t m_pltRelSize;
+    boost::uint64_t m_pltRel;
+    boost::uint64_t m_versymVirtAddress;
+    boost::uint64_t m_verneedVirtAddress;
+    boost::uint64_t m_verneedCount;
+    boost::uint64_t m_verdefVirtAddress;
+    boost::uint64_t m_verdefCount;
+    boost::uint64_t m_hashVirtAddress;
+    boost::uint64_t m_gnuHashVirtAddress;
+    SymbolHash m_hash;
     std::vector<AbstractDynamicEntry> m_entries;
     uint32_t m_fileSize;
 };
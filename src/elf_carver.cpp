@@ -0,0 +1,186 @@
+#include "elf_carver.hpp"
+#include "elfparser.hpp"
+#include "abstract_elfheader.hpp"
+#include "abstract_programheader.hpp"
+#include "programheaders.hpp"
+
+#include <memory>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/foreach.hpp>
+
+const std::size_t ElfCarver::k_defaultMaxDepth;
+const std::size_t ElfCarver::k_defaultMaxJobs;
+const boost::uint64_t ElfCarver::k_defaultMaxBytes;
+
+namespace
+{
+    std::string describe(const std::string& p_reason, std::size_t p_offset)
+    {
+        std::stringstream note;
+        note << p_reason << " at file offset 0x" << std::hex << p_offset;
+        return note.str();
+    }
+}
+
+ElfCarver::ElfCarver() :
+    m_maxDepth(k_defaultMaxDepth),
+    m_maxJobs(k_defaultMaxJobs),
+    m_maxBytes(k_defaultMaxBytes),
+    m_jobs(),
+    m_notes()
+{
+}
+
+ElfCarver::~ElfCarver()
+{
+}
+
+void ElfCarver::setMaxDepth(std::size_t p_maxDepth)
+{
+    m_maxDepth = p_maxDepth;
+}
+
+void ElfCarver::setMaxJobs(std::size_t p_maxJobs)
+{
+    m_maxJobs = p_maxJobs;
+}
+
+void ElfCarver::setMaxBytes(boost::uint64_t p_maxBytes)
+{
+    m_maxBytes = p_maxBytes;
+}
+
+const std::vector<std::string>& ElfCarver::getNotes() const
+{
+    return m_notes;
+}
+
+std::size_t ElfCarver::imageSize(const char* p_data, std::size_t p_available)
+{
+    AbstractElfHeader header;
+    header.setHeader(p_data, p_available);
+
+    // the headers themselves, the section table (usually last) and the segments
+    boost::uint64_t end = header.is64() ? sizeof(elf::elf_header_64) : sizeof(elf::elf_header_32);
+    const boost::uint64_t sectionEnd = header.getSectionOffset() +
+        static_cast<boost::uint64_t>(header.getSectionSize()) * header.getSectionCount();
+    const boost::uint64_t programEnd = header.getProgramOffset() +
+        static_cast<boost::uint64_t>(header.getProgramSize()) * header.getProgramCount();
+    end = std::max(end, std::max(sectionEnd, programEnd));
+
+    if (programEnd <= p_available && header.getProgramSize() != 0)
+    {
+        ProgramHeaders programs;
+        programs.setHeaders(p_data + header.getProgramOffset(), header.getProgramCount(),
+                            header.getProgramSize(), header.is64(), header.isLE());
+        BOOST_FOREACH (const AbstractProgramHeader& program, programs.getProgramHeaders())
+        {
+            if (program.getOffset() < p_available)
+            {
+                end = std::max(end, program.getOffset() + std::min<boost::uint64_t>(
+                    program.getFileSize(), p_available - program.getOffset()));
+            }
+        }
+    }
+
+    return static_cast<std::size_t>(std::min<boost::uint64_t>(end, p_available));
+}
+
+void ElfCarver::enqueue(ELFParser& p_parser, std::size_t p_depth)
+{
+    BOOST_FOREACH (std::size_t offset, p_parser.getEmbeddedOffsets())
+    {
+        const std::size_t fileOffset = p_parser.getBaseOffset() + offset;
+        if (p_depth > m_maxDepth)
+        {
+            m_notes.push_back(describe("Not carved (depth limit)", fileOffset));
+        }
+        else if (m_jobs.size() >= m_maxJobs)
+        {
+            m_notes.push_back(describe("Not carved (queue full)", fileOffset));
+        }
+        else
+        {
+            Job job = { &p_parser, offset, p_depth };
+            m_jobs.push(job);
+        }
+    }
+}
+
+std::size_t ElfCarver::carve(ELFParser& p_root)
+{
+    m_notes.clear();
+
+    std::size_t carved = 0;
+    boost::uint64_t bytes = 0;
+
+    enqueue(p_root, 1);
+    while (!m_jobs.empty())
+    {
+        const Job job(m_jobs.front());
+        m_jobs.pop();
+
+        ELFParser& parent = *job.m_parent;
+        const std::size_t fileOffset = parent.getBaseOffset() + job.m_offset;
+
+        /* the parent found every header inside its carved children as well.
+         * those belong to the child (which was carved first, being earlier
+         * in the file) */
+        bool nested = false;
+        BOOST_FOREACH (const ELFParser& sibling, parent.getChildren())
+        {
+            if (fileOffset >= sibling.getBaseOffset() &&
+                fileOffset - sibling.getBaseOffset() < sibling.getFileSize())
+            {
+                nested = true;
+                break;
+            }
+        }
+        if (nested)
+        {
+            continue;
+        }
+
+        if (carved >= m_maxJobs)
+        {
+            m_notes.push_back(describe("Not carved (job limit)", fileOffset));
+            continue;
+        }
+
+        const char* data = parent.getData() + job.m_offset;
+        const std::size_t available = parent.getFileSize() - job.m_offset;
+        std::unique_ptr<ELFParser> child(new ELFParser());
+        try
+        {
+            const std::size_t size = imageSize(data, available);
+            if (bytes + size > m_maxBytes)
+            {
+                m_notes.push_back(describe("Not carved (byte limit)", fileOffset));
+                continue;
+            }
+
+            std::stringstream name;
+            name << p_root.getFilename() << "@0x" << std::hex << fileOffset;
+
+            // the digests are computed if they're asked for
+            child->setDigests(0);
+            child->parse(data, size, name.str(), fileOffset);
+            child->evaluate();
+            bytes += size;
+        }
+        catch (const std::exception& e)
+        {
+            m_notes.push_back(describe(std::string("Failed to carve (") + e.what() + ")", fileOffset));
+            continue;
+        }
+
+        ++carved;
+        ELFParser& added = *child;
+        parent.addChild(child.release());
+        enqueue(added, job.m_depth + 1);
+    }
+
+    return carved;
+}
@@ -0,0 +1,91 @@
+#ifndef ELF_CARVER_HPP
+#define ELF_CARVER_HPP
+
+#include <queue>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+class ELFParser;
+
+/*
+ * Carves the ELF binaries embedded in a parsed file (a dropper's payload,
+ * ie). Every embedded header ELFParser::evaluate() accepted becomes a job
+ * that parses and evaluates the bytes the embedded binary's own headers
+ * claim, right out of the parent's memory. The child is attached to its
+ * parent, so the result is a tree of parsers with scores and capabilities of
+ * their own. Children are carved in turn.
+ *
+ * The jobs go through a bounded, breadth first queue. A hostile file can nest
+ * binaries or repeat headers as often as it likes, so the depth, the number of
+ * jobs and the total number of carved bytes are limited. Whatever a limit cut
+ * off is listed in the notes.
+ */
+class ElfCarver
+{
+public:
+
+    // the default limits
+    static const std::size_t k_defaultMaxDepth = 4;
+    static const std::size_t k_defaultMaxJobs = 64;
+    static const boost::uint64_t k_defaultMaxBytes = 256 * 1024 * 1024;
+
+    ElfCarver();
+    ~ElfCarver();
+
+    // the deepest a binary can be nested and still get carved (1 = children only)
+    void setMaxDepth(std::size_t p_maxDepth);
+
+    // the number of binaries carved (and of jobs queued) at most
+    void setMaxJobs(std::size_t p_maxJobs);
+
+    // the number of bytes parsed for all of the carved binaries together
+    void setMaxBytes(boost::uint64_t p_maxBytes);
+
+    /*
+     * carves everything embedded in p_root, which has to be parsed and
+     * evaluated. the carved parsers are added to their parents.
+     * return the number of binaries carved
+     */
+    std::size_t carve(ELFParser& p_root);
+
+    // return what the limits cut off during the last carve()
+    const std::vector<std::string>& getNotes() const;
+
+    /*
+     * return the number of bytes the ELF binary at p_data covers according to
+     * its section and program headers. at most p_available
+     */
+    static std::size_t imageSize(const char* p_data, std::size_t p_available);
+
+private:
+
+    // disable evil things
+    ElfCarver(const ElfCarver& p_rhs);
+    ElfCarver& operator=(const ElfCarver& p_rhs);
+
+    // queues the embedded headers of p_parser, found p_depth levels down
+    void enqueue(ELFParser& p_parser, std::size_t p_depth);
+
+private:
+
+    // an embedded header waiting to be carved out of its parent
+    struct Job
+    {
+        ELFParser* m_parent;
+        std::size_t m_offset;
+        std::size_t m_depth;
+    };
+
+    std::size_t m_maxDepth;
+    std::size_t m_maxJobs;
+    boost::uint64_t m_maxBytes;
+
+    // the jobs waiting. never more than m_maxJobs
+    std::queue<Job> m_jobs;
+
+    std::vector<std::string> m_notes;
+};
+
+#endif
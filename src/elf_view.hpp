@@ -0,0 +1,237 @@
+#ifndef ELF_VIEW_HPP
+#define ELF_VIEW_HPP
+
+#include "structures/elfheader.hpp"
+#include "structures/sectionheader.hpp"
+#include "structures/programheader.hpp"
+#include "structures/symtable_entry.hpp"
+#include "structures/relocation.hpp"
+
+#include <boost/cstdint.hpp>
+
+#if WINDOWS || __APPLE__
+#include "endian.hpp"
+#else
+#include <arpa/inet.h>
+#endif
+
+/*
+ * Typed views over the raw ELF structures. Whether a binary is 32 or 64 bit
+ * and little or big endian is known once its ELF header has been read, so
+ * instead of testing both in every getter the tables are decoded by code that
+ * is compiled for one class and one byte order. dispatch() picks that code
+ * once and the views read their fields without a single branch.
+ *
+ * Like the rest of the parser, this assumes a little endian host.
+ */
+namespace elf
+{
+namespace view
+{
+    // the byte order of the binary
+    struct LittleEndian
+    {
+        static const bool k_isLE = true;
+        static boost::uint8_t get(boost::uint8_t p_value) { return p_value; }
+        static boost::uint16_t get(boost::uint16_t p_value) { return p_value; }
+        static boost::uint32_t get(boost::uint32_t p_value) { return p_value; }
+        static boost::uint64_t get(boost::uint64_t p_value) { return p_value; }
+    };
+
+    struct BigEndian
+    {
+        static const bool k_isLE = false;
+        static boost::uint8_t get(boost::uint8_t p_value) { return p_value; }
+        static boost::uint16_t get(boost::uint16_t p_value) { return ntohs(p_value); }
+        static boost::uint32_t get(boost::uint32_t p_value) { return ntohl(p_value); }
+        static boost::uint64_t get(boost::uint64_t p_value) { return htobe64(p_value); }
+    };
+
+    // the class of the binary
+    struct Class32
+    {
+        typedef elf_header_32 elf_header;
+        typedef section_header_32 section_header;
+        typedef program_header_32 program_header;
+        typedef symbol::symtable_entry32 symbol;
+        typedef relocation_32 relocation;
+        typedef rela_32 rela;
+        typedef boost::uint32_t address;
+        static const bool k_is64 = false;
+
+        // r_info holds the symbol index above the type
+        static boost::uint32_t getRelocationSymbol(boost::uint64_t p_info) { return p_info >> 8; }
+        static boost::uint32_t getRelocationType(boost::uint64_t p_info) { return p_info & 0xff; }
+    };
+
+    struct Class64
+    {
+        typedef elf_header_64 elf_header;
+        typedef section_header_64 section_header;
+        typedef program_header_64 program_header;
+        typedef symbol::symtable_entry64 symbol;
+        typedef relocation_64 relocation;
+        typedef rela_64 rela;
+        typedef boost::uint64_t address;
+        static const bool k_is64 = true;
+
+        static boost::uint32_t getRelocationSymbol(boost::uint64_t p_info) { return p_info >> 32; }
+        static boost::uint32_t getRelocationType(boost::uint64_t p_info) { return p_info & 0xffffffff; }
+    };
+
+    /*
+     * calls p_function(Class(), Order()) with the class and byte order of the
+     * binary. this is the only place either of them is tested.
+     */
+    template <typename Function>
+    void dispatch(bool p_is64, bool p_isLE, Function p_function)
+    {
+        if (p_is64)
+        {
+            if (p_isLE)
+            {
+                p_function(Class64(), LittleEndian());
+            }
+            else
+            {
+                p_function(Class64(), BigEndian());
+            }
+        }
+        else if (p_isLE)
+        {
+            p_function(Class32(), LittleEndian());
+        }
+        else
+        {
+            p_function(Class32(), BigEndian());
+        }
+    }
+
+    template <typename Class, typename Order>
+    class ElfHeaderView
+    {
+    public:
+
+        explicit ElfHeaderView(const char* p_data) :
+            m_header(reinterpret_cast<const typename Class::elf_header*>(p_data))
+        {
+        }
+
+        const typename Class::elf_header& raw() const { return *m_header; }
+        boost::uint16_t getType() const { return Order::get(m_header->m_type); }
+        boost::uint16_t getMachine() const { return Order::get(m_header->m_machine); }
+        boost::uint32_t getVersion() const { return Order::get(m_header->m_version); }
+        boost::uint64_t getEntry() const { return Order::get(m_header->m_entry); }
+        boost::uint64_t getProgramOffset() const { return Order::get(m_header->m_phoff); }
+        boost::uint64_t getSectionOffset() const { return Order::get(m_header->m_shoff); }
+        boost::uint32_t getFlags() const { return Order::get(m_header->m_flags); }
+        boost::uint16_t getEHSize() const { return Order::get(m_header->m_ehsize); }
+        boost::uint16_t getProgramSize() const { return Order::get(m_header->m_phentsize); }
+        boost::uint16_t getProgramCount() const { return Order::get(m_header->m_phnum); }
+        boost::uint16_t getSectionSize() const { return Order::get(m_header->m_shentsize); }
+        boost::uint16_t getSectionCount() const { return Order::get(m_header->m_shnum); }
+        boost::uint16_t getStringTableIndex() const { return Order::get(m_header->m_shtrndx); }
+
+    private:
+
+        const typename Class::elf_header* m_header;
+    };
+
+    template <typename Class, typename Order>
+    class SectionView
+    {
+    public:
+
+        explicit SectionView(const char* p_data) :
+            m_header(reinterpret_cast<const typename Class::section_header*>(p_data))
+        {
+        }
+
+        boost::uint32_t getName() const { return Order::get(m_header->m_name); }
+        boost::uint32_t getType() const { return Order::get(m_header->m_type); }
+        boost::uint64_t getFlags() const { return Order::get(m_header->m_flags); }
+        boost::uint64_t getAddress() const { return Order::get(m_header->m_addr); }
+        boost::uint64_t getOffset() const { return Order::get(m_header->m_offset); }
+        boost::uint64_t getSize() const { return Order::get(m_header->m_size); }
+        boost::uint32_t getLink() const { return Order::get(m_header->m_link); }
+        boost::uint32_t getInfo() const { return Order::get(m_header->m_info); }
+        boost::uint64_t getAddrAlign() const { return Order::get(m_header->m_addralign); }
+        boost::uint64_t getEntSize() const { return Order::get(m_header->m_entsize); }
+
+    private:
+
+        const typename Class::section_header* m_header;
+    };
+
+    template <typename Class, typename Order>
+    class ProgramView
+    {
+    public:
+
+        explicit ProgramView(const char* p_data) :
+            m_header(reinterpret_cast<const typename Class::program_header*>(p_data))
+        {
+        }
+
+        boost::uint32_t getType() const { return Order::get(m_header->m_type); }
+        boost::uint32_t getFlags() const { return Order::get(m_header->m_flags); }
+        boost::uint64_t getOffset() const { return Order::get(m_header->m_offset); }
+        boost::uint64_t getVirtualAddress() const { return Order::get(m_header->m_vaddr); }
+        boost::uint64_t getPhysicalAddress() const { return Order::get(m_header->m_paddr); }
+        boost::uint64_t getFileSize() const { return Order::get(m_header->m_filesz); }
+        boost::uint64_t getMemorySize() const { return Order::get(m_header->m_memsz); }
+        boost::uint64_t getAlign() const { return Order::get(m_header->m_align); }
+
+    private:
+
+        const typename Class::program_header* m_header;
+    };
+
+    template <typename Class, typename Order>
+    class SymbolView
+    {
+    public:
+
+        explicit SymbolView(const char* p_data) :
+            m_symbol(reinterpret_cast<const typename Class::symbol*>(p_data))
+        {
+        }
+
+        boost::uint32_t getName() const { return Order::get(m_symbol->m_name); }
+        boost::uint8_t getInfo() const { return m_symbol->m_info; }
+        boost::uint64_t getValue() const { return Order::get(m_symbol->m_address); }
+        boost::uint16_t getSectionIndex() const { return Order::get(m_symbol->m_shndx); }
+
+    private:
+
+        const typename Class::symbol* m_symbol;
+    };
+
+    /*
+     * a REL or RELA entry. they only differ in the trailing addend, so
+     * getAddend() may only be called on RELA entries
+     */
+    template <typename Class, typename Order>
+    class RelocationView
+    {
+    public:
+
+        explicit RelocationView(const char* p_data) :
+            m_entry(reinterpret_cast<const typename Class::rela*>(p_data))
+        {
+        }
+
+        boost::uint64_t getOffset() const { return Order::get(m_entry->m_offset); }
+        boost::uint64_t getInfo() const { return Order::get(m_entry->m_info); }
+        boost::uint32_t getSymbol() const { return Class::getRelocationSymbol(getInfo()); }
+        boost::uint32_t getType() const { return Class::getRelocationType(getInfo()); }
+        boost::uint64_t getAddend() const { return Order::get(m_entry->m_addend); }
+
+    private:
+
+        const typename Class::rela* m_entry;
+    };
+}
+}
+
+#endif
@@ -1,4 +1,10 @@
 #include "elfparser.hpp"
+#include "signatures.hpp"
+#include "regex_scanner.hpp"
+#include "byte_pipeline.hpp"
+#include "abstract_sectionheader.hpp"
+#include "abstract_programheader.hpp"
+#include "notes.hpp"
 #include "../lib/hash-lib/md5.hpp"
 #include "../lib/hash-lib/sha256.hpp"
 #include "../lib/hash-lib/sha1.hpp"
@@ -6,30 +12,13 @@
 #include <sstream>
 #include <fstream>
 #include <iomanip>
-#include <cmath>
-#include <regex>
 #include <set>
 #include <stdexcept>
-#include <boost/regex.hpp>
+#include <thread>
+#include <functional>
 #include <iostream>
 
 
-static double calcEntropyFunc(const unsigned int counted_bytes[256], const std::streamsize total_length)
-{
-    double entropy = 0.;
-        
-    double temp;
-
-    for (int i = 0; i < 256; i++) {
-        temp = static_cast<double>(counted_bytes[i]) / total_length;
-
-        if (temp > 0.)
-            entropy += temp * fabs(log2(temp));
-    }
-
-    return entropy;
-}
-
 std::size_t findFileSize(const std::string &p_file)
 {
     std::ifstream in(p_file.c_str(), std::ios::binary | std::ios::ate);
@@ -45,39 +34,29 @@ std::size_t findFileSize(const std::string &p_file)
     return return_value;
 }
 
+const double ELFParser::k_packedEntropy = 7.2;
+
 ELFParser::ELFParser() : m_entropy(0),
     m_score(0),
-    m_fileSize(0)
+    m_fileSize(0),
+    m_data(NULL),
+    m_baseOffset(0),
+    m_signatures(SignatureSet::instance()),
+    m_regexScanner(&RegexScanner::defaultScanner()),
+    m_digests(k_allDigests)
 {
-    
-    m_searchValues.push_back(new SearchValue("UPX!", elf::k_packed, "UPX signature found"));
-    m_searchValues.push_back(new SearchValue("the UPX Team. All Rights Reserved", elf::k_packed, "UPX copyright string found"));
-    m_searchValues.push_back(new SearchValue("PRIVMSG ", elf::k_irc, "IRC command PRIVMSG found"));
-    m_searchValues.push_back(new SearchValue("JOIN ", elf::k_irc, "IRC command JOIN found"));
-    m_searchValues.push_back(new SearchValue("NOTICE ", elf::k_irc, "IRC command NOTICE found"));
-    m_searchValues.push_back(new SearchValue("ustar\0", elf::k_compression, "Tar Archive signature found"));
-    m_searchValues.push_back(new SearchValue("\x1f\x8b\x08", elf::k_compression, "Gzip signature found"));
-    m_searchValues.push_back(new SearchValue("inflate 1.1.4 Copyright 1995-2002 Mark Adler", elf::k_compression, "Inflate 1.1.4 copyright string"));
-    m_searchValues.push_back(new SearchValue("inflate 1.2.3 Copyright 1995-2005 Mark Adler", elf::k_compression, "Inflate 1.2.3 copyright string"));
-    m_searchValues.push_back(new SearchValue("inflate 1.2.8 Copyright 1995-2013 Mark Adler", elf::k_compression, "Inflate 1.2.8 copyright string"));
-    m_searchValues.push_back(new SearchValue("/proc/cpuinfo", elf::k_infoGathering, "Examines /proc/cpuinfo"));
-    m_searchValues.push_back(new SearchValue("/proc/meminfo", elf::k_infoGathering, "Examines /proc/meminfo"));
-    m_searchValues.push_back(new SearchValue("/proc/stat", elf::k_infoGathering, "Examines /proc/stat"));
-    m_searchValues.push_back(new SearchValue("HISTFILE=", elf::k_envVariables, "Accesses the bash history file environment variable HISTFILE."));
-    BOOST_FOREACH (SearchValue &value, m_searchValues)
-    {
-        m_searchEngine.addWord(value.m_search, &value);
-    }
-
-    m_searchEngine.compile();
 }
 
 ELFParser::~ELFParser()
 {
-    m_searchValues.clear();
     m_mapped_file.close();
 }
 
+void ELFParser::setRegexScanner(const RegexScanner &p_scanner)
+{
+    m_regexScanner = &p_scanner;
+}
+
 boost::uint32_t ELFParser::getScore() const
 {
     return m_score;
@@ -95,20 +74,42 @@ std::size_t ELFParser::getFileSize() const
 
 std::string ELFParser::getSha1() const
 {
-    SHA1 sha1;
-    return sha1(m_mapped_file.data(), m_fileSize);
+    if (m_sha1.empty())
+    {
+        SHA1 sha1;
+        m_sha1 = sha1(m_data, m_fileSize);
+    }
+    return m_sha1;
 }
 
 std::string ELFParser::getSha256() const
 {
-    SHA256 sha256;
-    return sha256(m_mapped_file.data(), m_fileSize);
+    if (m_sha256.empty())
+    {
+        SHA256 sha256;
+        m_sha256 = sha256(m_data, m_fileSize);
+    }
+    return m_sha256;
 }
 
 std::string ELFParser::getMD5() const
 {
-    MD5 md5;
-    return md5(m_mapped_file.data(), m_fileSize);
+    if (m_md5.empty())
+    {
+        MD5 md5;
+        m_md5 = md5(m_data, m_fileSize);
+    }
+    return m_md5;
+}
+
+std::string ELFParser::getBuildId() const
+{
+    return NoteDecoder::decodeBuildId(m_segments.getBuildId());
+}
+
+void ELFParser::setDigests(unsigned int p_digests)
+{
+    m_digests = p_digests & k_allDigests;
 }
 
 std::string ELFParser::getFamily() const
@@ -126,11 +127,50 @@ double ELFParser::getEntropy()
     return m_entropy;
 }
 
+const EntropyProfile &ELFParser::getEntropyProfile() const
+{
+    return m_entropyProfile;
+}
+
+const char *ELFParser::getData() const
+{
+    return m_data;
+}
+
+std::size_t ELFParser::getBaseOffset() const
+{
+    return m_baseOffset;
+}
+
+const std::vector<std::size_t> &ELFParser::getEmbeddedOffsets() const
+{
+    return m_embeddedOffsets;
+}
+
+void ELFParser::addChild(ELFParser *p_child)
+{
+    m_children.push_back(p_child);
+}
+
+const boost::ptr_vector<ELFParser> &ELFParser::getChildren() const
+{
+    return m_children;
+}
+
+void ELFParser::setEntropyWindow(std::size_t p_window, std::size_t p_stride)
+{
+    m_entropyProfile.setWindow(p_window, p_stride);
+}
+
+void ELFParser::setDemangle(bool p_demangle)
+{
+    m_segments.setDemangle(p_demangle);
+}
+
 void ELFParser::parse(const std::string &p_file)
 {
     m_fileSize = findFileSize(p_file); // get size of file
     m_mapped_file.open(p_file, m_fileSize); // map elf in memory
-    m_filename.assign(p_file);    
 
     if (!m_mapped_file.is_open())
         throw std::runtime_error("Failed to memory map the file.");
@@ -138,9 +178,19 @@ void ELFParser::parse(const std::string &p_file)
     else if (p_file.empty())
         throw std::runtime_error("Parser given an empty file name.");
 
+    parse(m_mapped_file.data(), m_fileSize, p_file, 0);
+}
+
+void ELFParser::parse(const char *p_data, std::size_t p_size, const std::string &p_name,
+                      std::size_t p_baseOffset)
+{
+    m_data = p_data;
+    m_fileSize = p_size;
+    m_filename.assign(p_name);
+    m_baseOffset = p_baseOffset;
 
 	// get infos elf
-    const char* ptrDataMem = m_mapped_file.data();
+    const char* ptrDataMem = m_data;
     m_elfHeader.setHeader(ptrDataMem, m_fileSize);
 
     m_offset =  m_elfHeader.getProgramOffset();
@@ -178,7 +228,8 @@ void ELFParser::parse(const std::string &p_file)
     m_segments.setStart(ptrDataMem,
 					    m_fileSize, m_elfHeader.is64(),
                         m_elfHeader.isLE(),
-						m_elfHeader.getType() == "ET_DYN");
+						m_elfHeader.getType() == "ET_DYN",
+                        m_elfHeader.getMachineType());
 
 
     // important to do section header first since it produces more complete data
@@ -188,8 +239,135 @@ void ELFParser::parse(const std::string &p_file)
     m_segments.createDynamic();
     m_segments.generateSegments();
 
-	// calculate entropy binary all
-	calcEntropy(0, m_fileSize);
+    scanBytes();
+}
+
+namespace
+{
+    // hashes the whole buffer on a thread of its own
+    template <typename Hash>
+    void hashBuffer(const char *p_data, std::size_t p_length, std::string &p_digest)
+    {
+        Hash hash;
+        p_digest = hash(p_data, p_length);
+    }
+
+    // joins the threads however the scope is left. a thread destroyed while
+    // joinable would terminate the process
+    class ThreadJoiner
+    {
+    public:
+
+        explicit ThreadJoiner(std::vector<std::thread> &p_threads) :
+            m_threads(p_threads)
+        {
+        }
+
+        ~ThreadJoiner()
+        {
+            BOOST_FOREACH (std::thread &thread, m_threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+        }
+
+    private:
+
+        // disable evil things
+        ThreadJoiner(const ThreadJoiner &p_rhs);
+        ThreadJoiner &operator=(const ThreadJoiner &p_rhs);
+
+        std::vector<std::thread> &m_threads;
+    };
+}
+
+void ELFParser::scanBytes()
+{
+    HistogramConsumer histogram;
+    SearchConsumer signatures(m_signatures.getSignatures(), m_signatureMatches);
+    SearchConsumer elfMagic(m_signatures.getElfMagic(), m_elfMatches);
+    RegexScanner::Stream regexes(*m_regexScanner, m_data, m_fileSize, m_regexCapabilities);
+
+    // a range that starts past the end of the file has no bytes to measure
+    const SectionTable &sections = m_sectionHeader.getTable();
+    for (std::size_t i = 0; i < sections.size(); ++i)
+    {
+        if (sections.getType(i) != elf::k_nobits && sections.getSize(i) != 0 &&
+            sections.getOffset(i) < m_fileSize)
+        {
+            m_entropyProfile.addRange(EntropyProfile::k_section, sections.getName(i),
+                                      sections.getOffset(i), sections.getSize(i),
+                                      sections.isExecutable(i));
+        }
+    }
+    BOOST_FOREACH (const AbstractProgramHeader &header, m_programHeader.getProgramHeaders())
+    {
+        if (header.getFileSize() != 0 && header.getOffset() < m_fileSize)
+        {
+            m_entropyProfile.addRange(EntropyProfile::k_segment, header.getName(),
+                                      header.getOffset(), header.getFileSize(),
+                                      header.isExecutable());
+        }
+    }
+
+    // one pass over the file feeds everything that needs to see every byte
+    BytePipeline pipeline;
+    pipeline.addConsumer(histogram);
+    pipeline.addConsumer(signatures);
+    pipeline.addConsumer(elfMagic);
+    pipeline.addConsumer(regexes);
+    pipeline.addConsumer(m_entropyProfile);
+
+    /* the hashes are the slowest consumers. on a big file with cores to spare
+     * each one gets a thread of its own (reading the file on its own) while
+     * this thread does the rest. otherwise they ride along in the pipeline */
+    std::vector<std::thread> hashers;
+    ThreadJoiner joiner(hashers);
+    const bool parallel = m_fileSize >= k_parallelDigestSize &&
+                          std::thread::hardware_concurrency() > 1;
+
+    HashConsumer<MD5> md5;
+    HashConsumer<SHA1> sha1;
+    HashConsumer<SHA256> sha256;
+    if (m_digests & k_md5)
+    {
+        if (parallel)
+            hashers.emplace_back(&hashBuffer<MD5>, m_data, m_fileSize, std::ref(m_md5));
+        else
+            pipeline.addConsumer(md5);
+    }
+    if (m_digests & k_sha1)
+    {
+        if (parallel)
+            hashers.emplace_back(&hashBuffer<SHA1>, m_data, m_fileSize, std::ref(m_sha1));
+        else
+            pipeline.addConsumer(sha1);
+    }
+    if (m_digests & k_sha256)
+    {
+        if (parallel)
+            hashers.emplace_back(&hashBuffer<SHA256>, m_data, m_fileSize, std::ref(m_sha256));
+        else
+            pipeline.addConsumer(sha256);
+    }
+
+    // the hashers write the digests, they must be done before anything is read
+    pipeline.run(m_data, m_fileSize);
+    BOOST_FOREACH (std::thread &hasher, hashers)
+    {
+        hasher.join();
+    }
+
+    if (!parallel)
+    {
+        m_md5.assign(md5.getDigest());
+        m_sha1.assign(sha1.getDigest());
+        m_sha256.assign(sha256.getDigest());
+    }
+    m_entropy = histogram.getEntropy();
+    m_regexError.assign(regexes.getError());
+    SearchTree::removeDuplicates(m_signatureMatches);
 }
 
 void ELFParser::evaluate()
@@ -199,16 +377,60 @@ void ELFParser::evaluate()
     m_sectionHeader.evaluate(m_reasons, m_capabilities);
     m_segments.evaluate(m_reasons, m_capabilities);
 
-    std::set<void *> results = m_searchEngine.search(m_mapped_file.data(), m_fileSize);
-    BOOST_FOREACH (void *result, results)
+    const SearchTree &signatures(m_signatures.getSignatures());
+    BOOST_FOREACH (const SearchMatch &match, m_signatureMatches)
     {
-        SearchValue *converted = static_cast<SearchValue *>(result);
+        SearchValue *converted = static_cast<SearchValue *>(signatures.getStoredData(match.m_pattern));
         m_capabilities[converted->m_type].insert(converted->m_info);
     }
 
     regexScan();
     findELF();
 
+    // a compressed or encrypted payload is close to random, code isn't. the
+    // sections name the region best, so a segment is only reported when none
+    // of the packed sections lie inside it (ie there is no section table)
+    auto isPacked = [](const EntropyProfile::Range &p_range)
+    {
+        return p_range.m_executable && p_range.m_size >= k_packedMinimumSize &&
+               p_range.m_entropy >= k_packedEntropy;
+    };
+    auto reportPacked = [this](const EntropyProfile::Range &p_range)
+    {
+        std::stringstream info;
+        info << "High entropy executable " << (p_range.m_kind == EntropyProfile::k_section ? "section " : "segment ")
+             << p_range.m_name << " (" << std::fixed << std::setprecision(2) << p_range.m_entropy << ")";
+        m_capabilities[elf::k_packed].insert(info.str());
+    };
+
+    std::vector<const EntropyProfile::Range *> packedSections;
+    BOOST_FOREACH (const EntropyProfile::Range &range, m_entropyProfile.getRanges())
+    {
+        if (range.m_kind == EntropyProfile::k_section && isPacked(range))
+        {
+            packedSections.push_back(&range);
+            reportPacked(range);
+        }
+    }
+    BOOST_FOREACH (const EntropyProfile::Range &range, m_entropyProfile.getRanges())
+    {
+        if (range.m_kind != EntropyProfile::k_segment || !isPacked(range))
+        {
+            continue;
+        }
+
+        bool reported = false;
+        BOOST_FOREACH (const EntropyProfile::Range *section, packedSections)
+        {
+            reported |= section->m_offset >= range.m_offset &&
+                        section->m_offset - range.m_offset < range.m_size;
+        }
+        if (!reported)
+        {
+            reportPacked(range);
+        }
+    }
+
     for (auto &it : m_capabilities)
     {
         switch (it.first)
@@ -305,101 +527,131 @@ const DynamicSection &ELFParser::getDynamicSection() const
     return m_segments.getDynamicSection();
 }
 
-void ELFParser::printReasons() const
+void ELFParser::printReasons(std::ostream &p_stream) const
 {
-    std::cout << "---- Scoring Reasons ----" << std::endl;
+    p_stream << "---- Scoring Reasons ----" << std::endl;
     for (auto &it : m_reasons)
-        std::cout << it.first << " . " << it.second << std::endl;
+        p_stream << it.first << " . " << it.second << std::endl;
 }
 
-void ELFParser::printCapabilities() const
+void ELFParser::printCapabilities(std::ostream &p_stream) const
 {
-    std::cout << "---- Detected Capabilities ----" << std::endl;
+    p_stream << "---- Detected Capabilities ----" << std::endl;
     for (auto &it : m_capabilities)
     {
         switch (it.first)
         {
         case elf::k_fileFunctions:
-            std::cout << "File Functions" << std::endl;
+            p_stream << "File Functions" << std::endl;
             break;
         case elf::k_networkFunctions:
-            std::cout << "Network Functions" << std::endl;
+            p_stream << "Network Functions" << std::endl;
             break;
         case elf::k_processManipulation:
-            std::cout << "Process Manipulation" << std::endl;
+            p_stream << "Process Manipulation" << std::endl;
             break;
         case elf::k_pipeFunctions:
-            std::cout << "Pipe Functions" << std::endl;
+            p_stream << "Pipe Functions" << std::endl;
             break;
         case elf::k_crypto:
-            std::cout << "Random Functions" << std::endl;
+            p_stream << "Random Functions" << std::endl;
             break;
         case elf::k_infoGathering:
-            std::cout << "Information Gathering" << std::endl;
+            p_stream << "Information Gathering" << std::endl;
             break;
         case elf::k_envVariables:
-            std::cout << "Environment Variables" << std::endl;
+            p_stream << "Environment Variables" << std::endl;
             break;
         case elf::k_permissions:
-            std::cout << "Permissions" << std::endl;
+            p_stream << "Permissions" << std::endl;
             break;
         case elf::k_syslog:
-            std::cout << "System Log" << std::endl;
+            p_stream << "System Log" << std::endl;
             break;
         case elf::k_packetSniff:
-            std::cout << "Packet Sniffing" << std::endl;
+            p_stream << "Packet Sniffing" << std::endl;
             break;
         case elf::k_shell:
-            std::cout << "Shell" << std::endl;
+            p_stream << "Shell" << std::endl;
             break;
         case elf::k_packed:
-            std::cout << "Packed" << std::endl;
+            p_stream << "Packed" << std::endl;
             break;
         case elf::k_irc:
-            std::cout << "IRC" << std::endl;
+            p_stream << "IRC" << std::endl;
             break;
         case elf::k_http:
-            std::cout << "HTTP" << std::endl;
+            p_stream << "HTTP" << std::endl;
             break;
         case elf::k_compression:
-            std::cout << "Compression" << std::endl;
+            p_stream << "Compression" << std::endl;
             break;
         case elf::k_ipAddress:
-            std::cout << "IP Addresses" << std::endl;
+            p_stream << "IP Addresses" << std::endl;
             break;
         case elf::k_url:
-            std::cout << "URL" << std::endl;
+            p_stream << "URL" << std::endl;
             break;
         case elf::k_hooking:
-            std::cout << "Function Hooking" << std::endl;
+            p_stream << "Function Hooking" << std::endl;
             break;
         case elf::k_antidebug:
-            std::cout << "Anti-Debug" << std::endl;
+            p_stream << "Anti-Debug" << std::endl;
             break;
         case elf::k_dropper:
-            std::cout << "Dropper" << std::endl;
+            p_stream << "Dropper" << std::endl;
             break;
         case elf::k_filePath:
-            std::cout << "File Path" << std::endl;
+            p_stream << "File Path" << std::endl;
             break;
         default:
-            std::cout << "Unassigned" << std::endl;
+            p_stream << "Unassigned" << std::endl;
             break;
         }
         BOOST_FOREACH (const std::string &info, it.second)
         {
-            std::cout << info << std::endl;
+            p_stream << info << std::endl;
         }
     }
 }
 
-void ELFParser::printAll() const
+void ELFParser::printAll(std::ostream &p_stream) const
+{
+    p_stream << "---- ELF Structures ----" << std::endl;
+    p_stream << m_elfHeader.printToStdOut();
+    p_stream << m_programHeader.printToStdOut();
+    p_stream << m_sectionHeader.printToStdOut();
+    p_stream << m_segments.printToStdOut() << std::endl;
+}
+
+void ELFParser::printChildren(std::ostream &p_stream, std::size_t p_indent) const
+{
+    BOOST_FOREACH (const ELFParser &child, m_children)
+    {
+        p_stream << std::string(p_indent * 2, ' ')
+                 << " - 0x" << std::hex << child.getBaseOffset()
+                 << " (size 0x" << child.getFileSize() << ")" << std::dec
+                 << " Score: " << child.getScore()
+                 << " Family: " << child.getFamily()
+                 << " SHA256: " << child.getSha256() << std::endl;
+        child.printChildren(p_stream, p_indent + 1);
+    }
+}
+
+void ELFParser::printEntropy(std::ostream &p_stream) const
 {
-    std::cout << "---- ELF Structures ----" << std::endl;
-    std::cout << m_elfHeader.printToStdOut();
-    std::cout << m_programHeader.printToStdOut();
-    std::cout << m_sectionHeader.printToStdOut();
-    std::cout << m_segments.printToStdOut() << std::endl;
+    p_stream << std::dec << "Entropy (window = " << m_entropyProfile.getWindowSize()
+             << ", stride = " << m_entropyProfile.getStride()
+             << ", max = " << m_entropyProfile.getMaxWindow() << ")" << std::endl;
+
+    BOOST_FOREACH (const EntropyProfile::Range &range, m_entropyProfile.getRanges())
+    {
+        p_stream << "\t " << (range.m_kind == EntropyProfile::k_section ? "Section " : "Segment ")
+                 << range.m_name
+                 << "\t offset=0x" << std::hex << range.m_offset
+                 << "\t size=0x" << range.m_size << std::dec
+                 << "\t entropy=" << range.m_entropy << std::endl;
+    }
 }
 
 const std::map<elf::Capabilties, std::set<std::string>> &ELFParser::getCapabilties() const
@@ -409,94 +661,39 @@ const std::map<elf::Capabilties, std::set<std::string>> &ELFParser::getCapabilti
 
 void ELFParser::regexScan()
 {
-    try
+    if (!m_regexError.empty())
     {
-        // ips
-        boost::regex pattern("[1-2]?[0-9]?[0-9]\\.[1-2]?[0-9]?[0-9]\\.[1-2]?[0-9]?[0-9]\\.[1-2]?[0-9]?[0-9](?:[:0-9]{2,})*");
-        const char *start = m_mapped_file.data();
-        boost::cmatch m;
-        while (boost::regex_search(start, m_mapped_file.data() + m_fileSize, m, pattern))
-        {
-            for (auto &x : m)
-            {
-                m_capabilities[elf::k_ipAddress].insert(x);
-            }
-            start = (m_mapped_file.data() + m_fileSize) - m.suffix().length();
-        }
-
-        // urls
-        boost::regex urlPattern("(?:(?:http|https)://[A-Za-z0-9_./:%+?+)|(?:www.[A-Za-z0-9/:]+\\.com)");
-        start = m_mapped_file.data();
-        while (boost::regex_search(start, m_mapped_file.data() + m_fileSize, m, urlPattern))
-        {
-            for (auto &x : m)
-            {
-                m_capabilities[elf::k_url].insert(x);
-            }
-            start = (m_mapped_file.data() + m_fileSize) - m.suffix().length();
-        }
-
-        // commands
-        boost::regex shellPattern("(?:(?:wget|chmod|killall|nohup|sed|insmod|echo) [[:print:]]+)|(?:tar -[[:print:]]+)");
-        start = m_mapped_file.data();
-        while (boost::regex_search(start, m_mapped_file.data() + m_fileSize, m, shellPattern))
-        {
-            for (auto &x : m)
-            {
-                m_capabilities[elf::k_shell].insert(x);
-            }
-            start = (m_mapped_file.data() + m_fileSize) - m.suffix().length();
-        }
-
-        // url request
-        boost::regex urlRequest("(?:POST (?:/|%s)|GET (?:/|%s)|CONNECT (?:/|%s)|User-Agent:)[[:print:]]+");
-        start = m_mapped_file.data();
-        while (boost::regex_search(start, m_mapped_file.data() + m_fileSize, m, urlRequest))
-        {
-            for (auto &x : m)
-            {
-                m_capabilities[elf::k_http].insert(x);
-            }
-            start = (m_mapped_file.data() + m_fileSize) - m.suffix().length();
-        }
-
-        // file paths
-        boost::regex filePaths("/(?:usr|etc|tmp|bin)/[a-zA-Z0-9/\\._\\-]+");
-        start = m_mapped_file.data();
-        while (boost::regex_search(start, m_mapped_file.data() + m_fileSize, m, filePaths))
-        {
-            for (auto &x : m)
-            {
-                m_capabilities[elf::k_filePath].insert(x);
-            }
-            start = (m_mapped_file.data() + m_fileSize) - m.suffix().length();
-        }
+        std::cerr << m_regexError << std::endl;
     }
-    catch (const std::exception &e)
+
+    for (auto &it : m_regexCapabilities)
     {
-        std::cerr << e.what() << std::endl;
+        m_capabilities[it.first].insert(it.second.begin(), it.second.end());
     }
 }
 
 void ELFParser::findELF()
 {
-    SearchTree elfSearch;
-    elfSearch.addWord("\x7f\x45\x4c\x46", this);
-    elfSearch.compile();
-    std::set<const char *> data = elfSearch.findOffsets(this->m_mapped_file.data() + 1, m_fileSize - 1);
-    BOOST_FOREACH (const char *fib, data)
+    m_embeddedOffsets.clear();
+    BOOST_FOREACH (const SearchMatch &match, m_elfMatches)
     {
+        // the file's own header
+        if (match.m_offset == 0)
+            continue;
+
+        const char *fib = m_data + match.m_offset;
         try
         {
             AbstractElfHeader newHeader;
-            newHeader.setHeader(fib, fib - (m_mapped_file.data() + m_fileSize));
-            if ((fib + newHeader.getProgramOffset()) < (m_mapped_file.data() + m_fileSize))
+            newHeader.setHeader(fib, m_fileSize - match.m_offset);
+            if (newHeader.getProgramOffset() < m_fileSize - match.m_offset)
             {
                 std::stringstream binaryFound;
                 binaryFound << "Embedded ELF binary found at file offset 0x"
-                            << std::hex << fib - m_mapped_file.data()
-                            << " (" << std::dec << fib - m_mapped_file.data() << ")";
+                            << std::hex << m_baseOffset + match.m_offset
+                            << " (" << std::dec << m_baseOffset + match.m_offset << ")";
                 m_capabilities[elf::k_dropper].insert(binaryFound.str());
+                m_embeddedOffsets.push_back(match.m_offset);
             }
         }
         catch (std::exception &e)
@@ -504,18 +701,3 @@ void ELFParser::findELF()
         }
     }
 }
-
-void ELFParser::calcEntropy(off_t p_offset, std::size_t p_fileSize)
-{
-	// calculate entry entropy binary
-	unsigned char count;
-	unsigned int counted_bytes[256] = {};
-
-	for(std::size_t i = p_offset; i <= m_fileSize ; i++)
-	{
-			count = static_cast<unsigned char> (m_mapped_file.data()[i]);
-			counted_bytes[count]++;
-	}
-
-	m_entropy =  calcEntropyFunc(counted_bytes, m_fileSize);
-}
\ No newline at end of file
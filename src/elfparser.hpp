@@ -7,20 +7,23 @@
 #include "abstract_segments.hpp"
 #include "programheaders.hpp"
 #include "structures/capabilities.hpp"
-#include "datastructures/search_tree.hpp"
 #include "structures/elfheader.hpp"
-#include "datastructures/search_value.hpp"
+#include "datastructures/search_tree.hpp"
+#include "entropy_profile.hpp"
 
 #include <map>
 #include <utility>
 #include <vector>
 #include <string>
+#include <iostream>
 #include <boost/cstdint.hpp>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/foreach.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <boost/algorithm/string.hpp>
 
-class SearchValue;
+class SignatureSet;
+class RegexScanner;
 
 /* parses an ELF binary and computes a score that indicates how malicious
  * or dangerous the binary is. A lot of good information on parsing
@@ -67,11 +70,17 @@ private:
     // he size of the analyzed file
     std::size_t m_fileSize;
 
-    // he aho corasick search engine
-    SearchTree m_searchEngine;
+    // he bytes being parsed. the mapped file or a part of the parent's
+    const char* m_data;
+
+    // he offset of m_data in the file that was opened (0 unless carved)
+    std::size_t m_baseOffset;
 
-    // he ptr vector to hold the search engine values
-    boost::ptr_vector<SearchValue> m_searchValues;
+    // he shared, precompiled signatures to search the binary with
+    const SignatureSet& m_signatures;
+
+    // he regular expressions run over the binary (the default rules unless replaced)
+    const RegexScanner* m_regexScanner;
 
  	// he var entropy
 	double m_entropy;
@@ -83,10 +92,57 @@ private:
     uint16_t m_size;
     uint16_t m_pc;
 
-	// calc entropy general function
-	void calcEntropy(off_t p_offset, std::size_t p_fileSize);
+    // reads the file once to hash it, count its bytes and run the automata over it
+    void scanBytes();
+
+    // he digests parse() computes up front (a mask of Digest)
+    unsigned int m_digests;
+
+    // he digests of the file. computed on first use unless parse() already did
+    mutable std::string m_md5;
+    mutable std::string m_sha1;
+    mutable std::string m_sha256;
+
+    // he signatures found in the file (one match per signature)
+    std::vector<SearchMatch> m_signatureMatches;
+
+    // he ELF magic found in the file
+    std::vector<SearchMatch> m_elfMatches;
+
+    // he strings the regular expressions matched
+    std::map<elf::Capabilties, std::set<std::string> > m_regexCapabilities;
+
+    // why the regular expression scan stopped early. empty if it didn't
+    std::string m_regexError;
+
+    // he entropy of the sliding window, the sections and the segments
+    EntropyProfile m_entropyProfile;
+
+    // he offsets (from m_data) of the embedded ELF headers findELF() accepted
+    std::vector<std::size_t> m_embeddedOffsets;
+
+    // he embedded binaries carved out of this one
+    boost::ptr_vector<ELFParser> m_children;
 public:
 
+    // the digests that can be computed up front
+    enum Digest
+    {
+        k_md5 = 1,
+        k_sha1 = 2,
+        k_sha256 = 4,
+        k_allDigests = k_md5 | k_sha1 | k_sha256
+    };
+
+    // executable sections and segments this entropic (bits per byte) look packed
+    static const double k_packedEntropy;
+
+    // smaller executable sections and segments are too short to judge
+    static const std::size_t k_packedMinimumSize = 1024;
+
+    // files at least this big get each digest hashed on a thread of its own
+    static const std::size_t k_parallelDigestSize = 16 * 1024 * 1024;
+
     // oes nothing except default initialization of all members
     ELFParser();
 
@@ -101,22 +157,58 @@ public:
      */
     void parse(const std::string& p_file);
 
+    /* parses bytes that are already in memory, ie an ELF binary embedded in
+     * another one. nothing is copied, p_data has to outlive the parser.
+     *  p_data the start of the binary
+     *  p_size the number of bytes that belong to it
+     *  p_name what getFilename() returns
+     *  p_baseOffset the offset of p_data in the file it came from
+     */
+    void parse(const char* p_data, std::size_t p_size, const std::string& p_name,
+               std::size_t p_baseOffset);
+
     /* asks the various parsers to "score" their portion of the binary.
      * also, capabilities information is populated by the segments.
      */
     void evaluate();
 
+    /* selects the digests parse() computes while it reads the file. the
+     * others are computed (once) if their getter is called.
+     *  p_digests a mask of Digest. k_allDigests by default
+     */
+    void setDigests(unsigned int p_digests);
+
+    /* replaces the regular expressions run over the binary, ie to add rules
+     * of your own on top of RegexScanner::addDefaultRules(). must be called
+     * before parse().
+     *  p_scanner a compiled scanner. it must outlive the parser
+     */
+    void setRegexScanner(const RegexScanner& p_scanner);
+
+    /* changes the sliding window of the entropy profile. must be called
+     * before parse().
+     *  p_window the number of bytes in a window
+     *  p_stride the number of bytes between the start of two windows
+     */
+    void setEntropyWindow(std::size_t p_window, std::size_t p_stride);
+
+    /* displays the C++ symbol names demangled (the default) or as they are
+     * in the file. names are only demangled when they are printed.
+     *  p_demangle demangle or not
+     */
+    void setDemangle(bool p_demangle);
+
     // return the binaries score
     boost::uint32_t getScore() const;
 
-    // prints the various elf structures to standard out
-    void printAll() const;
+    // prints the various elf structures to p_stream (standard out by default)
+    void printAll(std::ostream& p_stream = std::cout) const;
 
-    // prints the scoring reasons to standard out
-    void printReasons() const;
+    // prints the scoring reasons to p_stream (standard out by default)
+    void printReasons(std::ostream& p_stream = std::cout) const;
 
-    // prints the binaries capabilities to standard out
-    void printCapabilities() const;
+    // prints the binaries capabilities to p_stream (standard out by default)
+    void printCapabilities(std::ostream& p_stream = std::cout) const;
 
     // return the file name that was just parsed
     std::string getFilename() const;
@@ -124,15 +216,18 @@ public:
     // return the size of the file in bytes
     std::size_t getFileSize() const;
 
-    // return sha1 of the file
+    // return sha1 of the file. computed on the first call if parse() didn't
     std::string getSha1() const;
 
-    // return sha256 of the file
+    // return sha256 of the file. computed on the first call if parse() didn't
     std::string getSha256() const;
 
-    // return md5 of the file
+    // return md5 of the file. computed on the first call if parse() didn't
     std::string getMD5() const;
 
+    // return the GNU build id in hex. empty if the binary has none
+    std::string getBuildId() const;
+
     // return the vector of scoring reasons
     const std::vector<std::pair<boost::int32_t, std::string> >& getReasons() const;
 
@@ -160,6 +255,33 @@ public:
 	// return a const entropy total binary
 	double getEntropy();
 
+    // return the entropy of the sliding window, the sections and the segments
+    const EntropyProfile& getEntropyProfile() const;
+
+    // prints the section and segment entropy to p_stream (standard out by default)
+    void printEntropy(std::ostream& p_stream = std::cout) const;
+
+    // return the bytes that were parsed
+    const char* getData() const;
+
+    // return the offset of the parsed bytes in the file that was opened
+    std::size_t getBaseOffset() const;
+
+    // return the offsets (from getData()) of the embedded ELF headers found by evaluate()
+    const std::vector<std::size_t>& getEmbeddedOffsets() const;
+
+    // adds a parser for an embedded binary. takes ownership of p_child
+    void addChild(ELFParser* p_child);
+
+    // return the parsers of the embedded binaries, ordered by offset
+    const boost::ptr_vector<ELFParser>& getChildren() const;
+
+    /* prints the score and family of the embedded binaries (and theirs) to
+     * p_stream (standard out by default)
+     *  p_indent the depth of this parser in the tree
+     */
+    void printChildren(std::ostream& p_stream = std::cout, std::size_t p_indent = 0) const;
+
 };
 
 #endif
@@ -0,0 +1,303 @@
+#include "entropy_profile.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+const std::size_t EntropyProfile::k_defaultWindow;
+const std::size_t EntropyProfile::k_defaultStride;
+
+EntropyProfile::EntropyProfile(std::size_t p_window, std::size_t p_stride) :
+    m_window(0),
+    m_stride(0),
+    m_table(),
+    m_ring(),
+    m_entered(),
+    m_left(),
+    m_total(0),
+    m_windows(),
+    m_ranges(),
+    m_prepared(false),
+    m_spans(),
+    m_rangeSpans(),
+    m_boundaries(),
+    m_nextBoundary(0),
+    m_piece(),
+    m_pieceBytes(),
+    m_pieceCounts(),
+    m_pieceStarts()
+{
+    setWindow(p_window, p_stride);
+}
+
+void EntropyProfile::setWindow(std::size_t p_window, std::size_t p_stride)
+{
+    if (p_window == 0 || p_stride == 0 || p_window > 0xffffffff)
+    {
+        throw std::runtime_error("Invalid entropy window");
+    }
+
+    m_window = p_window;
+    m_stride = p_stride;
+    m_ring.assign(m_window, 0);
+
+    // a window's counts always add up to m_window
+    m_table.assign(m_window + 1, 0.);
+    for (std::size_t i = 1; i <= m_window; ++i)
+    {
+        const double probability = static_cast<double>(i) / m_window;
+        m_table[i] = -probability * std::log2(probability);
+    }
+}
+
+void EntropyProfile::addRange(RangeKind p_kind, const std::string& p_name,
+                              boost::uint64_t p_offset, boost::uint64_t p_size,
+                              bool p_executable)
+{
+    Range range = { p_kind, p_name, p_offset, p_size, p_executable, 0. };
+    m_ranges.push_back(range);
+}
+
+void EntropyProfile::prepareRanges()
+{
+    m_prepared = true;
+
+    // the sizes come from the headers. don't let a bogus one wrap around
+    std::vector<std::pair<std::pair<boost::uint64_t, boost::uint64_t>, std::size_t> > sorted;
+    sorted.reserve(m_ranges.size());
+    for (std::size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        const Range& range(m_ranges[i]);
+        const boost::uint64_t end = range.m_size > ~range.m_offset ?
+                                    ~static_cast<boost::uint64_t>(0) :
+                                    range.m_offset + range.m_size;
+        sorted.push_back(std::make_pair(std::make_pair(range.m_offset, end), i));
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    m_rangeSpans.assign(m_ranges.size(), 0);
+    for (std::size_t i = 0; i < sorted.size(); ++i)
+    {
+        if (m_spans.empty() || m_spans.back() != sorted[i].first)
+        {
+            m_spans.push_back(sorted[i].first);
+            m_boundaries.push_back(sorted[i].first.first);
+            m_boundaries.push_back(sorted[i].first.second);
+        }
+        m_rangeSpans[sorted[i].second] = m_spans.size() - 1;
+    }
+    std::sort(m_boundaries.begin(), m_boundaries.end());
+    m_boundaries.erase(std::unique(m_boundaries.begin(), m_boundaries.end()), m_boundaries.end());
+    m_pieceStarts.assign(1, 0);
+}
+
+void EntropyProfile::consume(const unsigned char* p_block, std::size_t p_length,
+                             std::size_t p_offset)
+{
+    countRanges(p_block, p_length, p_offset);
+
+    while (p_length != 0)
+    {
+        // stop where the next window is complete
+        const boost::uint64_t windowEnd = nextWindowEnd();
+        const std::size_t length = static_cast<std::size_t>(
+            std::min<boost::uint64_t>(std::min(p_length, m_window), windowEnd - m_total));
+        slide(p_block, length);
+        p_block += length;
+        p_length -= length;
+
+        if (m_total == windowEnd)
+        {
+            m_windows.push_back(windowEntropy());
+        }
+    }
+}
+
+boost::uint64_t EntropyProfile::nextWindowEnd() const
+{
+    if (m_total < m_window)
+    {
+        return m_window;
+    }
+    return m_window + ((m_total - m_window) / m_stride + 1) * m_stride;
+}
+
+void EntropyProfile::slide(const unsigned char* p_data, std::size_t p_length)
+{
+    // the oldest bytes make room for the new ones once the window is full.
+    // they have to be counted before the new ones overwrite them
+    const boost::uint64_t end = m_total + p_length;
+    if (end > m_window)
+    {
+        const boost::uint64_t first = m_total > m_window ? m_total - m_window : 0;
+        countRing(first, static_cast<std::size_t>(end - m_window - first), m_left);
+    }
+
+    m_entered.add(p_data, p_length);
+
+    // copy the new bytes into the ring, wrapping around once at most
+    const std::size_t position = static_cast<std::size_t>(m_total % m_window);
+    const std::size_t head = std::min(p_length, m_window - position);
+    std::memcpy(&m_ring[position], p_data, head);
+    std::memcpy(&m_ring[0], p_data + head, p_length - head);
+    m_total = end;
+}
+
+void EntropyProfile::countRing(boost::uint64_t p_position, std::size_t p_length,
+                               ByteHistogram& p_histogram) const
+{
+    const std::size_t position = static_cast<std::size_t>(p_position % m_window);
+    const std::size_t head = std::min(p_length, m_window - position);
+    p_histogram.add(&m_ring[position], head);
+    p_histogram.add(&m_ring[0], p_length - head);
+}
+
+void EntropyProfile::countRanges(const unsigned char* p_block, std::size_t p_length,
+                                 std::size_t p_offset)
+{
+    if (!m_prepared)
+    {
+        prepareRanges();
+    }
+
+    const boost::uint64_t blockEnd = static_cast<boost::uint64_t>(p_offset) + p_length;
+    boost::uint64_t position = p_offset;
+    while (position < blockEnd)
+    {
+        if (m_nextBoundary < m_boundaries.size() && m_boundaries[m_nextBoundary] <= position)
+        {
+            // the first boundary starts the first piece, the others end one
+            if (m_nextBoundary != 0)
+            {
+                closePiece();
+            }
+            ++m_nextBoundary;
+            continue;
+        }
+
+        // bytes before the first boundary or past the last aren't in a range
+        if (m_nextBoundary == m_boundaries.size())
+        {
+            return;
+        }
+        if (m_nextBoundary == 0)
+        {
+            position = std::min(m_boundaries[0], blockEnd);
+            continue;
+        }
+
+        const boost::uint64_t end = std::min(m_boundaries[m_nextBoundary], blockEnd);
+        m_piece.add(p_block + (position - p_offset), static_cast<std::size_t>(end - position));
+        position = end;
+    }
+}
+
+void EntropyProfile::closePiece()
+{
+    if (m_piece.getTotal() != 0)
+    {
+        boost::uint64_t counts[256];
+        m_piece.getCounts(counts);
+        for (std::size_t i = 0; i < 256; ++i)
+        {
+            if (counts[i] != 0)
+            {
+                m_pieceBytes.push_back(static_cast<unsigned char>(i));
+                m_pieceCounts.push_back(counts[i]);
+            }
+        }
+        m_piece = ByteHistogram();
+    }
+    m_pieceStarts.push_back(m_pieceCounts.size());
+}
+
+void EntropyProfile::finish()
+{
+    boost::uint64_t counts[256];
+
+    // a file smaller than a window still gets one
+    if (m_windows.empty() && m_total != 0)
+    {
+        m_entered.getCounts(counts);
+        m_windows.push_back(HistogramConsumer::calcEntropy(counts, m_total));
+    }
+
+    if (!m_prepared)
+    {
+        prepareRanges();
+    }
+
+    // the pieces the file didn't reach are empty
+    while (m_pieceStarts.size() < m_boundaries.size())
+    {
+        closePiece();
+    }
+
+    std::vector<double> spanEntropy(m_spans.size(), 0.);
+    for (std::size_t i = 0; i < m_spans.size(); ++i)
+    {
+        const std::size_t first = std::lower_bound(m_boundaries.begin(), m_boundaries.end(),
+                                                   m_spans[i].first) - m_boundaries.begin();
+        const std::size_t last = std::lower_bound(m_boundaries.begin(), m_boundaries.end(),
+                                                  m_spans[i].second) - m_boundaries.begin();
+
+        std::fill(counts, counts + 256, 0);
+        boost::uint64_t total = 0;
+        for (std::size_t entry = m_pieceStarts[first]; entry < m_pieceStarts[last]; ++entry)
+        {
+            counts[m_pieceBytes[entry]] += m_pieceCounts[entry];
+            total += m_pieceCounts[entry];
+        }
+        spanEntropy[i] = HistogramConsumer::calcEntropy(counts, total);
+    }
+
+    for (std::size_t i = 0; i < m_ranges.size(); ++i)
+    {
+        m_ranges[i].m_entropy = spanEntropy[m_rangeSpans[i]];
+    }
+}
+
+double EntropyProfile::windowEntropy() const
+{
+    boost::uint64_t entered[256];
+    boost::uint64_t left[256];
+    m_entered.getCounts(entered);
+    m_left.getCounts(left);
+
+    double entropy = 0.;
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        entropy += m_table[entered[i] - left[i]];
+    }
+    return entropy;
+}
+
+std::size_t EntropyProfile::getWindowSize() const
+{
+    return m_window;
+}
+
+std::size_t EntropyProfile::getStride() const
+{
+    return m_stride;
+}
+
+const std::vector<double>& EntropyProfile::getWindows() const
+{
+    return m_windows;
+}
+
+double EntropyProfile::getMaxWindow() const
+{
+    if (m_windows.empty())
+    {
+        return 0.;
+    }
+    return *std::max_element(m_windows.begin(), m_windows.end());
+}
+
+const std::vector<EntropyProfile::Range>& EntropyProfile::getRanges() const
+{
+    return m_ranges;
+}
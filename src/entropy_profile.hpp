@@ -0,0 +1,175 @@
+#ifndef ENTROPY_PROFILE_HPP
+#define ENTROPY_PROFILE_HPP
+
+#include "byte_pipeline.hpp"
+#include "byte_histogram.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+/*
+ * The entropy of the whole file is one number, it can't point at the packed
+ * or encrypted part of a binary. EntropyProfile is fed the file by the
+ * BytePipeline and, in that same pass, computes:
+ *
+ *  - the entropy of a window sliding over the file. the window's counts are
+ *    the counts of the bytes that entered it minus the counts of the bytes
+ *    that left it, and its entropy is summed from a table of p * log2(p) for
+ *    every count the window can hold.
+ *  - the entropy of any number of ranges (ie, the sections and segments).
+ *    the starts and ends of the ranges cut the file into disjoint pieces,
+ *    one shared histogram counts the piece being read and keeps only its non
+ *    zero counts. a range's counts are the sum of its pieces', added up by
+ *    finish(). ranges covering the same bytes are only summed once.
+ *
+ * All of the counting goes through ByteHistogram.
+ */
+class EntropyProfile : public ByteConsumer
+{
+public:
+
+    // the default number of bytes in a window
+    static const std::size_t k_defaultWindow = 4096;
+
+    // the default number of bytes between the start of two windows
+    static const std::size_t k_defaultStride = 1024;
+
+    // what a range is
+    enum RangeKind
+    {
+        k_section,
+        k_segment
+    };
+
+    // a part of the file the entropy is computed for
+    struct Range
+    {
+        RangeKind m_kind;
+        std::string m_name;
+        boost::uint64_t m_offset;
+        boost::uint64_t m_size;
+        bool m_executable;
+
+        // bits per byte. computed by finish()
+        double m_entropy;
+    };
+
+    /*
+     * p_window the number of bytes in a window
+     * p_stride the number of bytes between the start of two windows
+     */
+    explicit EntropyProfile(std::size_t p_window = k_defaultWindow,
+                            std::size_t p_stride = k_defaultStride);
+
+    /*
+     * changes the window. must be called before the pipeline runs
+     * p_window the number of bytes in a window. at least 1
+     * p_stride the number of bytes between the start of two windows. at least 1
+     */
+    void setWindow(std::size_t p_window, std::size_t p_stride);
+
+    /*
+     * adds a range to compute the entropy of. must be called before the
+     * pipeline runs. the part past the end of the file is ignored.
+     */
+    void addRange(RangeKind p_kind, const std::string& p_name, boost::uint64_t p_offset,
+                  boost::uint64_t p_size, bool p_executable);
+
+    virtual void consume(const unsigned char* p_block, std::size_t p_length, std::size_t p_offset);
+
+    virtual void finish();
+
+    // return the number of bytes in a window
+    std::size_t getWindowSize() const;
+
+    // return the number of bytes between the start of two windows
+    std::size_t getStride() const;
+
+    /*
+     * return the entropy of every window. window i starts at i * getStride().
+     * a file smaller than a window gets one window covering all of it.
+     */
+    const std::vector<double>& getWindows() const;
+
+    // return the highest window entropy. 0 for an empty file
+    double getMaxWindow() const;
+
+    // return the ranges in the order they were added
+    const std::vector<Range>& getRanges() const;
+
+private:
+
+    // sorts the boundaries of the ranges and merges the ranges that cover the same bytes
+    void prepareRanges();
+
+    // counts the bytes of p_block into the pieces between the range boundaries
+    void countRanges(const unsigned char* p_block, std::size_t p_length, std::size_t p_offset);
+
+    // keeps the counts of the piece that just ended and starts the next one
+    void closePiece();
+
+    // moves the window p_length (at most m_window) bytes forward
+    void slide(const unsigned char* p_data, std::size_t p_length);
+
+    // counts the p_length bytes of m_ring that were at p_position in the file
+    void countRing(boost::uint64_t p_position, std::size_t p_length, ByteHistogram& p_histogram) const;
+
+    // return m_total once the next window is complete
+    boost::uint64_t nextWindowEnd() const;
+
+    // return the entropy of the current window
+    double windowEntropy() const;
+
+private:
+
+    std::size_t m_window;
+    std::size_t m_stride;
+
+    // -p * log2(p) for p = count / m_window, indexed by count
+    std::vector<double> m_table;
+
+    // the last m_window bytes, so the bytes leaving the window are known. the
+    // byte at file offset n is at n % m_window
+    std::vector<unsigned char> m_ring;
+
+    // the bytes that entered and left the window
+    ByteHistogram m_entered;
+    ByteHistogram m_left;
+
+    // the number of bytes seen so far
+    boost::uint64_t m_total;
+
+    std::vector<double> m_windows;
+
+    std::vector<Range> m_ranges;
+
+    // set once the range boundaries are sorted
+    bool m_prepared;
+
+    // the first byte and one past the last byte of every distinct range
+    std::vector<std::pair<boost::uint64_t, boost::uint64_t> > m_spans;
+
+    // the span of each range
+    std::vector<std::size_t> m_rangeSpans;
+
+    // the sorted starts and ends of the spans. piece i is the bytes from
+    // m_boundaries[i] up to m_boundaries[i + 1]
+    std::vector<boost::uint64_t> m_boundaries;
+
+    // the index of the next boundary the bytes reach
+    std::size_t m_nextBoundary;
+
+    // the byte counts of the piece being read
+    ByteHistogram m_piece;
+
+    // the non zero counts of the finished pieces, back to back. piece i has
+    // the entries from m_pieceStarts[i] up to m_pieceStarts[i + 1]
+    std::vector<unsigned char> m_pieceBytes;
+    std::vector<boost::uint64_t> m_pieceCounts;
+    std::vector<std::size_t> m_pieceStarts;
+};
+
+#endif
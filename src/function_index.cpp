@@ -0,0 +1,517 @@
+#include "function_index.hpp"
+#include "abstract_segments.hpp"
+#include "structures/eh_frame.hpp"
+#include "elf_view.hpp"
+
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <boost/foreach.hpp>
+#include <boost/utility/string_view.hpp>
+
+namespace
+{
+    // more entries than this means the table is garbage
+    const std::size_t k_maxEntries = 0x100000;
+
+    /*
+     * reads the fields of the unwind tables, in [offset, end) of the file. it
+     * knows the address of what it reads for the pc relative pointers. once a
+     * read runs past the end every read fails and returns 0
+     */
+    template <typename Class, typename Order>
+    class Reader
+    {
+    public:
+
+        Reader(const char* p_data, boost::uint64_t p_offset, boost::uint64_t p_end, boost::uint64_t p_address) :
+            m_data(p_data),
+            m_offset(p_offset),
+            m_end(p_end),
+            m_address(p_address),
+            m_good(p_offset <= p_end)
+        {
+        }
+
+        boost::uint64_t getOffset() const { return m_offset; }
+        boost::uint64_t getAddress() const { return m_address; }
+        bool good() const { return m_good; }
+
+        bool skip(boost::uint64_t p_count)
+        {
+            if (!m_good || p_count > m_end - m_offset)
+            {
+                m_good = false;
+                return false;
+            }
+            m_offset += p_count;
+            m_address += p_count;
+            return true;
+        }
+
+        template <typename Value>
+        Value read()
+        {
+            Value value = 0;
+            if (skip(sizeof(Value)))
+            {
+                std::memcpy(&value, m_data + m_offset - sizeof(Value), sizeof(Value));
+            }
+            return Order::get(value);
+        }
+
+        boost::uint64_t readUleb()
+        {
+            boost::uint64_t value = 0;
+            for (unsigned int shift = 0; m_good; shift += 7)
+            {
+                const boost::uint8_t byte = read<boost::uint8_t>();
+                if (shift < 64)
+                {
+                    value |= static_cast<boost::uint64_t>(byte & 0x7f) << shift;
+                }
+                if ((byte & 0x80) == 0)
+                {
+                    break;
+                }
+            }
+            return value;
+        }
+
+        boost::int64_t readSleb()
+        {
+            boost::uint64_t value = 0;
+            for (unsigned int shift = 0; m_good; shift += 7)
+            {
+                const boost::uint8_t byte = read<boost::uint8_t>();
+                if (shift < 64)
+                {
+                    value |= static_cast<boost::uint64_t>(byte & 0x7f) << shift;
+                }
+                if ((byte & 0x80) == 0)
+                {
+                    if (shift + 7 < 64 && (byte & 0x40))
+                    {
+                        value |= ~0ULL << (shift + 7);
+                    }
+                    break;
+                }
+            }
+            return static_cast<boost::int64_t>(value);
+        }
+
+        boost::string_view readString()
+        {
+            const char* start = m_data + m_offset;
+            const char* terminator = m_good ?
+                static_cast<const char*>(std::memchr(start, 0, m_end - m_offset)) : NULL;
+            if (terminator == NULL)
+            {
+                m_good = false;
+                return boost::string_view();
+            }
+            skip(terminator - start + 1);
+            return boost::string_view(start, terminator - start);
+        }
+
+        /*
+         * reads a pointer encoded with p_encoding. p_dataRelative is what a
+         * DW_EH_PE_datarel pointer is relative to. an indirect pointer is
+         * returned as the address it is at
+         * return false if it can't be resolved from the file alone
+         */
+        bool readPointer(boost::uint8_t p_encoding, boost::uint64_t p_dataRelative, boost::uint64_t& p_value)
+        {
+            const boost::uint64_t field = m_address;
+            switch (p_encoding & elf::eh::k_formatMask)
+            {
+                case elf::eh::k_absptr:
+                    p_value = read<typename Class::address>();
+                    break;
+                case elf::eh::k_uleb128:
+                    p_value = readUleb();
+                    break;
+                case elf::eh::k_udata2:
+                    p_value = read<boost::uint16_t>();
+                    break;
+                case elf::eh::k_udata4:
+                    p_value = read<boost::uint32_t>();
+                    break;
+                case elf::eh::k_udata8:
+                case elf::eh::k_sdata8:
+                    p_value = read<boost::uint64_t>();
+                    break;
+                case elf::eh::k_sleb128:
+                    p_value = readSleb();
+                    break;
+                case elf::eh::k_sdata2:
+                    p_value = static_cast<boost::int16_t>(read<boost::uint16_t>());
+                    break;
+                case elf::eh::k_sdata4:
+                    p_value = static_cast<boost::int32_t>(read<boost::uint32_t>());
+                    break;
+                default:
+                    m_good = false;
+                    return false;
+            }
+
+            switch (p_encoding & elf::eh::k_applicationMask)
+            {
+                case 0:
+                    break;
+                case elf::eh::k_pcrel:
+                    p_value += field;
+                    break;
+                case elf::eh::k_datarel:
+                    p_value += p_dataRelative;
+                    break;
+                default:
+                    return false;
+            }
+
+            if (!Class::k_is64)
+            {
+                p_value &= 0xffffffff;
+            }
+            return m_good;
+        }
+
+        // return the size of a pointer encoded with p_encoding. 0 if it varies
+        static std::size_t getSize(boost::uint8_t p_encoding)
+        {
+            switch (p_encoding & elf::eh::k_formatMask)
+            {
+                case elf::eh::k_absptr:
+                    return sizeof(typename Class::address);
+                case elf::eh::k_udata2:
+                case elf::eh::k_sdata2:
+                    return 2;
+                case elf::eh::k_udata4:
+                case elf::eh::k_sdata4:
+                    return 4;
+                case elf::eh::k_udata8:
+                case elf::eh::k_sdata8:
+                    return 8;
+                default:
+                    return 0;
+            }
+        }
+
+    private:
+
+        const char* m_data;
+        boost::uint64_t m_offset;
+        boost::uint64_t m_end;
+        boost::uint64_t m_address;
+        bool m_good;
+    };
+
+    bool startsBefore(const FunctionIndex::Function& p_lhs, const FunctionIndex::Function& p_rhs)
+    {
+        return p_lhs.m_start < p_rhs.m_start;
+    }
+}
+
+FunctionIndex::FunctionIndex() :
+    m_functions(),
+    m_cies()
+{
+}
+
+FunctionIndex::~FunctionIndex()
+{
+}
+
+void FunctionIndex::createIndex(const char* p_data, boost::uint64_t p_dataSize, const AbstractSegments& p_segments,
+                                boost::uint64_t p_hdrAddress, boost::uint64_t p_ehFrameAddress,
+                                boost::uint64_t p_ehFrameSize, bool p_is64, bool p_isLE)
+{
+    m_functions.clear();
+    m_cies.clear();
+
+    const boost::uint64_t hdr = p_hdrAddress != 0 ? p_segments.getOffsetFromVirt(p_hdrAddress) : 0;
+    elf::view::dispatch(p_is64, p_isLE, [&](auto p_class, auto p_order)
+    {
+        typedef decltype(p_class) Class;
+        typedef decltype(p_order) Order;
+
+        boost::uint64_t ehFrame = p_ehFrameAddress;
+        if (hdr != 0 && readTable<Class, Order>(p_data, p_dataSize, p_segments, hdr, p_hdrAddress, ehFrame))
+        {
+            return;
+        }
+
+        const boost::uint64_t offset = ehFrame != 0 ? p_segments.getOffsetFromVirt(ehFrame) : 0;
+        if (offset != 0)
+        {
+            readEhFrame<Class, Order>(p_data, p_dataSize, offset, ehFrame, p_ehFrameSize);
+        }
+    });
+
+    // the table is sorted already, .eh_frame usually is
+    if (!std::is_sorted(m_functions.begin(), m_functions.end(), startsBefore))
+    {
+        std::sort(m_functions.begin(), m_functions.end(), startsBefore);
+    }
+
+    // only needed while reading
+    m_cies.clear();
+}
+
+template <typename Class, typename Order>
+bool FunctionIndex::readTable(const char* p_data, boost::uint64_t p_dataSize, const AbstractSegments& p_segments,
+                              boost::uint64_t p_hdrOffset, boost::uint64_t p_hdrAddress,
+                              boost::uint64_t& p_ehFrameAddress)
+{
+    // version, then the encodings of the .eh_frame pointer, the count and the table
+    Reader<Class, Order> reader(p_data, p_hdrOffset, p_dataSize, p_hdrAddress);
+    const boost::uint8_t version = reader.template read<boost::uint8_t>();
+    const boost::uint8_t ehFrameEncoding = reader.template read<boost::uint8_t>();
+    const boost::uint8_t countEncoding = reader.template read<boost::uint8_t>();
+    const boost::uint8_t tableEncoding = reader.template read<boost::uint8_t>();
+    if (!reader.good() || version != elf::eh::k_hdrVersion)
+    {
+        return false;
+    }
+
+    boost::uint64_t ehFrame = 0;
+    if (ehFrameEncoding != elf::eh::k_omit &&
+        reader.readPointer(ehFrameEncoding, p_hdrAddress, ehFrame) && p_ehFrameAddress == 0)
+    {
+        p_ehFrameAddress = ehFrame;
+    }
+
+    // the entries have to be the same size to be searchable
+    boost::uint64_t count = 0;
+    const std::size_t entrySize = Reader<Class, Order>::getSize(tableEncoding) * 2;
+    if (countEncoding == elf::eh::k_omit || tableEncoding == elf::eh::k_omit || entrySize == 0 ||
+        !reader.readPointer(countEncoding, p_hdrAddress, count) || count == 0 || count > k_maxEntries ||
+        count > (p_dataSize - reader.getOffset()) / entrySize)
+    {
+        return false;
+    }
+
+    // the start of every function and the address of its FDE
+    m_functions.reserve(count);
+    for (boost::uint64_t i = 0; i < count; ++i)
+    {
+        boost::uint64_t start = 0;
+        boost::uint64_t fde = 0;
+        if (!reader.readPointer(tableEncoding, p_hdrAddress, start) ||
+            !reader.readPointer(tableEncoding, p_hdrAddress, fde))
+        {
+            break;
+        }
+
+        const boost::uint64_t offset = p_segments.getOffsetFromVirt(fde);
+        if (offset != 0)
+        {
+            readEntry<Class, Order>(p_data, p_dataSize, offset, fde);
+        }
+    }
+    return true;
+}
+
+template <typename Class, typename Order>
+void FunctionIndex::readEhFrame(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset,
+                                boost::uint64_t p_address, boost::uint64_t p_size)
+{
+    // the program headers aren't checked against the file, the offset may be past it
+    if (p_offset >= p_dataSize)
+    {
+        return;
+    }
+
+    // without a size the terminator or the end of the file stops the walk
+    const boost::uint64_t end = p_offset + std::min(p_size != 0 ? p_size : p_dataSize - p_offset,
+                                                    p_dataSize - p_offset);
+    boost::uint64_t offset = p_offset;
+    for (std::size_t i = 0; offset != 0 && offset < end && i < k_maxEntries; ++i)
+    {
+        const boost::uint64_t next = readEntry<Class, Order>(p_data, end, offset, p_address + (offset - p_offset));
+        offset = next;
+    }
+}
+
+template <typename Class, typename Order>
+boost::uint64_t FunctionIndex::readEntry(const char* p_data, boost::uint64_t p_dataSize,
+                                         boost::uint64_t p_offset, boost::uint64_t p_address)
+{
+    // the length, then the CIE id (0) or the distance back to the CIE of the FDE
+    Reader<Class, Order> reader(p_data, p_offset, p_dataSize, p_address);
+    boost::uint64_t length = reader.template read<boost::uint32_t>();
+    const bool extended = length == elf::eh::k_extendedLength;
+    if (extended)
+    {
+        length = reader.template read<boost::uint64_t>();
+    }
+
+    const boost::uint64_t start = reader.getOffset();
+    const boost::uint64_t idAddress = reader.getAddress();
+    if (!reader.good() || length == 0 || length > p_dataSize - start)
+    {
+        return 0;
+    }
+    const boost::uint64_t next = start + length;
+
+    const boost::uint64_t id = extended ? reader.template read<boost::uint64_t>() :
+                                          reader.template read<boost::uint32_t>();
+    if (id == 0)
+    {
+        getCie<Class, Order>(p_data, p_dataSize, p_offset, p_address);
+        return next;
+    }
+    if (id > start)
+    {
+        return next;
+    }
+
+    // pc_begin in the encoding of the CIE, pc_range with the same format
+    const Cie& cie = getCie<Class, Order>(p_data, p_dataSize, start - id, idAddress - id);
+    Reader<Class, Order> body(p_data, reader.getOffset(), next, reader.getAddress());
+    Function function;
+    if (cie.m_valid &&
+        body.readPointer(cie.m_encoding, 0, function.m_start) &&
+        body.readPointer(cie.m_encoding & elf::eh::k_formatMask, 0, function.m_size) &&
+        function.m_size != 0)
+    {
+        m_functions.push_back(function);
+    }
+    return next;
+}
+
+template <typename Class, typename Order>
+const FunctionIndex::Cie& FunctionIndex::getCie(const char* p_data, boost::uint64_t p_dataSize,
+                                                boost::uint64_t p_offset, boost::uint64_t p_address)
+{
+    std::map<boost::uint64_t, Cie>::iterator it = m_cies.find(p_offset);
+    if (it != m_cies.end())
+    {
+        return it->second;
+    }
+
+    Cie& cie = m_cies[p_offset];
+    cie.m_valid = false;
+    cie.m_encoding = elf::eh::k_absptr;
+
+    Reader<Class, Order> reader(p_data, p_offset, p_dataSize, p_address);
+    boost::uint64_t length = reader.template read<boost::uint32_t>();
+    const bool extended = length == elf::eh::k_extendedLength;
+    if (extended)
+    {
+        length = reader.template read<boost::uint64_t>();
+    }
+    if (!reader.good() || length == 0 || length > p_dataSize - reader.getOffset())
+    {
+        return cie;
+    }
+
+    // id, version, augmentation, code and data alignment, return register
+    Reader<Class, Order> body(p_data, reader.getOffset(), reader.getOffset() + length, reader.getAddress());
+    const boost::uint64_t id = extended ? body.template read<boost::uint64_t>() :
+                                          body.template read<boost::uint32_t>();
+    const boost::uint8_t version = body.template read<boost::uint8_t>();
+    const boost::string_view augmentation(body.readString());
+    body.readUleb();
+    body.readSleb();
+    if (version == 1)
+    {
+        body.template read<boost::uint8_t>();
+    }
+    else
+    {
+        body.readUleb();
+    }
+    if (!body.good() || id != 0)
+    {
+        return cie;
+    }
+
+    // the augmentation data is only understood if it starts with 'z'
+    if (!augmentation.empty())
+    {
+        if (augmentation[0] != 'z')
+        {
+            return cie;
+        }
+
+        body.readUleb();
+        for (std::size_t i = 1; i < augmentation.size() && body.good(); ++i)
+        {
+            if (augmentation[i] == 'R')
+            {
+                cie.m_encoding = body.template read<boost::uint8_t>();
+            }
+            else if (augmentation[i] == 'P')
+            {
+                boost::uint64_t personality = 0;
+                body.readPointer(body.template read<boost::uint8_t>(), 0, personality);
+            }
+            else if (augmentation[i] == 'L')
+            {
+                body.template read<boost::uint8_t>();
+            }
+            else if (augmentation[i] != 'S' && augmentation[i] != 'B' && augmentation[i] != 'G')
+            {
+                // whatever follows can't be read, but the encoding may be known by now
+                break;
+            }
+        }
+    }
+    cie.m_valid = body.good();
+    return cie;
+}
+
+const std::vector<FunctionIndex::Function>& FunctionIndex::getFunctions() const
+{
+    return m_functions;
+}
+
+const FunctionIndex::Function* FunctionIndex::find(boost::uint64_t p_address) const
+{
+    // the first function past p_address. the one before it may hold it
+    Function key;
+    key.m_start = p_address;
+    key.m_size = 0;
+    std::vector<Function>::const_iterator it =
+        std::upper_bound(m_functions.begin(), m_functions.end(), key, startsBefore);
+    if (it == m_functions.begin() || p_address - (it - 1)->m_start >= (it - 1)->m_size)
+    {
+        return NULL;
+    }
+    return &*(it - 1);
+}
+
+std::string FunctionIndex::printToStdOut(const AbstractSegments& p_segments) const
+{
+    std::stringstream returnValue;
+    std::stringstream functions;
+    std::size_t unnamed = 0;
+    BOOST_FOREACH (const Function& function, m_functions)
+    {
+        std::string name(p_segments.findSymbol(function.m_start));
+        if (name.empty())
+        {
+            name = p_segments.getDynamicSymbols().findSymbol(function.m_start);
+        }
+
+        functions << "\t start= 0x" << std::hex << function.m_start << std::dec
+                  << ", size= " << function.m_size;
+        if (name.empty())
+        {
+            ++unnamed;
+        }
+        else
+        {
+            functions << ", name= " << name;
+        }
+        functions << std::endl;
+    }
+
+    if (!m_functions.empty())
+    {
+        returnValue << "Functions (count=" << m_functions.size() << ", unnamed=" << unnamed << ")\n";
+        returnValue << functions.str();
+    }
+    return returnValue.str();
+}
@@ -0,0 +1,105 @@
+#ifndef FUNCTION_INDEX_HPP
+#define FUNCTION_INDEX_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+class AbstractSegments;
+
+/*
+ * The functions the unwind tables describe. Every function the compiler
+ * emitted unwind information for has an FDE in .eh_frame, and the linker
+ * sorts them by start address into the table of .eh_frame_hdr
+ * (PT_GNU_EH_FRAME). Stripping leaves both alone, so on a stripped binary
+ * this is the cheapest way to find where the functions are.
+ *
+ * The FDEs are read through the sorted table. If there is no table, .eh_frame
+ * is walked instead. The result is a sorted vector of address ranges, so
+ * finding the function an address is in is a binary search.
+ */
+class FunctionIndex
+{
+public:
+
+    struct Function
+    {
+        boost::uint64_t m_start;
+        boost::uint64_t m_size;
+    };
+
+    FunctionIndex();
+    ~FunctionIndex();
+
+    /*
+     * reads the FDEs
+     * p_data the start of the file
+     * p_dataSize the size of the file
+     * p_segments translates the addresses of the tables
+     * p_hdrAddress the address of .eh_frame_hdr. 0 if there is none
+     * p_ehFrameAddress the address of .eh_frame, used if .eh_frame_hdr has
+     * no table. 0 to take it from .eh_frame_hdr
+     * p_ehFrameSize the size of .eh_frame. 0 if it isn't known
+     */
+    void createIndex(const char* p_data, boost::uint64_t p_dataSize, const AbstractSegments& p_segments,
+                     boost::uint64_t p_hdrAddress, boost::uint64_t p_ehFrameAddress,
+                     boost::uint64_t p_ehFrameSize, bool p_is64, bool p_isLE);
+
+    // return the functions, sorted by start address
+    const std::vector<Function>& getFunctions() const;
+
+    // return the function p_address is in. NULL if there is none
+    const Function* find(boost::uint64_t p_address) const;
+
+    /*
+     * p_segments names the functions the symbol tables know
+     * return the string representation of the functions
+     */
+    std::string printToStdOut(const AbstractSegments& p_segments) const;
+
+private:
+
+    // disable evil things
+    FunctionIndex(const FunctionIndex& p_rhs);
+    FunctionIndex& operator=(const FunctionIndex& p_rhs);
+
+    // how the FDEs that point at a CIE encode their addresses
+    struct Cie
+    {
+        bool m_valid;
+        boost::uint8_t m_encoding;
+    };
+
+    // reads the FDEs in the sorted table of .eh_frame_hdr. false if it has none
+    template <typename Class, typename Order>
+    bool readTable(const char* p_data, boost::uint64_t p_dataSize, const AbstractSegments& p_segments,
+                   boost::uint64_t p_hdrOffset, boost::uint64_t p_hdrAddress,
+                   boost::uint64_t& p_ehFrameAddress);
+
+    // reads the FDEs of .eh_frame one after the other
+    template <typename Class, typename Order>
+    void readEhFrame(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset,
+                     boost::uint64_t p_address, boost::uint64_t p_size);
+
+    /*
+     * reads the CIE or FDE at p_offset. FDEs are added to m_functions
+     * return the offset of the next entry. 0 at the terminator or if the entry
+     * is broken
+     */
+    template <typename Class, typename Order>
+    boost::uint64_t readEntry(const char* p_data, boost::uint64_t p_dataSize,
+                              boost::uint64_t p_offset, boost::uint64_t p_address);
+
+    // return the CIE at p_offset, read if it hasn't been yet
+    template <typename Class, typename Order>
+    const Cie& getCie(const char* p_data, boost::uint64_t p_dataSize,
+                      boost::uint64_t p_offset, boost::uint64_t p_address);
+
+    std::vector<Function> m_functions;
+
+    // the CIEs read so far, by file offset
+    std::map<boost::uint64_t, Cie> m_cies;
+};
+
+#endif
@@ -5,15 +5,53 @@
 
 #include "version.hpp"
 #include "elfparser.hpp"
+#include "batch_scanner.hpp"
+#include "elf_carver.hpp"
 
 #ifdef QT_GUI
 #include "ui/mainwindow.hpp"
 #include <QApplication>
 #endif
 
+/*
+ * turns a comma separated list of digest names into a mask of ELFParser::Digest
+ * p_list the list from the command line
+ * p_digests the resulting mask
+ * return false if a name isn't known
+ */
+bool parseDigests(const std::string &p_list, unsigned int &p_digests)
+{
+    std::vector<std::string> names;
+    boost::split(names, p_list, boost::is_any_of(","));
+
+    p_digests = 0;
+    BOOST_FOREACH (std::string &name, names)
+    {
+        boost::trim(name);
+        boost::to_lower(name);
+        if (name == "md5")
+            p_digests |= ELFParser::k_md5;
+        else if (name == "sha1")
+            p_digests |= ELFParser::k_sha1;
+        else if (name == "sha256")
+            p_digests |= ELFParser::k_sha256;
+        else if (name == "all")
+            p_digests |= ELFParser::k_allDigests;
+        else if (name != "none")
+            return false;
+    }
+    return true;
+}
+
 bool parseCommandLine(int p_argCount, char *p_argArray[],
                       std::string &p_file, std::string &p_directory,
-                      bool &p_print, bool &p_printReasons, bool &p_capabilities)
+                      bool &p_print, bool &p_printReasons, bool &p_capabilities,
+                      std::size_t &p_jobs, bool &p_ordered,
+                      bool &p_failFast, std::string &p_checkpoint,
+                      unsigned int &p_digests, bool &p_printEntropy,
+                      std::size_t &p_entropyWindow, std::size_t &p_entropyStride,
+                      bool &p_carve, std::size_t &p_carveDepth, boost::uint64_t &p_carveBytes,
+                      bool &p_demangle)
 {
     boost::program_options::options_description description("options");
     description.add_options()
@@ -21,6 +59,18 @@ bool parseCommandLine(int p_argCount, char *p_argArray[],
     ("version", "Display version information")
     ("file,f", boost::program_options::value<std::string>(), "The ELF file to examine")
     ("directory,d", boost::program_options::value<std::string>(), "The directory to look through.")
+    ("jobs,j", boost::program_options::value<std::size_t>(), "The number of files to scan in parallel when looking through a directory (0 uses every core)")
+    ("unordered,u", "Print the directory results as they finish instead of in directory order")
+    ("fail-fast", "Stop looking through the directory at the first file that fails to parse")
+    ("checkpoint", boost::program_options::value<std::string>(), "Record the finished files in this file and skip the ones it already lists")
+    ("digests", boost::program_options::value<std::string>(), "Comma separated digests to compute: md5, sha1, sha256, all or none (default all)")
+    ("entropy,e", "Print the entropy of the sections and segments")
+    ("entropy-window", boost::program_options::value<std::size_t>(), "The size of the sliding entropy window in bytes (default 4096)")
+    ("entropy-stride", boost::program_options::value<std::size_t>(), "The distance between two entropy windows in bytes (default 1024)")
+    ("carve", "Carve out, score and report the embedded ELF binaries")
+    ("carve-depth", boost::program_options::value<std::size_t>(), "How deep embedded binaries can be nested and still get carved (default 4)")
+    ("carve-bytes", boost::program_options::value<boost::uint64_t>(), "The number of bytes carved out of a single file at most (default 256MB)")
+    ("no-demangle", "Print the C++ symbol names as they are in the file")
     ("reasons,r", "Print the scoring reasons")
     ("capabilities,c", "Print the files observed capabilities")
     ("print,p", "Print the ELF files various parsed structures.");
@@ -53,6 +103,41 @@ bool parseCommandLine(int p_argCount, char *p_argArray[],
     p_print = argv_map.count("print") != 0;
     p_printReasons = argv_map.count("reasons") != 0;
     p_capabilities = argv_map.count("capabilities") != 0;
+    p_ordered = argv_map.count("unordered") == 0;
+    p_failFast = argv_map.count("fail-fast") != 0;
+    p_printEntropy = argv_map.count("entropy") != 0;
+    p_carve = argv_map.count("carve") != 0;
+    p_demangle = argv_map.count("no-demangle") == 0;
+
+    if (argv_map.count("carve-depth"))
+        p_carveDepth = argv_map["carve-depth"].as<std::size_t>();
+
+    if (argv_map.count("carve-bytes"))
+        p_carveBytes = argv_map["carve-bytes"].as<boost::uint64_t>();
+
+    if (argv_map.count("entropy-window"))
+        p_entropyWindow = argv_map["entropy-window"].as<std::size_t>();
+
+    if (argv_map.count("entropy-stride"))
+        p_entropyStride = argv_map["entropy-stride"].as<std::size_t>();
+
+    if (p_entropyWindow == 0 || p_entropyStride == 0 || p_entropyWindow > 0xffffffff)
+    {
+        std::cerr << "The entropy window and stride must be between 1 and 4294967295" << std::endl;
+        return false;
+    }
+
+    if (argv_map.count("checkpoint"))
+        p_checkpoint.assign(argv_map["checkpoint"].as<std::string>());
+
+    if (argv_map.count("digests") && !parseDigests(argv_map["digests"].as<std::string>(), p_digests))
+    {
+        std::cerr << "Unknown digest in " << argv_map["digests"].as<std::string>() << std::endl;
+        return false;
+    }
+
+    if (argv_map.count("jobs"))
+        p_jobs = argv_map["jobs"].as<std::size_t>();
 
     if (argv_map.count("file") && argv_map.count("directory"))
     {
@@ -76,48 +161,21 @@ bool parseCommandLine(int p_argCount, char *p_argArray[],
 
 /*
  * pass the file to the parser and print the score if an error doesn't
- * occur. print other output based on passed in bools.
+ * occur. what else gets printed depends on how the scanner is configured.
  * p_fileName the file to parse
- * p_printReasons indicates if we should print the score reasons
- * p_printCapabilities print extra knowledge about the binary
- * p_printELF print the various data structures we parse
+ * p_scanner the configured scanner
  */
-void do_parsing(const std::string &p_fileName, bool p_printReasons,
-                bool p_printCapabilities, bool p_printELF)
+void do_parsing(const std::string &p_fileName, const BatchScanner &p_scanner)
 {
-    ELFParser parser;
-
     try
     {
-        parser.parse(p_fileName);
+        p_scanner.scanFile(p_fileName, std::cout);
     }
     catch (const std::exception &e)
     {
         std::cerr << "Error in parsing " << p_fileName << ": " << e.what() << std::endl;
         exit(EXIT_FAILURE);
     }
-
-    parser.evaluate();
-
-    std::cout << "Overview : " << std::endl <<  
-    " - Score: " << parser.getScore() << std::endl << 
-    " - Entropy: " << parser.getEntropy() << std::endl;
-    if (!parser.getFamily().empty())
-    {
-        std::cout <<" - Family: " << parser.getFamily() << std::endl;
-        std::cout <<" - SHA256: " << std::hex << parser.getSha256() << std::endl;
-        std::cout <<" - SHA1:   " << std::hex << parser.getSha1() << std::endl;
-        std::cout <<" - MD5:    " << std::hex << parser.getMD5() << std::endl;
-        
-    }
-    if (p_printReasons)
-        parser.printReasons();
-
-    if (p_printCapabilities)
-        parser.printCapabilities();
-
-    if (p_printELF)
-        parser.printAll();
 }
 
 #ifdef QT_GUI
@@ -136,20 +194,54 @@ int main(int p_argCount, char *p_argArray[])
     bool printElf = false;
     bool printReasons = false;
     bool printCapabilities = false;
+    bool ordered = true;
+    bool failFast = false;
+    std::size_t jobs = 1;
+    std::string checkpoint;
+    unsigned int digests = ELFParser::k_allDigests;
+    bool printEntropy = false;
+    std::size_t entropyWindow = EntropyProfile::k_defaultWindow;
+    std::size_t entropyStride = EntropyProfile::k_defaultStride;
+    bool carve = false;
+    std::size_t carveDepth = ElfCarver::k_defaultMaxDepth;
+    boost::uint64_t carveBytes = ElfCarver::k_defaultMaxBytes;
+    bool demangle = true;
     std::string fileName;
     std::string directoryName;
 
-    if (!parseCommandLine(p_argCount, p_argArray, fileName, directoryName, printElf, printReasons, printCapabilities))
+    if (!parseCommandLine(p_argCount, p_argArray, fileName, directoryName, printElf, printReasons, printCapabilities,
+                          jobs, ordered, failFast, checkpoint, digests, printEntropy,
+                          entropyWindow, entropyStride, carve, carveDepth, carveBytes, demangle))
         exit(EXIT_FAILURE);
 
+    BatchScanner scanner(printReasons, printCapabilities, printElf);
+    scanner.setDigests(digests);
+    scanner.setEntropy(printEntropy, entropyWindow, entropyStride);
+    scanner.setCarve(carve, carveDepth, carveBytes);
+    scanner.setDemangle(demangle);
+
     if (!fileName.empty())
-        do_parsing(fileName, printReasons, printCapabilities, printElf);
+        do_parsing(fileName, scanner);
 
     else if (!directoryName.empty())
     {
-        for (boost::filesystem::recursive_directory_iterator iter(directoryName);
-             iter != boost::filesystem::recursive_directory_iterator(); ++iter)
-                do_parsing(iter->path().string(), printReasons, printCapabilities, printElf);
+        scanner.setFailFast(failFast);
+        scanner.setCheckpoint(checkpoint);
+
+        bool success = false;
+        try
+        {
+            success = scanner.scanDirectory(directoryName, jobs, ordered);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Error in scanning " << directoryName << ": " << e.what() << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        scanner.printSummary(std::cerr);
+        if (!success)
+            exit(EXIT_FAILURE);
     }
 
     return EXIT_SUCCESS;
@@ -0,0 +1,336 @@
+#include "notes.hpp"
+#include "elf_view.hpp"
+#include "structures/elfheader.hpp"
+#include "structures/noteformat.hpp"
+
+#include <map>
+#include <sstream>
+#include <cstring>
+#include <boost/assign.hpp>
+
+namespace
+{
+    const std::map<boost::uint32_t, std::string> s_abiNames = boost::assign::map_list_of
+        (0, "OS Linux")
+        (1, "OS GNU")
+        (2, "OS Solaris")
+        (3, "OS FreeBSD");
+
+    const boost::string_view k_gnu("GNU");
+    const boost::string_view k_go("Go");
+
+    // rounds p_value up to a multiple of p_alignment (a power of two)
+    boost::uint64_t alignUp(boost::uint64_t p_value, boost::uint64_t p_alignment)
+    {
+        return (p_value + p_alignment - 1) & ~(p_alignment - 1);
+    }
+
+    // reads a 32 bit word that may not be aligned
+    boost::uint32_t readWord(const char* p_data, bool p_isLE)
+    {
+        boost::uint32_t value;
+        std::memcpy(&value, p_data, sizeof(value));
+        return p_isLE ? elf::view::LittleEndian::get(value) : elf::view::BigEndian::get(value);
+    }
+
+    // reads a 64 bit word that may not be aligned
+    boost::uint64_t readAddress(const char* p_data, bool p_isLE)
+    {
+        boost::uint64_t value;
+        std::memcpy(&value, p_data, sizeof(value));
+        return p_isLE ? elf::view::LittleEndian::get(value) : elf::view::BigEndian::get(value);
+    }
+
+    // the descriptor up to its first terminator
+    boost::string_view terminated(boost::string_view p_description)
+    {
+        const boost::string_view::size_type end = p_description.find('\0');
+        return end == boost::string_view::npos ? p_description : p_description.substr(0, end);
+    }
+
+    bool isX86(boost::uint16_t p_machine)
+    {
+        return p_machine == elf::k_em386 || p_machine == elf::k_emx8664;
+    }
+
+    /*
+     * calls p_function(type, data) for every property in the descriptor.
+     * the properties are padded to the size of an address
+     */
+    template <typename Function>
+    void forEachProperty(const NoteIterator::Note& p_note, bool p_is64, bool p_isLE, Function p_function)
+    {
+        const boost::uint64_t alignment = p_is64 ? 8 : 4;
+        const boost::string_view description(p_note.m_description);
+        boost::uint64_t position = 0;
+        while (description.size() - position >= sizeof(elf::property))
+        {
+            const boost::uint32_t type = readWord(description.data() + position, p_isLE);
+            const boost::uint32_t dataSize = readWord(description.data() + position + 4, p_isLE);
+            position += sizeof(elf::property);
+            if (dataSize > description.size() - position)
+            {
+                return;
+            }
+
+            p_function(type, description.substr(position, dataSize));
+            position = alignUp(position + dataSize, alignment);
+            if (position > description.size())
+            {
+                return;
+            }
+        }
+    }
+}
+
+NoteIterator::NoteIterator(const char* p_data, boost::uint64_t p_size,
+                           boost::uint64_t p_alignment, bool p_isLE) :
+    m_data(p_data),
+    m_size(p_size),
+    m_position(0),
+    m_alignment(p_alignment == 8 ? 8 : 4),
+    m_isLE(p_isLE),
+    m_truncated(false)
+{
+}
+
+NoteIterator::~NoteIterator()
+{
+}
+
+boost::uint32_t NoteIterator::readWord(boost::uint64_t p_offset) const
+{
+    return ::readWord(m_data + m_position + p_offset, m_isLE);
+}
+
+bool NoteIterator::next(Note& p_note)
+{
+    // what is left after the last note is padding
+    if (m_position >= m_size || m_size - m_position < sizeof(elf::note))
+    {
+        return false;
+    }
+
+    const boost::uint64_t nameSize = readWord(0);
+    const boost::uint64_t descSize = readWord(4);
+    const boost::uint64_t descOffset = m_position + alignUp(sizeof(elf::note) + nameSize, m_alignment);
+    if (descOffset > m_size || descSize > m_size - descOffset)
+    {
+        m_truncated = true;
+        m_position = m_size;
+        return false;
+    }
+
+    p_note.m_type = readWord(8);
+    p_note.m_name = terminated(boost::string_view(m_data + m_position + sizeof(elf::note), nameSize));
+    p_note.m_description = boost::string_view(m_data + descOffset, descSize);
+
+    m_position = alignUp(descOffset + descSize, m_alignment);
+    return true;
+}
+
+bool NoteIterator::isTruncated() const
+{
+    return m_truncated;
+}
+
+bool NoteDecoder::isNote(const NoteIterator::Note& p_note, boost::string_view p_name, boost::uint32_t p_type)
+{
+    return p_note.m_type == p_type && p_note.m_name == p_name;
+}
+
+std::string NoteDecoder::getTypeName(const NoteIterator::Note& p_note)
+{
+    if (p_note.m_name == k_gnu)
+    {
+        switch (p_note.m_type)
+        {
+            case elf::k_gnuAbiTag:
+                return "NT_GNU_ABI_TAG";
+            case elf::k_gnuHwcap:
+                return "NT_GNU_HWCAP";
+            case elf::k_gnuBuildId:
+                return "NT_GNU_BUILD_ID";
+            case elf::k_gnuGoldVersion:
+                return "NT_GNU_GOLD_VERSION";
+            case elf::k_gnuProperty:
+                return "NT_GNU_PROPERTY_TYPE_0";
+            default:
+                break;
+        }
+    }
+    else if (isNote(p_note, k_go, elf::k_goBuildId))
+    {
+        return "NT_GO_BUILDID";
+    }
+    return std::string();
+}
+
+std::string NoteDecoder::describe(const NoteIterator::Note& p_note, boost::uint16_t p_machine,
+                                  bool p_is64, bool p_isLE)
+{
+    if (p_note.m_name == k_gnu)
+    {
+        switch (p_note.m_type)
+        {
+            case elf::k_gnuAbiTag:
+                return decodeAbiTag(p_note, p_isLE);
+            case elf::k_gnuBuildId:
+                return decodeBuildId(p_note.m_description);
+            case elf::k_gnuGoldVersion:
+                return terminated(p_note.m_description).to_string();
+            case elf::k_gnuProperty:
+                return decodeProperties(p_note, p_machine, p_is64, p_isLE);
+            default:
+                break;
+        }
+    }
+    else if (isNote(p_note, k_go, elf::k_goBuildId))
+    {
+        return terminated(p_note.m_description).to_string();
+    }
+    return std::string();
+}
+
+std::string NoteDecoder::decodeAbiTag(const NoteIterator::Note& p_note, bool p_isLE)
+{
+    // os, major, minor, patch
+    if (p_note.m_description.size() != 16)
+    {
+        return std::string();
+    }
+
+    std::stringstream returnValue;
+    const boost::uint32_t os = readWord(p_note.m_description.data(), p_isLE);
+    std::map<boost::uint32_t, std::string>::const_iterator name = s_abiNames.find(os);
+    if (name != s_abiNames.end())
+    {
+        returnValue << name->second;
+    }
+    else
+    {
+        returnValue << os;
+    }
+    returnValue << ' ' << readWord(p_note.m_description.data() + 4, p_isLE)
+                << '.' << readWord(p_note.m_description.data() + 8, p_isLE)
+                << '.' << readWord(p_note.m_description.data() + 12, p_isLE);
+    return returnValue.str();
+}
+
+std::string NoteDecoder::decodeBuildId(boost::string_view p_description)
+{
+    static const char k_digits[] = "0123456789abcdef";
+
+    std::string returnValue(p_description.size() * 2, '0');
+    for (std::size_t i = 0; i < p_description.size(); ++i)
+    {
+        const boost::uint8_t byte = p_description[i];
+        returnValue[i * 2] = k_digits[byte >> 4];
+        returnValue[i * 2 + 1] = k_digits[byte & 0xf];
+    }
+    return returnValue;
+}
+
+boost::uint32_t NoteDecoder::decodeFeatures(const NoteIterator::Note& p_note, boost::uint16_t p_machine,
+                                            bool p_is64, bool p_isLE)
+{
+    const boost::uint32_t wanted = isX86(p_machine) ? elf::k_propertyX86Feature1And :
+                                   p_machine == elf::k_emAArch64 ? elf::k_propertyAArch64Feature1And : 0;
+    boost::uint32_t features = 0;
+    if (wanted != 0 && isNote(p_note, k_gnu, elf::k_gnuProperty))
+    {
+        forEachProperty(p_note, p_is64, p_isLE, [&](boost::uint32_t p_type, boost::string_view p_data)
+        {
+            if (p_type == wanted && p_data.size() == 4)
+            {
+                features = readWord(p_data.data(), p_isLE);
+            }
+        });
+    }
+    return features;
+}
+
+std::string NoteDecoder::decodeProperties(const NoteIterator::Note& p_note, boost::uint16_t p_machine,
+                                          bool p_is64, bool p_isLE)
+{
+    std::stringstream returnValue;
+    forEachProperty(p_note, p_is64, p_isLE, [&](boost::uint32_t p_type, boost::string_view p_data)
+    {
+        if (returnValue.tellp() > 0)
+        {
+            returnValue << ", ";
+        }
+
+        if (p_type == elf::k_propertyStackSize && (p_data.size() == 4 || p_data.size() == 8))
+        {
+            returnValue << "stack size: 0x" << std::hex
+                        << (p_data.size() == 8 ? readAddress(p_data.data(), p_isLE) :
+                                                 readWord(p_data.data(), p_isLE)) << std::dec;
+        }
+        else if (p_type == elf::k_propertyNoCopyOnProtected && p_data.empty())
+        {
+            returnValue << "no copy on protected";
+        }
+        else if (p_type == elf::k_propertyX86Feature1And && isX86(p_machine) && p_data.size() == 4)
+        {
+            const boost::uint32_t features = readWord(p_data.data(), p_isLE);
+            returnValue << "x86 feature:";
+            if (features & elf::k_x86FeatureIBT)
+            {
+                returnValue << " IBT";
+            }
+            if (features & elf::k_x86FeatureSHSTK)
+            {
+                returnValue << ((features & elf::k_x86FeatureIBT) ? ", SHSTK" : " SHSTK");
+            }
+            if ((features & (elf::k_x86FeatureIBT | elf::k_x86FeatureSHSTK)) == 0)
+            {
+                returnValue << " <None>";
+            }
+        }
+        else if ((p_type == elf::k_propertyX86Isa1Needed || p_type == elf::k_propertyX86Isa1Used) &&
+                 isX86(p_machine) && p_data.size() == 4)
+        {
+            static const char* const k_levels[elf::k_x86IsaLevels] =
+            {
+                "x86-64-baseline", "x86-64-v2", "x86-64-v3", "x86-64-v4"
+            };
+
+            const boost::uint32_t levels = readWord(p_data.data(), p_isLE);
+            returnValue << (p_type == elf::k_propertyX86Isa1Needed ? "x86 ISA needed:" : "x86 ISA used:");
+            for (boost::uint32_t i = 0, printed = 0; i < elf::k_x86IsaLevels; ++i)
+            {
+                if (levels & (1 << i))
+                {
+                    returnValue << (printed++ ? ", " : " ") << k_levels[i];
+                }
+            }
+            if ((levels & ((1 << elf::k_x86IsaLevels) - 1)) == 0)
+            {
+                returnValue << " <None>";
+            }
+        }
+        else if (p_type == elf::k_propertyAArch64Feature1And && p_machine == elf::k_emAArch64 && p_data.size() == 4)
+        {
+            const boost::uint32_t features = readWord(p_data.data(), p_isLE);
+            returnValue << "AArch64 feature:";
+            if (features & elf::k_aarch64FeatureBTI)
+            {
+                returnValue << " BTI";
+            }
+            if (features & elf::k_aarch64FeaturePAC)
+            {
+                returnValue << ((features & elf::k_aarch64FeatureBTI) ? ", PAC" : " PAC");
+            }
+            if ((features & (elf::k_aarch64FeatureBTI | elf::k_aarch64FeaturePAC)) == 0)
+            {
+                returnValue << " <None>";
+            }
+        }
+        else
+        {
+            returnValue << "type 0x" << std::hex << p_type << std::dec;
+        }
+    });
+    return returnValue.str();
+}
@@ -0,0 +1,127 @@
+#ifndef NOTES_HPP
+#define NOTES_HPP
+
+#include <string>
+#include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
+
+/*
+ * Walks the notes of a SHT_NOTE section or a PT_NOTE segment. A region holds
+ * any number of notes back to back (the ABI tag, the build id and the GNU
+ * properties usually share one PT_NOTE), each padded to the alignment of the
+ * region. The fields are read in the byte order of the binary and every note
+ * is bounds checked against the region.
+ *
+ * The notes point into the mapping. Nothing is copied until a description is
+ * asked for.
+ */
+class NoteIterator
+{
+public:
+
+    struct Note
+    {
+        boost::uint32_t m_type;
+
+        // the name without its terminator
+        boost::string_view m_name;
+
+        // the raw descriptor
+        boost::string_view m_description;
+    };
+
+    /*
+     * p_data the start of the notes
+     * p_size the size of the region
+     * p_alignment the alignment of the section or segment. 8 or (anything else) 4
+     * p_isLE the byte order of the binary
+     */
+    NoteIterator(const char* p_data, boost::uint64_t p_size,
+                 boost::uint64_t p_alignment, bool p_isLE);
+
+    ~NoteIterator();
+
+    /*
+     * reads the next note into p_note
+     * return false once the region ends or the next note doesn't fit in it
+     */
+    bool next(Note& p_note);
+
+    // return true if a note ran past the end of the region
+    bool isTruncated() const;
+
+private:
+
+    // disable evil things
+    NoteIterator(const NoteIterator& p_rhs);
+    NoteIterator& operator=(const NoteIterator& p_rhs);
+
+    // reads the 32 bit word at m_position + p_offset
+    boost::uint32_t readWord(boost::uint64_t p_offset) const;
+
+    // the start of the notes
+    const char* m_data;
+
+    // the size of the region
+    boost::uint64_t m_size;
+
+    // the offset of the next note
+    boost::uint64_t m_position;
+
+    // the padding of the names and descriptors
+    boost::uint64_t m_alignment;
+
+    bool m_isLE;
+
+    bool m_truncated;
+};
+
+/*
+ * Interprets the descriptors of the notes this parser knows about. The
+ * descriptors are read in place.
+ */
+class NoteDecoder
+{
+public:
+
+    // return true if p_note is a p_type note of the owner p_name
+    static bool isNote(const NoteIterator::Note& p_note, boost::string_view p_name, boost::uint32_t p_type);
+
+    // return the name of the type of p_note. empty if it's not known
+    static std::string getTypeName(const NoteIterator::Note& p_note);
+
+    /*
+     * decodes the descriptor of p_note into a line of text, ie "OS Linux
+     * 3.2.0" or "x86 feature: IBT, SHSTK". empty if it can't be decoded
+     * p_machine the e_machine of the binary, processor properties depend on it
+     */
+    static std::string describe(const NoteIterator::Note& p_note, boost::uint16_t p_machine,
+                                bool p_is64, bool p_isLE);
+
+    // return the NT_GNU_ABI_TAG descriptor as "OS major.minor.patch"
+    static std::string decodeAbiTag(const NoteIterator::Note& p_note, bool p_isLE);
+
+    // return a build id descriptor as lower case hex, two digits per byte
+    static std::string decodeBuildId(boost::string_view p_description);
+
+    /*
+     * return the feature_1_and bits of a NT_GNU_PROPERTY_TYPE_0 note (the
+     * k_x86Feature or k_aarch64Feature bits, depending on p_machine). 0 if
+     * the note doesn't have them
+     */
+    static boost::uint32_t decodeFeatures(const NoteIterator::Note& p_note, boost::uint16_t p_machine,
+                                          bool p_is64, bool p_isLE);
+
+    // return the properties of a NT_GNU_PROPERTY_TYPE_0 note, comma separated
+    static std::string decodeProperties(const NoteIterator::Note& p_note, boost::uint16_t p_machine,
+                                        bool p_is64, bool p_isLE);
+
+private:
+
+    // disable evil things
+    NoteDecoder();
+    NoteDecoder(const NoteDecoder& p_rhs);
+    NoteDecoder& operator=(const NoteDecoder& p_rhs);
+};
+
+#endif
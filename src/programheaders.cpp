@@ -2,9 +2,11 @@
 #include "abstract_segments.hpp"
 #include "abstract_programheader.hpp"
 #include "structures/programheader.hpp"
+#include "elf_view.hpp"
 
 #include <boost/foreach.hpp>
 #include <sstream>
+#include <stdexcept>
 
 ProgramHeaders::ProgramHeaders() : m_programHeaders()
 {
@@ -20,8 +22,17 @@ void ProgramHeaders::setHeaders(const char *p_data, boost::uint16_t p_count,
     if (p_size == 0)
         exit(EXIT_FAILURE);
 
-    for (std::size_t i = 0; i < p_count; ++i, p_data += p_size)
-        m_programHeaders.emplace_back(p_data, p_size, p_is64, p_isLE);
+    elf::view::dispatch(p_is64, p_isLE, [&](auto p_class, auto p_order)
+    {
+        typedef decltype(p_class) Class;
+        typedef decltype(p_order) Order;
+
+        if (p_count != 0 && p_size != sizeof(typename Class::program_header))
+            throw std::runtime_error("Unexpected program header size");
+
+        for (std::size_t i = 0; i < p_count; ++i, p_data += p_size)
+            m_programHeaders.emplace_back(elf::view::ProgramView<Class, Order>(p_data));
+    });
 }
 
 void ProgramHeaders::extractSegments(AbstractSegments &p_segments)
@@ -0,0 +1,315 @@
+#include "regex_scanner.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <boost/foreach.hpp>
+#include <boost/assign/list_of.hpp>
+
+namespace
+{
+    // orders trigger hits by where they start
+    bool startsBefore(const SearchMatch& p_lhs, const SearchMatch& p_rhs)
+    {
+        if (p_lhs.m_offset != p_rhs.m_offset)
+        {
+            return p_lhs.m_offset < p_rhs.m_offset;
+        }
+        return p_lhs.m_pattern < p_rhs.m_pattern;
+    }
+
+    // the number of hits to collect before trying to verify some of them
+    const std::size_t k_flushSize = 256;
+
+    // the scanner loaded with the default rules
+    struct DefaultScanner
+    {
+        DefaultScanner() :
+            m_scanner()
+        {
+            m_scanner.addDefaultRules();
+            m_scanner.compile();
+        }
+
+        RegexScanner m_scanner;
+    };
+}
+
+/*
+ * The automaton reports a hit when the trigger ends, so a short trigger can
+ * be reported before a longer one that starts earlier. Rules have to see
+ * their hits in start order, so the hits are held back until no earlier
+ * starting trigger can show up anymore (ie, they start more than the
+ * longest trigger before the current position).
+ */
+struct RegexScanner::TriggerVisitor
+{
+    TriggerVisitor(const RegexScanner& p_scanner, const char* p_data, std::size_t p_length,
+                   std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) :
+        m_scanner(p_scanner),
+        m_data(p_data),
+        m_length(p_length),
+        m_capabilities(p_capabilities),
+        m_resume(p_scanner.m_rules.size(), 0),
+        m_pending()
+    {
+        m_pending.reserve(k_flushSize * 2);
+    }
+
+    void operator()(boost::uint32_t p_pattern, std::size_t p_offset)
+    {
+        m_pending.push_back(SearchMatch(p_pattern, p_offset,
+                                        m_scanner.m_triggers.getLength(p_pattern)));
+        if (m_pending.size() >= k_flushSize)
+        {
+            // the hit just reported ends here. nothing new can start before safe
+            const std::size_t end = p_offset + m_pending.back().m_length;
+            const std::size_t safe = end > m_scanner.m_maxTrigger ? end - m_scanner.m_maxTrigger : 0;
+            flush(safe);
+        }
+    }
+
+    // verifies the held back hits that start before p_safe
+    void flush(std::size_t p_safe)
+    {
+        std::sort(m_pending.begin(), m_pending.end(), startsBefore);
+
+        std::vector<SearchMatch>::iterator it = m_pending.begin();
+        for ( ; it != m_pending.end() && it->m_offset < p_safe; ++it)
+        {
+            const Rule* rule = static_cast<const Rule*>(
+                m_scanner.m_triggers.getStoredData(it->m_pattern));
+            std::size_t& resume = m_resume[rule->m_index];
+            if (it->m_offset >= resume)
+            {
+                m_scanner.verify(*rule, m_data, m_length, it->m_offset, resume, m_capabilities);
+            }
+        }
+        m_pending.erase(m_pending.begin(), it);
+    }
+
+    const RegexScanner& m_scanner;
+    const char* m_data;
+    std::size_t m_length;
+    std::map<elf::Capabilties, std::set<std::string> >& m_capabilities;
+
+    // per rule, the first offset its next match may start at
+    std::vector<std::size_t> m_resume;
+
+    // trigger hits that haven't been verified yet
+    std::vector<SearchMatch> m_pending;
+};
+
+RegexScanner::RegexScanner() :
+    m_rules(),
+    m_triggers(),
+    m_maxTrigger(0),
+    m_ready(false)
+{
+}
+
+RegexScanner::~RegexScanner()
+{
+}
+
+const RegexScanner& RegexScanner::defaultScanner()
+{
+    // initialization of a function local static is thread safe
+    static const DefaultScanner s_default;
+    return s_default.m_scanner;
+}
+
+void RegexScanner::addDefaultRules()
+{
+    // ips
+    addRule(elf::k_ipAddress,
+            "[1-2]?[0-9]?[0-9]\\.[1-2]?[0-9]?[0-9]\\.[1-2]?[0-9]?[0-9]\\.[1-2]?[0-9]?[0-9](?:[:0-9]{2,})*",
+            boost::assign::list_of("0")("1")("2")("3")("4")("5")("6")("7")("8")("9"));
+
+    // urls
+    addRule(elf::k_url,
+            "(?:(?:http|https)://[A-Za-z0-9_./:%+?+)|(?:www.[A-Za-z0-9/:]+\\.com)",
+            boost::assign::list_of("http")("www"));
+
+    // commands
+    addRule(elf::k_shell,
+            "(?:(?:wget|chmod|killall|nohup|sed|insmod|echo) [[:print:]]+)|(?:tar -[[:print:]]+)",
+            boost::assign::list_of("wget ")("chmod ")("killall ")("nohup ")("sed ")("insmod ")("echo ")("tar -"));
+
+    // url request
+    addRule(elf::k_http,
+            "(?:POST (?:/|%s)|GET (?:/|%s)|CONNECT (?:/|%s)|User-Agent:)[[:print:]]+",
+            boost::assign::list_of("POST ")("GET ")("CONNECT ")("User-Agent:"));
+
+    // file paths
+    addRule(elf::k_filePath,
+            "/(?:usr|etc|tmp|bin)/[a-zA-Z0-9/\\._\\-]+",
+            boost::assign::list_of("/usr/")("/etc/")("/tmp/")("/bin/"));
+}
+
+void RegexScanner::addRule(elf::Capabilties p_type, const std::string& p_pattern,
+                           const std::vector<std::string>& p_triggers)
+{
+    if (m_ready)
+    {
+        throw std::runtime_error("Rules can't be added to a compiled RegexScanner");
+    }
+
+    m_rules.push_back(new Rule(m_rules.size(), p_type, p_pattern, p_triggers));
+}
+
+void RegexScanner::compile()
+{
+    BOOST_FOREACH (Rule& rule, m_rules)
+    {
+        BOOST_FOREACH (const std::string& trigger, rule.m_triggers)
+        {
+            if (trigger.empty() || trigger.size() > 255)
+            {
+                throw std::runtime_error("Bad trigger for the regex " + rule.m_pattern.str());
+            }
+            m_triggers.addWord(trigger, &rule);
+            m_maxTrigger = std::max(m_maxTrigger, trigger.size());
+        }
+    }
+    m_triggers.compile();
+    m_ready = true;
+}
+
+void RegexScanner::scan(const char* p_data, std::size_t p_length,
+                        std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const
+{
+    if (p_data == NULL || p_length == 0)
+    {
+        return;
+    }
+
+    Stream stream(*this, p_data, p_length, p_capabilities);
+    stream.consume(reinterpret_cast<const unsigned char*>(p_data), p_length, 0);
+    stream.finish();
+    if (!stream.getError().empty())
+    {
+        throw std::runtime_error(stream.getError());
+    }
+}
+
+RegexScanner::Stream::Stream(const RegexScanner& p_scanner, const char* p_data, std::size_t p_length,
+                             std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) :
+    m_scanner(p_scanner),
+    m_state(),
+    m_visitor(new TriggerVisitor(p_scanner, p_data, p_length, p_capabilities)),
+    m_error()
+{
+    if (!m_scanner.m_ready)
+    {
+        throw std::runtime_error("The RegexScanner hasn't been compiled");
+    }
+}
+
+RegexScanner::Stream::~Stream()
+{
+}
+
+const std::string& RegexScanner::Stream::getError() const
+{
+    return m_error;
+}
+
+void RegexScanner::Stream::consume(const unsigned char* p_block, std::size_t p_length, std::size_t)
+{
+    if (!m_error.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        m_scanner.m_triggers.scan(m_state, p_block, p_length, *m_visitor);
+    }
+    catch (const std::exception& e)
+    {
+        m_error.assign(e.what());
+    }
+}
+
+void RegexScanner::Stream::finish()
+{
+    if (!m_error.empty())
+    {
+        return;
+    }
+
+    try
+    {
+        m_visitor->flush(m_visitor->m_length);
+
+        BOOST_FOREACH (const Rule& rule, m_scanner.m_rules)
+        {
+            if (rule.m_triggers.empty())
+            {
+                m_scanner.searchAll(rule, m_visitor->m_data, m_visitor->m_length,
+                                    m_visitor->m_capabilities);
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        m_error.assign(e.what());
+    }
+}
+
+void RegexScanner::verify(const Rule& p_rule, const char* p_data, std::size_t p_length,
+                          std::size_t p_offset, std::size_t& p_resume,
+                          std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const
+{
+    boost::match_flag_type flags = boost::match_continuous;
+    if (p_offset != 0)
+    {
+        flags |= boost::match_prev_avail;
+    }
+
+    boost::cmatch m;
+    if (!boost::regex_search(p_data + p_offset, p_data + p_length, m, p_rule.m_pattern, flags))
+    {
+        return;
+    }
+
+    for (std::size_t i = 0; i < m.size(); ++i)
+    {
+        if (m[i].matched)
+        {
+            p_capabilities[p_rule.m_type].insert(m[i].str());
+        }
+    }
+
+    // never resume in place, even on an empty match
+    p_resume = p_offset + std::max<std::size_t>(m[0].length(), 1);
+}
+
+void RegexScanner::searchAll(const Rule& p_rule, const char* p_data, std::size_t p_length,
+                             std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const
+{
+    std::size_t resume = 0;
+    boost::cmatch m;
+    while (resume < p_length)
+    {
+        boost::match_flag_type flags = boost::match_default;
+        if (resume != 0)
+        {
+            flags |= boost::match_prev_avail;
+        }
+
+        if (!boost::regex_search(p_data + resume, p_data + p_length, m, p_rule.m_pattern, flags))
+        {
+            break;
+        }
+
+        for (std::size_t i = 0; i < m.size(); ++i)
+        {
+            if (m[i].matched)
+            {
+                p_capabilities[p_rule.m_type].insert(m[i].str());
+            }
+        }
+        resume = (m[0].second - p_data) + (m[0].length() == 0 ? 1 : 0);
+    }
+}
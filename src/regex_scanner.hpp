@@ -0,0 +1,160 @@
+#ifndef REGEX_SCANNER_HPP
+#define REGEX_SCANNER_HPP
+
+#include "structures/capabilities.hpp"
+#include "byte_pipeline.hpp"
+#include "datastructures/search_tree.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/regex.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+/*
+ * Runs a set of regular expressions over a binary in a single pass. Every
+ * rule comes with the literal strings a match has to start with (its
+ * triggers). All the triggers go into one automaton and the input is read
+ * once; the rule's regex is only tried, anchored, where one of its triggers
+ * starts. That gives the same results as calling regex_search over and over
+ * (leftmost match first, then carry on after its end) while the file is only
+ * read one time instead of once per rule.
+ *
+ * A rule without triggers can't be prefiltered and falls back to a plain
+ * regex_search loop of its own.
+ *
+ * Once compiled the scanner is read only and can be shared between threads.
+ */
+class RegexScanner
+{
+private:
+
+    // collects the trigger hits and verifies them in start order
+    struct TriggerVisitor;
+
+public:
+
+    /*
+     * a scan that is fed the file a block at a time by a BytePipeline. the
+     * regexes are verified against the whole buffer so it has to stay
+     * readable until finish() is called.
+     */
+    class Stream : public ByteConsumer
+    {
+    public:
+
+        /*
+         * p_scanner a compiled scanner
+         * p_data the whole buffer the blocks come from
+         * p_length the size of the buffer
+         * p_capabilities where the matches are stored
+         */
+        Stream(const RegexScanner& p_scanner, const char* p_data, std::size_t p_length,
+               std::map<elf::Capabilties, std::set<std::string> >& p_capabilities);
+        ~Stream();
+
+        virtual void consume(const unsigned char* p_block, std::size_t p_length,
+                             std::size_t p_offset);
+
+        virtual void finish();
+
+        // return why the scan stopped early (ie, a regex got too complex). empty if it didn't
+        const std::string& getError() const;
+
+    private:
+
+        // disable evil things
+        Stream(const Stream& p_rhs);
+        Stream& operator=(const Stream& p_rhs);
+
+    private:
+
+        const RegexScanner& m_scanner;
+        SearchTree::ScanState m_state;
+        boost::scoped_ptr<TriggerVisitor> m_visitor;
+        std::string m_error;
+    };
+
+    RegexScanner();
+    ~RegexScanner();
+
+    // return the process wide scanner holding the default rules
+    static const RegexScanner& defaultScanner();
+
+    // adds the rules ELFParser has always looked for (ips, urls, shell, etc.)
+    void addDefaultRules();
+
+    /*
+     * adds a rule. must be called before compile()
+     * p_type the capability the matches are recorded under
+     * p_pattern the regular expression
+     * p_triggers the literals every match starts with. empty if there are none
+     * throws boost::regex_error if the pattern doesn't compile
+     */
+    void addRule(elf::Capabilties p_type, const std::string& p_pattern,
+                 const std::vector<std::string>& p_triggers);
+
+    // builds the trigger automaton. no rules can be added afterwards
+    void compile();
+
+    /*
+     * scans the input and stores the matched strings under their rule's
+     * capability.
+     * throws std::runtime_error if a regex fails (ie, gets too complex)
+     */
+    void scan(const char* p_data, std::size_t p_length,
+              std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const;
+
+private:
+
+    // disable evil things
+    RegexScanner(const RegexScanner& p_rhs);
+    RegexScanner& operator=(const RegexScanner& p_rhs);
+
+    struct Rule
+    {
+        Rule(std::size_t p_index, elf::Capabilties p_type, const std::string& p_pattern,
+             const std::vector<std::string>& p_triggers) :
+            m_index(p_index),
+            m_type(p_type),
+            m_pattern(p_pattern),
+            m_triggers(p_triggers)
+        {
+        }
+
+        std::size_t m_index;
+        elf::Capabilties m_type;
+        boost::regex m_pattern;
+        std::vector<std::string> m_triggers;
+    };
+
+    /*
+     * tries p_rule anchored at p_offset and records the match.
+     * p_resume where the rule's next match may start. moved past the match
+     */
+    void verify(const Rule& p_rule, const char* p_data, std::size_t p_length,
+                std::size_t p_offset, std::size_t& p_resume,
+                std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const;
+
+    // the regex_search loop for the rules without triggers
+    void searchAll(const Rule& p_rule, const char* p_data, std::size_t p_length,
+                   std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const;
+
+private:
+
+    // all the rules, in the order they were added
+    boost::ptr_vector<Rule> m_rules;
+
+    // the triggers of all the rules. stored data is the Rule*
+    SearchTree m_triggers;
+
+    // the length of the longest trigger
+    std::size_t m_maxTrigger;
+
+    // indicates if compile() was called
+    bool m_ready;
+};
+
+#endif
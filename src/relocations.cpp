@@ -0,0 +1,143 @@
+#include "relocations.hpp"
+#include "symbols.hpp"
+#include "dynamicsection.hpp"
+#include "abstract_segments.hpp"
+#include "elf_view.hpp"
+
+#include <sstream>
+#include <algorithm>
+
+Relocations::Relocations() :
+    m_relocations(),
+    m_pltStart(0),
+    m_pltEnd(0)
+{
+}
+
+Relocations::~Relocations()
+{
+}
+
+void Relocations::createRelocations(const char* p_data, boost::uint64_t p_dataSize,
+                                    const DynamicSection& p_dynamic, const AbstractSegments& p_segments,
+                                    bool p_is64, bool p_isLE)
+{
+    m_relocations.clear();
+    m_pltStart = 0;
+    m_pltEnd = 0;
+
+    // an address that doesn't translate comes back as 0, which is never a table
+    const boost::uint64_t rel = p_segments.getOffsetFromVirt(p_dynamic.getRelVirtAddress());
+    const boost::uint64_t rela = p_segments.getOffsetFromVirt(p_dynamic.getRelaVirtAddress());
+    const boost::uint64_t jmpRel = p_segments.getOffsetFromVirt(p_dynamic.getJmpRelVirtAddress());
+    const bool pltRela = p_dynamic.isPltRela(p_is64);
+
+    elf::view::dispatch(p_is64, p_isLE, [&](auto p_class, auto p_order)
+    {
+        typedef decltype(p_class) Class;
+        typedef decltype(p_order) Order;
+
+        const std::size_t relStart = m_relocations.size();
+        if (rel != 0)
+        {
+            readTable<Class, Order>(p_data, p_dataSize, rel, p_dynamic.getRelSize(), false);
+        }
+        const std::size_t relaStart = m_relocations.size();
+        if (rela != 0)
+        {
+            readTable<Class, Order>(p_data, p_dataSize, rela, p_dynamic.getRelaSize(), true);
+        }
+
+        if (jmpRel == 0)
+        {
+            m_pltStart = m_pltEnd = m_relocations.size();
+            return;
+        }
+
+        /* DT_RELSZ / DT_RELASZ may cover DT_JMPREL too, in which case it was
+         * read with them */
+        const boost::uint64_t covered = pltRela ? rela : rel;
+        const boost::uint64_t coveredSize = pltRela ? p_dynamic.getRelaSize() : p_dynamic.getRelSize();
+        if (covered != 0 && jmpRel >= covered && jmpRel - covered < coveredSize)
+        {
+            const std::size_t entrySize = pltRela ? sizeof(typename Class::rela) : sizeof(typename Class::relocation);
+            const std::size_t tableEnd = pltRela ? m_relocations.size() : relaStart;
+            m_pltStart = std::min<std::size_t>((pltRela ? relaStart : relStart) + (jmpRel - covered) / entrySize, tableEnd);
+            m_pltEnd = std::min<std::size_t>(m_pltStart + p_dynamic.getPltRelSize() / entrySize, tableEnd);
+        }
+        else
+        {
+            m_pltStart = m_relocations.size();
+            readTable<Class, Order>(p_data, p_dataSize, jmpRel, p_dynamic.getPltRelSize(), pltRela);
+            m_pltEnd = m_relocations.size();
+        }
+    });
+}
+
+template <typename Class, typename Order>
+void Relocations::readTable(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset,
+                            boost::uint64_t p_size, bool p_rela)
+{
+    if (p_offset >= p_dataSize)
+    {
+        return;
+    }
+
+    // a table that runs past the end of the file is cut short
+    const std::size_t entrySize = p_rela ? sizeof(typename Class::rela) : sizeof(typename Class::relocation);
+    const std::size_t count = std::min(p_size, p_dataSize - p_offset) / entrySize;
+    m_relocations.reserve(m_relocations.size() + count);
+
+    const char* entry = p_data + p_offset;
+    for (std::size_t i = 0; i < count; ++i, entry += entrySize)
+    {
+        const elf::view::RelocationView<Class, Order> view(entry);
+        Relocation relocation = { view.getOffset(), p_rela ? view.getAddend() : 0,
+                                  view.getSymbol(), view.getType() };
+        m_relocations.push_back(relocation);
+    }
+}
+
+const std::vector<Relocations::Relocation>& Relocations::getRelocations() const
+{
+    return m_relocations;
+}
+
+std::size_t Relocations::getPltCount() const
+{
+    return m_pltEnd - m_pltStart;
+}
+
+void Relocations::evaluate(const Symbols& p_symbols,
+                           std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const
+{
+    std::vector<boost::uint32_t> imports;
+    imports.reserve(getPltCount());
+    for (std::size_t i = m_pltStart; i < m_pltEnd; ++i)
+    {
+        imports.push_back(m_relocations[i].m_symbol);
+    }
+    p_symbols.evaluateImports(imports, p_capabilities);
+}
+
+std::string Relocations::printToStdOut(const Symbols& p_symbols) const
+{
+    std::stringstream returnValue;
+    if (!m_relocations.empty())
+    {
+        const std::vector<AbstractSymbol>& symbols(p_symbols.getSymbols());
+        returnValue << "Relocations (count=" << m_relocations.size() << ", plt=" << getPltCount() << ")\n";
+        for (std::size_t i = 0; i < m_relocations.size(); ++i)
+        {
+            const Relocation& relocation = m_relocations[i];
+            returnValue << "\t offset= 0x" << std::hex << relocation.m_offset << ", type= " << std::dec
+                        << relocation.m_type << ", addend= 0x" << std::hex << relocation.m_addend;
+            if (relocation.m_symbol != 0 && relocation.m_symbol < symbols.size())
+            {
+                returnValue << ", symbol= " << p_symbols.getDisplayName(symbols[relocation.m_symbol]);
+            }
+            returnValue << std::endl;
+        }
+    }
+    return returnValue.str();
+}
@@ -0,0 +1,88 @@
+#ifndef RELOCATIONS_HPP
+#define RELOCATIONS_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <boost/cstdint.hpp>
+
+#include "structures/capabilities.hpp"
+
+class Symbols;
+class DynamicSection;
+class AbstractSegments;
+
+/*
+ * The relocations the dynamic section points at (DT_REL, DT_RELA and
+ * DT_JMPREL). The tables are decoded straight out of the mapping into one
+ * compact vector. The symbols are kept as their index into the dynamic symbol
+ * table, so resolving one is an array access and no names are copied.
+ *
+ * The PLT relocations are what the binary imports. On a stripped binary they
+ * are often the only import list left, so they are scored too.
+ */
+class Relocations
+{
+public:
+
+    struct Relocation
+    {
+        boost::uint64_t m_offset;
+        boost::uint64_t m_addend;
+        boost::uint32_t m_symbol;
+        boost::uint32_t m_type;
+    };
+
+    Relocations();
+    ~Relocations();
+
+    /*
+     * decodes the tables listed in p_dynamic
+     * p_data the start of the file
+     * p_dataSize the size of the file
+     * p_dynamic the parsed dynamic section
+     * p_segments translates the addresses of the tables
+     */
+    void createRelocations(const char* p_data, boost::uint64_t p_dataSize,
+                           const DynamicSection& p_dynamic, const AbstractSegments& p_segments,
+                           bool p_is64, bool p_isLE);
+
+    // return the relocations in the order of DT_REL, DT_RELA, DT_JMPREL
+    const std::vector<Relocation>& getRelocations() const;
+
+    // return the number of DT_JMPREL (PLT) relocations
+    std::size_t getPltCount() const;
+
+    /*
+     * scores the functions the PLT relocations import
+     * p_symbols the dynamic symbols the relocations refer to
+     * p_capabilities stores information about what the binary does
+     */
+    void evaluate(const Symbols& p_symbols,
+                  std::map<elf::Capabilties, std::set<std::string> >& p_capabilities) const;
+
+    // p_symbols the dynamic symbols the relocations refer to
+    std::string printToStdOut(const Symbols& p_symbols) const;
+
+private:
+
+    // decodes one table with the class and byte order of the binary
+    template <typename Class, typename Order>
+    void readTable(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset,
+                   boost::uint64_t p_size, bool p_rela);
+
+    // disable evil things
+    Relocations(const Relocations& p_rhs);
+    Relocations& operator=(const Relocations& p_rhs);
+
+private:
+
+    std::vector<Relocation> m_relocations;
+
+    // the PLT relocations are [m_pltStart, m_pltEnd) in m_relocations
+    std::size_t m_pltStart;
+    std::size_t m_pltEnd;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "section_table.hpp"
+#include "abstract_sectionheader.hpp"
+#include "structures/sectionheader.hpp"
+
+const std::size_t SectionTable::k_npos;
+
+SectionTable::SectionTable() :
+    m_offsets(),
+    m_sizes(),
+    m_addresses(),
+    m_types(),
+    m_flags(),
+    m_links(),
+    m_aligns(),
+    m_nameIds(),
+    m_names(),
+    m_nameLookup()
+{
+}
+
+SectionTable::~SectionTable()
+{
+}
+
+void SectionTable::add(const AbstractSectionHeader& p_header)
+{
+    std::map<std::string, boost::uint32_t>::const_iterator name = m_nameLookup.find(p_header.getName());
+    if (name == m_nameLookup.end())
+    {
+        name = m_nameLookup.insert(std::make_pair(p_header.getName(),
+                                                  static_cast<boost::uint32_t>(m_names.size()))).first;
+        m_names.push_back(p_header.getName());
+    }
+
+    m_offsets.push_back(p_header.getPhysOffset());
+    m_sizes.push_back(p_header.getSize());
+    m_addresses.push_back(p_header.getVirtAddress());
+    m_types.push_back(p_header.getType());
+    m_flags.push_back(p_header.getFlags());
+    m_links.push_back(p_header.getLink());
+    m_aligns.push_back(p_header.getAddrAlign());
+    m_nameIds.push_back(name->second);
+}
+
+std::size_t SectionTable::size() const
+{
+    return m_offsets.size();
+}
+
+bool SectionTable::empty() const
+{
+    return m_offsets.empty();
+}
+
+boost::uint64_t SectionTable::getOffset(std::size_t p_index) const
+{
+    return m_offsets[p_index];
+}
+
+boost::uint64_t SectionTable::getSize(std::size_t p_index) const
+{
+    return m_sizes[p_index];
+}
+
+boost::uint64_t SectionTable::getAddress(std::size_t p_index) const
+{
+    return m_addresses[p_index];
+}
+
+boost::uint32_t SectionTable::getType(std::size_t p_index) const
+{
+    return m_types[p_index];
+}
+
+boost::uint64_t SectionTable::getFlags(std::size_t p_index) const
+{
+    return m_flags[p_index];
+}
+
+boost::uint32_t SectionTable::getLink(std::size_t p_index) const
+{
+    return m_links[p_index];
+}
+
+boost::uint64_t SectionTable::getAlign(std::size_t p_index) const
+{
+    return m_aligns[p_index];
+}
+
+boost::uint32_t SectionTable::getNameId(std::size_t p_index) const
+{
+    return m_nameIds[p_index];
+}
+
+const std::string& SectionTable::getName(std::size_t p_index) const
+{
+    return m_names[m_nameIds[p_index]];
+}
+
+bool SectionTable::isExecutable(std::size_t p_index) const
+{
+    return (m_flags[p_index] & elf::k_shexec) != 0;
+}
+
+std::size_t SectionTable::findAddress(boost::uint64_t p_virtual) const
+{
+    const std::size_t count = m_addresses.size();
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (m_addresses[i] <= p_virtual && (m_addresses[i] + m_sizes[i]) > p_virtual)
+        {
+            return i;
+        }
+    }
+    return k_npos;
+}
@@ -0,0 +1,74 @@
+#ifndef SECTION_TABLE_HPP
+#define SECTION_TABLE_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+
+class AbstractSectionHeader;
+
+/*
+ * The decoded section table, stored column by column: one contiguous array
+ * per field. It is filled once, when the section headers are parsed, and the
+ * scans over every section (resolving a virtual address, generating the
+ * segments, adding the entropy ranges) only stream through the columns they
+ * need instead of walking a vector of header objects.
+ *
+ * The names are stored once each. A section refers to its name by name id.
+ */
+class SectionTable
+{
+public:
+
+    // returned by findAddress() if no section holds the address
+    static const std::size_t k_npos = static_cast<std::size_t>(-1);
+
+    SectionTable();
+    ~SectionTable();
+
+    // appends p_header to the table
+    void add(const AbstractSectionHeader& p_header);
+
+    // return the number of sections
+    std::size_t size() const;
+
+    bool empty() const;
+
+    boost::uint64_t getOffset(std::size_t p_index) const;
+    boost::uint64_t getSize(std::size_t p_index) const;
+    boost::uint64_t getAddress(std::size_t p_index) const;
+    boost::uint32_t getType(std::size_t p_index) const;
+    boost::uint64_t getFlags(std::size_t p_index) const;
+    boost::uint32_t getLink(std::size_t p_index) const;
+    boost::uint64_t getAlign(std::size_t p_index) const;
+    boost::uint32_t getNameId(std::size_t p_index) const;
+    const std::string& getName(std::size_t p_index) const;
+    bool isExecutable(std::size_t p_index) const;
+
+    /*
+     * return the index of the first section with p_virtual in
+     * [address, address + size). k_npos if there is none
+     */
+    std::size_t findAddress(boost::uint64_t p_virtual) const;
+
+private:
+
+    std::vector<boost::uint64_t> m_offsets;
+    std::vector<boost::uint64_t> m_sizes;
+    std::vector<boost::uint64_t> m_addresses;
+    std::vector<boost::uint32_t> m_types;
+    std::vector<boost::uint64_t> m_flags;
+    std::vector<boost::uint32_t> m_links;
+    std::vector<boost::uint64_t> m_aligns;
+    std::vector<boost::uint32_t> m_nameIds;
+
+    // the distinct names, indexed by name id
+    std::vector<std::string> m_names;
+
+    // the name id of every name in m_names
+    std::map<std::string, boost::uint32_t> m_nameLookup;
+};
+
+#endif
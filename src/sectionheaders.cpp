@@ -1,11 +1,15 @@
 #include "sectionheaders.hpp"
 #include "abstract_segments.hpp"
 #include "abstract_sectionheader.hpp"
+#include "elf_view.hpp"
 
 #include <boost/foreach.hpp>
 #include <sstream>
+#include <stdexcept>
 
-SectionHeaders::SectionHeaders() : m_totalSize(0),
+SectionHeaders::SectionHeaders() : m_sectionHeaders(),
+                                   m_table(),
+                                   m_totalSize(0),
                                    m_stringIndex(0)
 {
 }
@@ -47,33 +51,58 @@ void SectionHeaders::setHeaders(const char *p_data, uint32_t p_offset, const cha
     }
 
     m_stringIndex = p_stringIndex;
+    elf::view::dispatch(p_is64, p_isLE, [&](auto p_class, auto p_order)
+    {
+        readHeaders<decltype(p_class), decltype(p_order)>(p_data, p_start, p_count,
+                                                           p_size, p_capabilities);
+    });
+
+    // the names can only be looked up once the string table is known
+    BOOST_FOREACH (AbstractSectionHeader &header, m_sectionHeaders)
+    {
+        header.resolveName(m_sectionHeaders, p_stringIndex, p_start, p_total_size);
+    }
+    BOOST_FOREACH (const AbstractSectionHeader &header, m_sectionHeaders)
+    {
+        m_table.add(header);
+    }
+}
+
+template <typename Class, typename Order>
+void SectionHeaders::readHeaders(const char *p_data, const char *p_start, boost::uint16_t p_count,
+                                 boost::uint32_t p_size,
+                                 std::map<elf::Capabilties, std::set<std::string>> &p_capabilities)
+{
+    if ((p_start + m_totalSize) > p_data && p_size != sizeof(typename Class::section_header))
+    {
+        throw std::runtime_error("Unexpected section header size");
+    }
+
     for (std::size_t i = 0; i <= p_count; ++i, p_data += p_size)
     {
-        if ((p_start + p_total_size) > p_data)
+        if ((p_start + m_totalSize) > p_data)
         {
-            m_sectionHeaders.emplace_back(p_data, p_size, p_start, p_total_size,
-                                          p_stringIndex, m_sectionHeaders,
-                                          p_is64, p_isLE);
-            if (m_sectionHeaders.back().getType() != elf::k_nobits &&
+            const elf::view::SectionView<Class, Order> view(p_data);
+            if (view.getType() != elf::k_nobits &&
                 (
-                    (m_sectionHeaders.back().getPhysOffset() + m_sectionHeaders.back().getSize()) > m_totalSize ||
-                    (m_sectionHeaders.back().getPhysOffset() > UINT64_MAX - m_sectionHeaders.back().getSize()) // Overflow check
+                    (view.getOffset() + view.getSize()) > m_totalSize ||
+                    (view.getOffset() > UINT64_MAX - view.getSize()) // Overflow check
                 )
             )
             {
-                m_sectionHeaders.pop_back();
                 p_capabilities[elf::k_antidebug].insert("Invalid sections entries in section table, check offsets, possible malformed elf ");
             }
+            else
+            {
+                m_sectionHeaders.emplace_back(view);
+            }
         }
     }
 }
 
 void SectionHeaders::extractSegments(AbstractSegments &p_segments)
 {
-    BOOST_FOREACH (const AbstractSectionHeader &header, m_sectionHeaders)
-    {
-        p_segments.makeSegmentFromSectionHeader(header);
-    }
+    p_segments.setSections(m_table);
 }
 
 void SectionHeaders::evaluate(std::vector<std::pair<boost::int32_t, std::string>> &p_reasons,
@@ -93,6 +122,11 @@ const std::vector<AbstractSectionHeader> &SectionHeaders::getSections() const
     return m_sectionHeaders;
 }
 
+const SectionTable &SectionHeaders::getTable() const
+{
+    return m_table;
+}
+
 boost::uint32_t SectionHeaders::getStringTableIndex() const
 {
     return m_stringIndex;
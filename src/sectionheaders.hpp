@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <boost/cstdint.hpp>
 
+#include "section_table.hpp"
 #include "structures/capabilities.hpp"
 
 class AbstractSegments;
@@ -24,9 +25,18 @@ private:
     SectionHeaders(const SectionHeaders &p_rhs);
     SectionHeaders &operator=(const SectionHeaders &p_rhs);
 
+    //! decodes the table with the class and byte order of the binary
+    template <typename Class, typename Order>
+    void readHeaders(const char *p_data, const char *p_start, boost::uint16_t p_count,
+                     boost::uint32_t p_size,
+                     std::map<elf::Capabilties, std::set<std::string>> &p_capabilities);
+
     //! A list of the entries in the program header
     std::vector<AbstractSectionHeader> m_sectionHeaders;
 
+    //! The same entries, column by column
+    SectionTable m_table;
+
     //! Total size of the binary
     boost::uint64_t m_totalSize;
 
@@ -76,6 +86,9 @@ public:
     // the section headers
     const std::vector<AbstractSectionHeader> &getSections() const;
 
+    // the section headers, column by column
+    const SectionTable &getTable() const;
+
     // the string table index
     boost::uint32_t getStringTableIndex() const;
 
@@ -2,38 +2,47 @@
 #define NOTE_SEGMENT_HPP
 
 #include "segment_type.hpp"
+#include "../notes.hpp"
 
 #include <string>
+#include <vector>
 #include <boost/cstdint.hpp>
-
-namespace elf
-{
-    struct note;
-}
+#include <boost/utility/string_view.hpp>
 
 /*!
- * Parses the note segment and tries to interpret the contents. Some parsed
- * examples:
+ * Parses every note of a note section or segment and tries to interpret the
+ * contents. Some parsed examples:
  * "Name="GNU, Type=1, Type String="NT_GNU_ABI_TAG", Description="OS Linux 2.6.24""
  * "Name="GNU", Type=3, Type String="NT_GNU_BUILD_ID", Description="f21bf131b6da48c9bfe35b117c5b15a687174362""
+ * "Name="GNU", Type=5, Type String="NT_GNU_PROPERTY_TYPE_0", Description="x86 feature: IBT, SHSTK""
  */
 class NoteSegment : public SegmentType
 {
 public:
 
     /*
-     * Parses the note and stores the values into the member variables
+     * Parses the notes and stores them in m_notes
      * p_start the start of the binary
      * p_offset the offset to this segment
      * p_size the size of this segment
      * p_type elf::k_note
+     * p_alignment the alignment of the section or program header
+     * p_machine the e_machine of the binary
      */
     NoteSegment(const char* start, boost::uint32_t p_offset,
-                boost::uint32_t p_size, elf::section_type p_type);
+                boost::uint32_t p_size, elf::section_type p_type,
+                boost::uint64_t p_alignment, boost::uint16_t p_machine,
+                bool p_is64, bool p_isLE);
 
     //nothing of note (lol)
     ~NoteSegment();
 
+    // return the notes. they point into the binary
+    const std::vector<NoteIterator::Note>& getNotes() const;
+
+    // return the descriptor of the NT_GNU_BUILD_ID note. empty if there is none
+    boost::string_view getBuildId() const;
+
     // return the string representation of the note segment
     virtual std::string printToStdOut() const;
 
@@ -43,17 +52,16 @@ private:
     NoteSegment(const NoteSegment& p_rhs);
     NoteSegment& operator=(const NoteSegment& p_rhs);
 
-    // A pointer to the start of the note structure
-    const elf::note* m_note;
-
-    // The name of the note
-    std::string m_name;
+    // The notes in the order they are in the file
+    std::vector<NoteIterator::Note> m_notes;
 
-    // The interpreted type of the note
-    std::string m_noteType;
+    // indicates if the last note ran past the end of the segment
+    bool m_truncated;
 
-    // The interpreted description of the note
-    std::string m_description;
+    // what the descriptors are decoded for
+    boost::uint16_t m_machine;
+    bool m_is64;
+    bool m_isLE;
 };
 
 #endif
@@ -9,21 +9,18 @@ ReadOnlySegment::ReadOnlySegment(const char* start, boost::uint32_t p_offset,
     SegmentType(start, p_offset, p_size, p_type),
     m_asciiStrings()
 {
-    std::string current;
+    // the printable run ending at i starts at first
     const char* readOnly = start + p_offset;
+    boost::uint32_t first = 0;
     for (boost::uint32_t i = 0; i < p_size; ++i)
     {
-        if (isprint(static_cast<boost::uint8_t>(readOnly[i])))
+        if (!isprint(static_cast<boost::uint8_t>(readOnly[i])))
         {
-            current.push_back(readOnly[i]);
-        }
-        else
-        {
-            if (current.size() > 7)
+            if (i - first > 7)
             {
-                m_asciiStrings.insert(current);
+                m_asciiStrings.insert(boost::string_view(readOnly + first, i - first));
             }
-            current.clear();
+            first = i + 1;
         }
     }
 }
@@ -39,7 +36,7 @@ std::string ReadOnlySegment::printToStdOut() const
                  << ", size= " << std::dec << m_size << ", strings= "
                  << m_asciiStrings.size() << ")\n\t";
 
-    BOOST_FOREACH(const std::string& p_ascii, m_asciiStrings)
+    BOOST_FOREACH(const boost::string_view& p_ascii, m_asciiStrings)
     {
         return_value << "String= " << p_ascii << "\t" << std::endl;
     }
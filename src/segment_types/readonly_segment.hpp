@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
 
 /*!
  * This segment parses the read only segment looking for ascii strings
@@ -45,8 +46,8 @@ private:
     ReadOnlySegment(const ReadOnlySegment& p_rhs);
     ReadOnlySegment& operator=(const ReadOnlySegment& p_rhs);
 
-    // the ascii strings in the read only segment
-    std::set<std::string> m_asciiStrings;
+    // the ascii strings in the read only segment, viewed in the file
+    std::set<boost::string_view> m_asciiStrings;
 };
 
 #endif
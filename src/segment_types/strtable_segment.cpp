@@ -1,13 +1,10 @@
 #include "strtable_segment.hpp"
+#include "../demangler.hpp"
 
 #include <cstring>
 #include <sstream>
 #include <boost/foreach.hpp>
 
-#ifndef WINDOWS
-#include <cxxabi.h>
-#endif
-
 StringTableSegment::StringTableSegment(const char* start,
                                        boost::uint32_t p_offset,
                                        boost::uint32_t p_size,
@@ -24,8 +21,7 @@ StringTableSegment::StringTableSegment(const char* start,
         {
             break;
         }
-        std::string imported(import_function, length);
-        m_stringsSet.insert(imported);
+        m_stringsSet.insert(boost::string_view(import_function, length));
         i += length + 1;
         import_function += length + 1;
     }
@@ -42,20 +38,7 @@ std::size_t StringTableSegment::getSize() const
 
 std::string StringTableSegment::stringLookup(std::size_t p_index) const
 {
-#ifndef WINDOWS
-    char* unmangled = NULL;
-    size_t length = 0;
-    int status = 0;
-    unmangled  = abi::__cxa_demangle(m_start + p_index, unmangled,
-                                        &length, &status);
-    if (unmangled != NULL)
-    {
-        std::string fixed(unmangled);
-        free(unmangled);
-        return fixed;
-    }
-#endif
-    return std::string(m_start + p_index);
+    return Demangler::demangle(m_start + p_index);
 }
 
 std::string StringTableSegment::printToStdOut() const
@@ -64,7 +47,7 @@ std::string StringTableSegment::printToStdOut() const
     return_value << "String Table (offset= 0x" << std::hex << m_offset
         << ", size= " << std::dec << m_size << ", entries= " << m_stringsSet.size() << std::endl;
 
-    BOOST_FOREACH(const std::string& p_ascii, m_stringsSet)
+    BOOST_FOREACH(const boost::string_view& p_ascii, m_stringsSet)
     {
         return_value << "String= " << p_ascii << std::endl;
     }
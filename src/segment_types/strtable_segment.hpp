@@ -6,6 +6,7 @@
 #include <set>
 #include <string>
 #include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
 
 /*
  * Holds all the strings in the string table
@@ -46,8 +47,8 @@ private:
     StringTableSegment(const StringTableSegment& p_rhs);
     StringTableSegment& operator=(const StringTableSegment& p_rhs);
 
-    // A set of the strings in the segment
-    std::set<std::string> m_stringsSet;
+    // A set of the strings in the segment, viewed in the file
+    std::set<boost::string_view> m_stringsSet;
 
     // the start of the segment
     const char* m_start;
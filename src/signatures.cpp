@@ -0,0 +1,54 @@
+#include "signatures.hpp"
+
+#include <boost/foreach.hpp>
+
+const SignatureSet& SignatureSet::instance()
+{
+    // initialization of a function local static is thread safe
+    static const SignatureSet s_instance;
+    return s_instance;
+}
+
+SignatureSet::SignatureSet() :
+    m_values(),
+    m_signatures(),
+    m_elfMagic()
+{
+    m_values.push_back(new SearchValue("UPX!", elf::k_packed, "UPX signature found"));
+    m_values.push_back(new SearchValue("the UPX Team. All Rights Reserved", elf::k_packed, "UPX copyright string found"));
+    m_values.push_back(new SearchValue("PRIVMSG ", elf::k_irc, "IRC command PRIVMSG found"));
+    m_values.push_back(new SearchValue("JOIN ", elf::k_irc, "IRC command JOIN found"));
+    m_values.push_back(new SearchValue("NOTICE ", elf::k_irc, "IRC command NOTICE found"));
+    m_values.push_back(new SearchValue("ustar\0", elf::k_compression, "Tar Archive signature found"));
+    m_values.push_back(new SearchValue("\x1f\x8b\x08", elf::k_compression, "Gzip signature found"));
+    m_values.push_back(new SearchValue("inflate 1.1.4 Copyright 1995-2002 Mark Adler", elf::k_compression, "Inflate 1.1.4 copyright string"));
+    m_values.push_back(new SearchValue("inflate 1.2.3 Copyright 1995-2005 Mark Adler", elf::k_compression, "Inflate 1.2.3 copyright string"));
+    m_values.push_back(new SearchValue("inflate 1.2.8 Copyright 1995-2013 Mark Adler", elf::k_compression, "Inflate 1.2.8 copyright string"));
+    m_values.push_back(new SearchValue("/proc/cpuinfo", elf::k_infoGathering, "Examines /proc/cpuinfo"));
+    m_values.push_back(new SearchValue("/proc/meminfo", elf::k_infoGathering, "Examines /proc/meminfo"));
+    m_values.push_back(new SearchValue("/proc/stat", elf::k_infoGathering, "Examines /proc/stat"));
+    m_values.push_back(new SearchValue("HISTFILE=", elf::k_envVariables, "Accesses the bash history file environment variable HISTFILE."));
+    BOOST_FOREACH (SearchValue &value, m_values)
+    {
+        m_signatures.addWord(value.m_search, &value);
+    }
+    m_signatures.compile();
+
+    // the stored data is never looked at, only the offsets
+    m_elfMagic.addWord("\x7f\x45\x4c\x46", this);
+    m_elfMagic.compile();
+}
+
+SignatureSet::~SignatureSet()
+{
+}
+
+const SearchTree& SignatureSet::getSignatures() const
+{
+    return m_signatures;
+}
+
+const SearchTree& SignatureSet::getElfMagic() const
+{
+    return m_elfMagic;
+}
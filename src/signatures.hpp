@@ -0,0 +1,49 @@
+#ifndef SIGNATURES_HPP
+#define SIGNATURES_HPP
+
+#include "datastructures/search_tree.hpp"
+#include "datastructures/search_value.hpp"
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+/*
+ * The compiled byte signatures every parser scans for. Building and compiling
+ * the automata isn't free so it is done once per process and every ELFParser
+ * borrows the result. The set is never modified after construction which
+ * makes it safe to scan with from any number of threads.
+ */
+class SignatureSet
+{
+public:
+
+    // return the process wide signature set. built on first use
+    static const SignatureSet& instance();
+
+    // return the automaton holding the signatures. stored data is SearchValue*
+    const SearchTree& getSignatures() const;
+
+    // return the automaton that finds the ELF magic (embedded binaries)
+    const SearchTree& getElfMagic() const;
+
+private:
+
+    SignatureSet();
+    ~SignatureSet();
+
+    // disable evil things
+    SignatureSet(const SignatureSet& p_rhs);
+    SignatureSet& operator=(const SignatureSet& p_rhs);
+
+private:
+
+    // the values the signature automaton points at
+    boost::ptr_vector<SearchValue> m_values;
+
+    // the aho corasick search engine for the signatures
+    SearchTree m_signatures;
+
+    // the aho corasick search engine for "\x7fELF"
+    SearchTree m_elfMagic;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#include "string_pool.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+const std::size_t StringPool::k_blockSize;
+
+StringPool::StringPool() :
+    m_blocks(),
+    m_used(0),
+    m_capacity(0),
+    m_size(0)
+{
+}
+
+StringPool::~StringPool()
+{
+}
+
+boost::string_view StringPool::add(boost::string_view p_string)
+{
+    if (p_string.empty())
+    {
+        return boost::string_view();
+    }
+
+    if (m_capacity - m_used < p_string.size())
+    {
+        m_capacity = std::max(k_blockSize, p_string.size());
+        m_blocks.push_back(std::unique_ptr<char[]>(new char[m_capacity]));
+        m_used = 0;
+    }
+
+    char* copy = m_blocks.back().get() + m_used;
+    std::memcpy(copy, p_string.data(), p_string.size());
+    m_used += p_string.size();
+    m_size += p_string.size();
+    return boost::string_view(copy, p_string.size());
+}
+
+std::size_t StringPool::getSize() const
+{
+    return m_size;
+}
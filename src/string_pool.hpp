@@ -0,0 +1,54 @@
+#ifndef STRING_POOL_HPP
+#define STRING_POOL_HPP
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <boost/utility/string_view.hpp>
+
+/*
+ * An arena for the few strings that aren't in the mapped file as they are
+ * (placeholder names). The strings are copied into large
+ * blocks that are only released with the pool, so the views add() returns stay
+ * valid as long as the pool does. Everything else is a view into the file.
+ */
+class StringPool
+{
+public:
+
+    StringPool();
+    ~StringPool();
+
+    /*
+     * copies p_string into the pool
+     * return a view of the copy
+     */
+    boost::string_view add(boost::string_view p_string);
+
+    // return the number of bytes stored
+    std::size_t getSize() const;
+
+private:
+
+    // disable evil things
+    StringPool(const StringPool& p_rhs);
+    StringPool& operator=(const StringPool& p_rhs);
+
+private:
+
+    // the size of a block. longer strings get a block of their own
+    static const std::size_t k_blockSize = 16 * 1024;
+
+    std::vector<std::unique_ptr<char[]> > m_blocks;
+
+    // the bytes used in the last block
+    std::size_t m_used;
+
+    // the bytes the last block holds
+    std::size_t m_capacity;
+
+    // the number of bytes stored
+    std::size_t m_size;
+};
+
+#endif
@@ -64,7 +64,12 @@ namespace elf
             k_finiarray,
             k_init_arraysz,
             k_fini_arraysz,
-            k_gnuhash = 0x6ffffef5
+            k_gnuhash = 0x6ffffef5,
+            k_versym = 0x6ffffff0,
+            k_verdef = 0x6ffffffc,
+            k_verdefnum,
+            k_verneed,
+            k_verneednum
         };
     }
 }
@@ -0,0 +1,44 @@
+#ifndef EH_FRAME_HPP
+#define EH_FRAME_HPP
+
+#include <boost/cstdint.hpp>
+
+namespace elf
+{
+    namespace eh
+    {
+        // the version of .eh_frame_hdr
+        const boost::uint8_t k_hdrVersion = 1;
+
+        // the DW_EH_PE pointer encodings. the low bits are the format
+        const boost::uint8_t k_absptr = 0x00;
+        const boost::uint8_t k_uleb128 = 0x01;
+        const boost::uint8_t k_udata2 = 0x02;
+        const boost::uint8_t k_udata4 = 0x03;
+        const boost::uint8_t k_udata8 = 0x04;
+        const boost::uint8_t k_sleb128 = 0x09;
+        const boost::uint8_t k_sdata2 = 0x0a;
+        const boost::uint8_t k_sdata4 = 0x0b;
+        const boost::uint8_t k_sdata8 = 0x0c;
+        const boost::uint8_t k_formatMask = 0x0f;
+
+        // the high bits say what the value is relative to
+        const boost::uint8_t k_pcrel = 0x10;
+        const boost::uint8_t k_textrel = 0x20;
+        const boost::uint8_t k_datarel = 0x30;
+        const boost::uint8_t k_funcrel = 0x40;
+        const boost::uint8_t k_aligned = 0x50;
+        const boost::uint8_t k_applicationMask = 0x70;
+
+        // the value is the address of the pointer
+        const boost::uint8_t k_indirect = 0x80;
+
+        // there is no value
+        const boost::uint8_t k_omit = 0xff;
+
+        // the length of an entry that has a 64 bit length after it
+        const boost::uint32_t k_extendedLength = 0xffffffff;
+    }
+}
+
+#endif
@@ -40,7 +40,8 @@ namespace elf
         k_emPPC64,
         k_emARM = 40,
         
-        k_emx8664 = 62
+        k_emx8664 = 62,
+        k_emAArch64 = 183
         
     };
 
@@ -1,6 +1,8 @@
 #ifndef NOTE_FORMAT_HPP
 #define NOTE_FORMAT_HPP
 
+#include <boost/cstdint.hpp>
+
 namespace elf
 {
     #pragma pack(push, 1)
@@ -10,7 +12,44 @@ namespace elf
         boost::uint32_t m_descSize;
         boost::uint32_t m_type;
     };
+
+    // an entry of a NT_GNU_PROPERTY_TYPE_0 descriptor
+    struct property
+    {
+        boost::uint32_t m_type;
+        boost::uint32_t m_dataSize;
+    };
     #pragma pack(pop)
+
+    // the types of the notes named "GNU"
+    enum gnu_note_type
+    {
+        k_gnuAbiTag = 1,
+        k_gnuHwcap = 2,
+        k_gnuBuildId = 3,
+        k_gnuGoldVersion = 4,
+        k_gnuProperty = 5
+    };
+
+    // the type of the note named "Go" that holds the go build id
+    const boost::uint32_t k_goBuildId = 4;
+
+    // the property types of NT_GNU_PROPERTY_TYPE_0
+    const boost::uint32_t k_propertyStackSize = 1;
+    const boost::uint32_t k_propertyNoCopyOnProtected = 2;
+    const boost::uint32_t k_propertyAArch64Feature1And = 0xc0000000;
+    const boost::uint32_t k_propertyX86Feature1And = 0xc0000002;
+    const boost::uint32_t k_propertyX86Isa1Needed = 0xc0008002;
+    const boost::uint32_t k_propertyX86Isa1Used = 0xc0010002;
+
+    // the bits of the feature_1_and properties
+    const boost::uint32_t k_x86FeatureIBT = 1;
+    const boost::uint32_t k_x86FeatureSHSTK = 2;
+    const boost::uint32_t k_aarch64FeatureBTI = 1;
+    const boost::uint32_t k_aarch64FeaturePAC = 2;
+
+    // the bits of the x86 isa_1 properties, one per microarchitecture level
+    const boost::uint32_t k_x86IsaLevels = 4;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,65 @@
+#ifndef SYMBOL_VERSION_HPP
+#define SYMBOL_VERSION_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+namespace elf
+{
+    namespace version
+    {
+        // the same for both classes
+        struct verneed
+        {
+            boost::uint16_t m_version;
+            boost::uint16_t m_count;
+            boost::uint32_t m_file;
+            boost::uint32_t m_aux;
+            boost::uint32_t m_next;
+        };
+
+        BOOST_STATIC_ASSERT(sizeof(verneed) == 16);
+
+        struct vernaux
+        {
+            boost::uint32_t m_hash;
+            boost::uint16_t m_flags;
+            boost::uint16_t m_other;
+            boost::uint32_t m_name;
+            boost::uint32_t m_next;
+        };
+
+        BOOST_STATIC_ASSERT(sizeof(vernaux) == 16);
+
+        struct verdef
+        {
+            boost::uint16_t m_version;
+            boost::uint16_t m_flags;
+            boost::uint16_t m_index;
+            boost::uint16_t m_count;
+            boost::uint32_t m_hash;
+            boost::uint32_t m_aux;
+            boost::uint32_t m_next;
+        };
+
+        BOOST_STATIC_ASSERT(sizeof(verdef) == 20);
+
+        struct verdaux
+        {
+            boost::uint32_t m_name;
+            boost::uint32_t m_next;
+        };
+
+        BOOST_STATIC_ASSERT(sizeof(verdaux) == 8);
+
+        // the version index of a versym entry. the top bit hides the symbol
+        const boost::uint16_t k_indexMask = 0x7fff;
+        const boost::uint16_t k_hidden = 0x8000;
+
+        // the reserved indexes
+        const boost::uint16_t k_local = 0;
+        const boost::uint16_t k_global = 1;
+    }
+}
+
+#endif
@@ -0,0 +1,265 @@
+#include "symbol_hash.hpp"
+#include "abstract_symbol.hpp"
+#include "elf_view.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+namespace
+{
+    // reads a value that may not be aligned
+    template <typename Order, typename Value>
+    Value read(const char* p_data)
+    {
+        Value value;
+        std::memcpy(&value, p_data, sizeof(value));
+        return Order::get(value);
+    }
+
+    // decodes p_count 32 bit words, if they are in the file
+    template <typename Order>
+    bool readWords(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset,
+                   boost::uint64_t p_count, std::vector<boost::uint32_t>& p_words)
+    {
+        if (p_offset > p_dataSize || p_count > (p_dataSize - p_offset) / 4)
+        {
+            return false;
+        }
+
+        p_words.resize(p_count);
+        for (std::size_t i = 0; i < p_count; ++i)
+        {
+            p_words[i] = read<Order, boost::uint32_t>(p_data + p_offset + i * 4);
+        }
+        return true;
+    }
+}
+
+SymbolHash::SymbolHash() :
+    m_sysvBuckets(),
+    m_sysvChains(),
+    m_bloom(),
+    m_bloomShift(0),
+    m_bloomBits(0),
+    m_gnuBuckets(),
+    m_gnuChains(),
+    m_symOffset(0)
+{
+}
+
+SymbolHash::~SymbolHash()
+{
+}
+
+void SymbolHash::createHash(const char* p_data, boost::uint64_t p_dataSize,
+                            boost::uint64_t p_sysvOffset, boost::uint64_t p_gnuOffset,
+                            bool p_is64, bool p_isLE)
+{
+    elf::view::dispatch(p_is64, p_isLE, [&](auto p_class, auto p_order)
+    {
+        typedef decltype(p_class) Class;
+        typedef decltype(p_order) Order;
+
+        if (p_sysvOffset != 0)
+        {
+            readSysv<Class, Order>(p_data, p_dataSize, p_sysvOffset);
+        }
+        if (p_gnuOffset != 0)
+        {
+            readGnu<Class, Order>(p_data, p_dataSize, p_gnuOffset);
+        }
+    });
+}
+
+template <typename Class, typename Order>
+void SymbolHash::readSysv(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset)
+{
+    // nbucket, nchain, the buckets, the chains
+    std::vector<boost::uint32_t> header;
+    if (!readWords<Order>(p_data, p_dataSize, p_offset, 2, header) || header[0] == 0 ||
+        !readWords<Order>(p_data, p_dataSize, p_offset + 8, header[0], m_sysvBuckets) ||
+        !readWords<Order>(p_data, p_dataSize, p_offset + 8 + header[0] * 4ULL, header[1], m_sysvChains))
+    {
+        m_sysvBuckets.clear();
+        m_sysvChains.clear();
+    }
+}
+
+template <typename Class, typename Order>
+void SymbolHash::readGnu(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset)
+{
+    // nbuckets, symoffset, bloom size, bloom shift
+    std::vector<boost::uint32_t> header;
+    if (!readWords<Order>(p_data, p_dataSize, p_offset, 4, header) || header[0] == 0)
+    {
+        return;
+    }
+
+    const boost::uint64_t bloomOffset = p_offset + 16;
+    const boost::uint64_t bucketOffset = bloomOffset + header[2] * static_cast<boost::uint64_t>(sizeof(typename Class::address));
+    const boost::uint64_t chainOffset = bucketOffset + header[0] * 4ULL;
+    if (bucketOffset > p_dataSize || !readWords<Order>(p_data, p_dataSize, bucketOffset, header[0], m_gnuBuckets))
+    {
+        return;
+    }
+
+    // the buckets point at the first symbol of their chain. the last chain ends the table
+    const boost::uint32_t last = *std::max_element(m_gnuBuckets.begin(), m_gnuBuckets.end());
+    boost::uint64_t chainCount = 0;
+    if (last != 0)
+    {
+        if (last < header[1])
+        {
+            m_gnuBuckets.clear();
+            return;
+        }
+
+        for (chainCount = last - header[1]; ; ++chainCount)
+        {
+            if (chainOffset + chainCount * 4 + 4 > p_dataSize)
+            {
+                m_gnuBuckets.clear();
+                return;
+            }
+            if (read<Order, boost::uint32_t>(p_data + chainOffset + chainCount * 4) & 1)
+            {
+                ++chainCount;
+                break;
+            }
+        }
+    }
+    readWords<Order>(p_data, p_dataSize, chainOffset, chainCount, m_gnuChains);
+
+    // the filter is useless with a shift wider than the hash
+    m_bloom.resize(header[3] < 32 ? header[2] : 0);
+    for (std::size_t i = 0; i < m_bloom.size(); ++i)
+    {
+        m_bloom[i] = read<Order, typename Class::address>(p_data + bloomOffset + i * sizeof(typename Class::address));
+    }
+    m_bloomShift = header[3];
+    m_bloomBits = sizeof(typename Class::address) * 8;
+    m_symOffset = header[1];
+}
+
+bool SymbolHash::empty() const
+{
+    return m_sysvBuckets.empty() && m_gnuBuckets.empty();
+}
+
+boost::uint32_t SymbolHash::getSymbolCount() const
+{
+    if (!m_sysvBuckets.empty())
+    {
+        return m_sysvChains.size();
+    }
+    if (!m_gnuBuckets.empty())
+    {
+        return m_symOffset + m_gnuChains.size();
+    }
+    return 0;
+}
+
+std::size_t SymbolHash::getFirstHashed() const
+{
+    if (!m_gnuBuckets.empty())
+    {
+        return m_symOffset;
+    }
+    return 0;
+}
+
+const AbstractSymbol* SymbolHash::lookup(boost::string_view p_name,
+                                         const std::vector<AbstractSymbol>& p_symbols) const
+{
+    if (!m_gnuBuckets.empty())
+    {
+        return lookupGnu(p_name, p_symbols);
+    }
+    if (!m_sysvBuckets.empty())
+    {
+        return lookupSysv(p_name, p_symbols);
+    }
+    return NULL;
+}
+
+const AbstractSymbol* SymbolHash::lookupSysv(boost::string_view p_name,
+                                             const std::vector<AbstractSymbol>& p_symbols) const
+{
+    // a chain longer than the table is a loop
+    boost::uint32_t index = m_sysvBuckets[sysvHash(p_name) % m_sysvBuckets.size()];
+    for (std::size_t steps = 0; index != 0 && index < m_sysvChains.size() && steps < m_sysvChains.size(); ++steps)
+    {
+        if (index < p_symbols.size() && p_symbols[index].getName() == p_name)
+        {
+            return &p_symbols[index];
+        }
+        index = m_sysvChains[index];
+    }
+    return NULL;
+}
+
+const AbstractSymbol* SymbolHash::lookupGnu(boost::string_view p_name,
+                                            const std::vector<AbstractSymbol>& p_symbols) const
+{
+    const boost::uint32_t hash = gnuHash(p_name);
+
+    // both bits have to be set in the filter, or the name isn't there
+    if (!m_bloom.empty())
+    {
+        const boost::uint64_t word = m_bloom[(hash / m_bloomBits) % m_bloom.size()];
+        const boost::uint64_t mask = (1ULL << (hash % m_bloomBits)) |
+                                     (1ULL << ((hash >> m_bloomShift) % m_bloomBits));
+        if ((word & mask) != mask)
+        {
+            return NULL;
+        }
+    }
+
+    // an empty bucket is 0
+    boost::uint32_t index = m_gnuBuckets[hash % m_gnuBuckets.size()];
+    if (index == 0 || index < m_symOffset)
+    {
+        return NULL;
+    }
+
+    // the low bit of a chain's last hash is set
+    for ( ; index - m_symOffset < m_gnuChains.size(); ++index)
+    {
+        const boost::uint32_t chainHash = m_gnuChains[index - m_symOffset];
+        if ((chainHash | 1) == (hash | 1) && index < p_symbols.size() && p_symbols[index].getName() == p_name)
+        {
+            return &p_symbols[index];
+        }
+        if (chainHash & 1)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+boost::uint32_t SymbolHash::sysvHash(boost::string_view p_name)
+{
+    boost::uint32_t hash = 0;
+    for (std::size_t i = 0; i < p_name.size(); ++i)
+    {
+        hash = (hash << 4) + static_cast<boost::uint8_t>(p_name[i]);
+        const boost::uint32_t high = hash & 0xf0000000;
+        if (high != 0)
+        {
+            hash ^= high >> 24;
+        }
+        hash &= ~high;
+    }
+    return hash;
+}
+
+boost::uint32_t SymbolHash::gnuHash(boost::string_view p_name)
+{
+    boost::uint32_t hash = 5381;
+    for (std::size_t i = 0; i < p_name.size(); ++i)
+    {
+        hash = hash * 33 + static_cast<boost::uint8_t>(p_name[i]);
+    }
+    return hash;
+}
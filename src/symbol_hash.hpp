@@ -0,0 +1,101 @@
+#ifndef SYMBOL_HASH_HPP
+#define SYMBOL_HASH_HPP
+
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
+
+class AbstractSymbol;
+
+/*
+ * The hash tables of the dynamic symbol table: the SysV DT_HASH (buckets and
+ * chains) and DT_GNU_HASH (a Bloom filter, buckets and the chained hash
+ * values). They are decoded once into native order so a lookup walks them
+ * the way the dynamic loader does, without touching the symbols whose hash
+ * doesn't match.
+ *
+ * DT_HASH says how many dynamic symbols there are. DT_GNU_HASH doesn't, but
+ * the end of its last chain is the end of the table.
+ */
+class SymbolHash
+{
+public:
+
+    SymbolHash();
+    ~SymbolHash();
+
+    /*
+     * decodes the tables. a table at offset 0 is missing. tables that don't
+     * fit in the file are ignored
+     * p_data the start of the file
+     * p_dataSize the size of the file
+     * p_sysvOffset the file offset of DT_HASH
+     * p_gnuOffset the file offset of DT_GNU_HASH
+     */
+    void createHash(const char* p_data, boost::uint64_t p_dataSize,
+                    boost::uint64_t p_sysvOffset, boost::uint64_t p_gnuOffset,
+                    bool p_is64, bool p_isLE);
+
+    // return true if either table was decoded
+    bool empty() const;
+
+    // return the number of dynamic symbols the tables describe. 0 if unknown
+    boost::uint32_t getSymbolCount() const;
+
+    /*
+     * return the index of the first symbol the tables can find. GNU_HASH
+     * leaves out the undefined symbols at the start of the table
+     */
+    std::size_t getFirstHashed() const;
+
+    /*
+     * looks p_name up like the dynamic loader does, through DT_GNU_HASH if
+     * there is one
+     * p_symbols the dynamic symbols the tables index
+     * return the symbol. NULL if the tables don't have it
+     */
+    const AbstractSymbol* lookup(boost::string_view p_name,
+                                 const std::vector<AbstractSymbol>& p_symbols) const;
+
+    // return the SysV hash of p_name
+    static boost::uint32_t sysvHash(boost::string_view p_name);
+
+    // return the GNU hash of p_name
+    static boost::uint32_t gnuHash(boost::string_view p_name);
+
+private:
+
+    // decode the tables with the class and byte order of the binary
+    template <typename Class, typename Order>
+    void readSysv(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset);
+    template <typename Class, typename Order>
+    void readGnu(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset);
+
+    const AbstractSymbol* lookupSysv(boost::string_view p_name,
+                                     const std::vector<AbstractSymbol>& p_symbols) const;
+    const AbstractSymbol* lookupGnu(boost::string_view p_name,
+                                    const std::vector<AbstractSymbol>& p_symbols) const;
+
+    // disable evil things
+    SymbolHash(const SymbolHash& p_rhs);
+    SymbolHash& operator=(const SymbolHash& p_rhs);
+
+private:
+
+    //! the SysV buckets and chains
+    std::vector<boost::uint32_t> m_sysvBuckets;
+    std::vector<boost::uint32_t> m_sysvChains;
+
+    //! the GNU Bloom filter (words of 32 or 64 bits)
+    std::vector<boost::uint64_t> m_bloom;
+    boost::uint32_t m_bloomShift;
+    boost::uint32_t m_bloomBits;
+
+    //! the GNU buckets and the hash values of the symbols from m_symOffset on
+    std::vector<boost::uint32_t> m_gnuBuckets;
+    std::vector<boost::uint32_t> m_gnuChains;
+    boost::uint32_t m_symOffset;
+};
+
+#endif
@@ -0,0 +1,305 @@
+#include "symbol_versions.hpp"
+#include "dynamicsection.hpp"
+#include "abstract_segments.hpp"
+#include "structures/symbol_version.hpp"
+#include "elf_view.hpp"
+
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <boost/foreach.hpp>
+
+namespace
+{
+    // more entries than this in all the lists together means they loop, or
+    // point into each other
+    const std::size_t k_maxEntries = 0x8000;
+
+    const boost::string_view k_glibc("GLIBC_");
+
+    // copies a structure that may not be aligned out of the file
+    template <typename Structure>
+    bool readStructure(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_offset,
+                       Structure& p_structure)
+    {
+        if (p_offset > p_dataSize || p_dataSize - p_offset < sizeof(Structure))
+        {
+            return false;
+        }
+        std::memcpy(&p_structure, p_data + p_offset, sizeof(Structure));
+        return true;
+    }
+
+    // splits the numbers of a GLIBC_x.y.z version. empty if it isn't one
+    std::vector<boost::uint32_t> glibcNumbers(boost::string_view p_version)
+    {
+        std::vector<boost::uint32_t> numbers;
+        if (!p_version.starts_with(k_glibc))
+        {
+            return numbers;
+        }
+
+        boost::uint32_t number = 0;
+        bool digits = false;
+        for (std::size_t i = k_glibc.size(); i < p_version.size(); ++i)
+        {
+            if (p_version[i] >= '0' && p_version[i] <= '9')
+            {
+                number = number * 10 + (p_version[i] - '0');
+                digits = true;
+            }
+            else if (p_version[i] == '.' && digits)
+            {
+                numbers.push_back(number);
+                number = 0;
+                digits = false;
+            }
+            else
+            {
+                // ie GLIBC_PRIVATE
+                return std::vector<boost::uint32_t>();
+            }
+        }
+        if (digits)
+        {
+            numbers.push_back(number);
+        }
+        return numbers;
+    }
+}
+
+SymbolVersions::SymbolVersions() :
+    m_symbolVersions(),
+    m_versions(),
+    m_strings(NULL),
+    m_stringsSize(0)
+{
+}
+
+SymbolVersions::~SymbolVersions()
+{
+}
+
+void SymbolVersions::createVersions(const char* p_data, boost::uint64_t p_dataSize,
+                                    const DynamicSection& p_dynamic, const AbstractSegments& p_segments,
+                                    std::size_t p_symbolCount, bool p_is64, bool p_isLE)
+{
+    m_symbolVersions.clear();
+    m_versions.clear();
+    m_strings = NULL;
+    m_stringsSize = 0;
+
+    if (p_dynamic.getVersymVirtAddress() == 0)
+    {
+        return;
+    }
+
+    const boost::uint64_t strings = p_segments.getOffsetFromVirt(p_dynamic.getStringTableVirtualAddress());
+    if (strings != 0 && strings < p_dataSize)
+    {
+        m_strings = p_data + strings;
+        m_stringsSize = std::min(p_dynamic.getStringTableSize(), p_dataSize - strings);
+    }
+
+    const boost::uint64_t versym = p_segments.getOffsetFromVirt(p_dynamic.getVersymVirtAddress());
+    const boost::uint64_t verneed = p_dynamic.getVerneedVirtAddress() != 0 ?
+        p_segments.getOffsetFromVirt(p_dynamic.getVerneedVirtAddress()) : 0;
+    const boost::uint64_t verdef = p_dynamic.getVerdefVirtAddress() != 0 ?
+        p_segments.getOffsetFromVirt(p_dynamic.getVerdefVirtAddress()) : 0;
+
+    // the version structures are the same for both classes
+    elf::view::dispatch(p_is64, p_isLE, [&](auto, auto p_order)
+    {
+        readVersions<decltype(p_order)>(p_data, p_dataSize, versym, p_symbolCount,
+                                        verneed, p_dynamic.getVerneedCount(),
+                                        verdef, p_dynamic.getVerdefCount());
+    });
+}
+
+template <typename Order>
+void SymbolVersions::readVersions(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_versym,
+                                  std::size_t p_symbolCount, boost::uint64_t p_verneed,
+                                  boost::uint64_t p_verneedCount, boost::uint64_t p_verdef,
+                                  boost::uint64_t p_verdefCount)
+{
+    if (p_versym != 0 && p_versym < p_dataSize)
+    {
+        const std::size_t count = std::min<boost::uint64_t>(p_symbolCount, (p_dataSize - p_versym) / 2);
+        m_symbolVersions.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            boost::uint16_t entry;
+            std::memcpy(&entry, p_data + p_versym + i * 2, sizeof(entry));
+            m_symbolVersions[i] = Order::get(entry);
+        }
+    }
+
+    // every verneed, vernaux and verdef read takes one from the budget. the
+    // walk ends when it runs out
+    std::size_t budget = k_maxEntries;
+
+    // a library, then the versions needed from it. a count of 0 means unknown
+    boost::uint64_t offset = p_verneed;
+    for (std::size_t i = 0; offset != 0 && i < (p_verneedCount ? p_verneedCount : k_maxEntries) && budget != 0; ++i)
+    {
+        --budget;
+        elf::version::verneed need;
+        if (!readStructure(p_data, p_dataSize, offset, need))
+        {
+            break;
+        }
+
+        const boost::string_view file(getString(Order::get(need.m_file)));
+        boost::uint64_t auxOffset = offset + Order::get(need.m_aux);
+        for (boost::uint16_t j = 0; j < Order::get(need.m_count) && budget != 0; ++j)
+        {
+            --budget;
+            elf::version::vernaux aux;
+            if (!readStructure(p_data, p_dataSize, auxOffset, aux))
+            {
+                break;
+            }
+            setVersion(Order::get(aux.m_other), getString(Order::get(aux.m_name)), file);
+            if (aux.m_next == 0)
+            {
+                break;
+            }
+            auxOffset += Order::get(aux.m_next);
+        }
+
+        if (need.m_next == 0)
+        {
+            break;
+        }
+        offset += Order::get(need.m_next);
+    }
+
+    // the versions defined here. the first name of each is the version itself
+    offset = p_verdef;
+    for (std::size_t i = 0; offset != 0 && i < (p_verdefCount ? p_verdefCount : k_maxEntries) && budget != 0; ++i)
+    {
+        --budget;
+        elf::version::verdef definition;
+        elf::version::verdaux aux;
+        if (!readStructure(p_data, p_dataSize, offset, definition))
+        {
+            break;
+        }
+        if (readStructure(p_data, p_dataSize, offset + Order::get(definition.m_aux), aux))
+        {
+            setVersion(Order::get(definition.m_index), getString(Order::get(aux.m_name)), boost::string_view());
+        }
+
+        if (definition.m_next == 0)
+        {
+            break;
+        }
+        offset += Order::get(definition.m_next);
+    }
+}
+
+boost::string_view SymbolVersions::getString(boost::uint64_t p_offset) const
+{
+    if (m_strings == NULL || p_offset >= m_stringsSize)
+    {
+        return boost::string_view();
+    }
+
+    const char* terminator = static_cast<const char*>(std::memchr(m_strings + p_offset, 0, m_stringsSize - p_offset));
+    if (terminator == NULL)
+    {
+        return boost::string_view();
+    }
+    return boost::string_view(m_strings + p_offset, terminator - (m_strings + p_offset));
+}
+
+void SymbolVersions::setVersion(boost::uint16_t p_index, boost::string_view p_name, boost::string_view p_file)
+{
+    p_index &= elf::version::k_indexMask;
+    if (p_index <= elf::version::k_global || p_name.empty())
+    {
+        return;
+    }
+
+    if (m_versions.size() <= p_index)
+    {
+        m_versions.resize(p_index + 1);
+    }
+    m_versions[p_index].m_name = p_name;
+    m_versions[p_index].m_file = p_file;
+}
+
+const std::vector<boost::uint16_t>& SymbolVersions::getSymbolVersions() const
+{
+    return m_symbolVersions;
+}
+
+const SymbolVersions::Version* SymbolVersions::getVersion(std::size_t p_symbol) const
+{
+    if (p_symbol >= m_symbolVersions.size())
+    {
+        return NULL;
+    }
+
+    const boost::uint16_t index = m_symbolVersions[p_symbol] & elf::version::k_indexMask;
+    if (index >= m_versions.size() || m_versions[index].m_name.empty())
+    {
+        return NULL;
+    }
+    return &m_versions[index];
+}
+
+std::vector<SymbolVersions::Version> SymbolVersions::getNeeded() const
+{
+    std::vector<Version> needed;
+    BOOST_FOREACH (const Version& version, m_versions)
+    {
+        if (!version.m_file.empty())
+        {
+            needed.push_back(version);
+        }
+    }
+    return needed;
+}
+
+boost::string_view SymbolVersions::getRequiredGlibc() const
+{
+    boost::string_view newest;
+    std::vector<boost::uint32_t> newestNumbers;
+    BOOST_FOREACH (const Version& version, m_versions)
+    {
+        if (version.m_file.empty())
+        {
+            continue;
+        }
+
+        const std::vector<boost::uint32_t> numbers(glibcNumbers(version.m_name));
+        if (!numbers.empty() && (newest.empty() || newestNumbers < numbers))
+        {
+            newest = version.m_name;
+            newestNumbers = numbers;
+        }
+    }
+    return newest;
+}
+
+std::string SymbolVersions::printToStdOut() const
+{
+    std::stringstream returnValue;
+    const std::vector<Version> needed(getNeeded());
+    if (!needed.empty())
+    {
+        returnValue << "Version Needs (count=" << needed.size() << ")\n";
+        BOOST_FOREACH (const Version& version, needed)
+        {
+            returnValue << "\t file= " << version.m_file << ", version= " << version.m_name << std::endl;
+        }
+
+        const boost::string_view glibc(getRequiredGlibc());
+        if (!glibc.empty())
+        {
+            returnValue << "\t required= " << glibc << std::endl;
+        }
+    }
+    return returnValue.str();
+}
@@ -0,0 +1,97 @@
+#ifndef SYMBOL_VERSIONS_HPP
+#define SYMBOL_VERSIONS_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <boost/cstdint.hpp>
+#include <boost/utility/string_view.hpp>
+
+class DynamicSection;
+class AbstractSegments;
+
+/*
+ * The GNU symbol versions of the dynamic symbols. DT_VERSYM gives every
+ * dynamic symbol a version index. It is kept as it is: a parallel array of 16
+ * bit entries, indexed by symbol number. DT_VERNEED (the versions the binary
+ * needs from its libraries) and DT_VERDEF (the versions it provides) give
+ * each index a name. The names are views into the dynamic string table, so
+ * no string is made per symbol.
+ */
+class SymbolVersions
+{
+public:
+
+    struct Version
+    {
+        //! the version, ie GLIBC_2.14
+        boost::string_view m_name;
+
+        //! the library it is needed from. empty for a version the binary defines
+        boost::string_view m_file;
+    };
+
+    SymbolVersions();
+    ~SymbolVersions();
+
+    /*
+     * decodes the tables listed in p_dynamic
+     * p_data the start of the file
+     * p_dataSize the size of the file
+     * p_dynamic the parsed dynamic section
+     * p_segments translates the addresses of the tables
+     * p_symbolCount the number of dynamic symbols
+     */
+    void createVersions(const char* p_data, boost::uint64_t p_dataSize,
+                        const DynamicSection& p_dynamic, const AbstractSegments& p_segments,
+                        std::size_t p_symbolCount, bool p_is64, bool p_isLE);
+
+    // return the DT_VERSYM entry of every dynamic symbol
+    const std::vector<boost::uint16_t>& getSymbolVersions() const;
+
+    /*
+     * p_symbol the index of a dynamic symbol
+     * return its version. NULL for local and global symbols, or if it has none
+     */
+    const Version* getVersion(std::size_t p_symbol) const;
+
+    // return the versions needed from the libraries
+    std::vector<Version> getNeeded() const;
+
+    // return the newest GLIBC_ version needed, ie GLIBC_2.14. empty if none is
+    boost::string_view getRequiredGlibc() const;
+
+    std::string printToStdOut() const;
+
+private:
+
+    // decodes the tables with the byte order of the binary
+    template <typename Order>
+    void readVersions(const char* p_data, boost::uint64_t p_dataSize, boost::uint64_t p_versym,
+                      std::size_t p_symbolCount, boost::uint64_t p_verneed, boost::uint64_t p_verneedCount,
+                      boost::uint64_t p_verdef, boost::uint64_t p_verdefCount);
+
+    // return the string at p_offset in the dynamic string table. empty if it isn't in it
+    boost::string_view getString(boost::uint64_t p_offset) const;
+
+    // names version p_index
+    void setVersion(boost::uint16_t p_index, boost::string_view p_name, boost::string_view p_file);
+
+    // disable evil things
+    SymbolVersions(const SymbolVersions& p_rhs);
+    SymbolVersions& operator=(const SymbolVersions& p_rhs);
+
+private:
+
+    //! the DT_VERSYM entries, one per dynamic symbol
+    std::vector<boost::uint16_t> m_symbolVersions;
+
+    //! the named versions, by version index
+    std::vector<Version> m_versions;
+
+    //! the dynamic string table
+    const char* m_strings;
+    boost::uint64_t m_stringsSize;
+};
+
+#endif
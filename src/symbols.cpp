@@ -1,83 +1,98 @@
-#ifndef WINDOWS
-#include <cxxabi.h>
-#endif
-
 #include <iostream>
 #include <sstream>
-#include <boost/assign.hpp>
+#include <cstring>
+#include <algorithm>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include "symbols.hpp"
 #include "abstract_symbol.hpp"
 #include "abstract_segments.hpp"
+#include "capability_table.hpp"
 #include "structures/symtable_entry.hpp"
+#include "elf_view.hpp"
 
+namespace
+{
     // files that mark a specific functionality
-std::map<std::string, std::pair<elf::Capabilties, std::string> > files = boost::assign::map_list_of
-        ("adler32.c", std::make_pair(elf::k_compression, "Compiled with adler32.c"))
-        ("gzip.c", std::make_pair(elf::k_compression, "Compiled with gzip.c"));
-// functions that we think should be noted as dangerous
-std::map<std::string, std::pair<elf::Capabilties, std::string> > capabilities = boost::assign::map_list_of
-    ("fclose", std::make_pair(elf::k_fileFunctions, "fclose() found"))
-    ("feof", std::make_pair(elf::k_fileFunctions, "feof() found"))
-    ("fopen", std::make_pair(elf::k_fileFunctions, "fopen() found"))
-    ("fmemopen", std::make_pair(elf::k_fileFunctions, "fmemopen() found"))
-    ("funlockfile", std::make_pair(elf::k_fileFunctions, "funlockfile() found"))
-    ("unlink", std::make_pair(elf::k_fileFunctions, "unlink() found"))
-    ("accept", std::make_pair(elf::k_networkFunctions, "accept() found"))
-    ("bind", std::make_pair(elf::k_networkFunctions, "bind() found"))
-    ("connect", std::make_pair(elf::k_networkFunctions, "connect() found"))
-    ("listen", std::make_pair(elf::k_networkFunctions, "listen() found"))
-    ("socket", std::make_pair(elf::k_networkFunctions, "socket() found"))
-    ("sendto", std::make_pair(elf::k_networkFunctions, "sendto() found"))
-    ("recv", std::make_pair(elf::k_networkFunctions, "recv() found"))
-    ("gethostbyname", std::make_pair(elf::k_networkFunctions, "gethostbyname() found"))
-    ("gethostbyname_r", std::make_pair(elf::k_networkFunctions, "gethostbyname_r() found"))
-    ("inet_addr", std::make_pair(elf::k_networkFunctions, "inet_addr() found"))
-    ("fork", std::make_pair(elf::k_processManipulation, "fork() found"))
-    ("kill", std::make_pair(elf::k_processManipulation, "kill() found"))
-    ("clone", std::make_pair(elf::k_processManipulation, "clone() found"))
-    ("execve", std::make_pair(elf::k_processManipulation, "execve() found"))
-    ("execl", std::make_pair(elf::k_processManipulation, "execl() found"))
-    ("execle", std::make_pair(elf::k_processManipulation, "execle() found"))
-    ("execve", std::make_pair(elf::k_processManipulation, "execve() found"))
-    ("raise", std::make_pair(elf::k_processManipulation, "raise() found"))
-    ("daemon", std::make_pair(elf::k_processManipulation, "daemon() found"))
-    ("pclose", std::make_pair(elf::k_pipeFunctions, "pclose() found"))
-    ("popen", std::make_pair(elf::k_pipeFunctions, "popen() found"))
-    ("rand", std::make_pair(elf::k_crypto, "rand() found"))
-    ("srand", std::make_pair(elf::k_crypto, "srand() found"))
-    ("srandom_r", std::make_pair(elf::k_crypto, "srandom_r() found"))
-    ("random_r", std::make_pair(elf::k_crypto, "random_r() found"))
-    ("phys_pages_info", std::make_pair(elf::k_infoGathering, "phys_pages_info() found"))
-    ("getpagesize", std::make_pair(elf::k_infoGathering, "getpagesize() found"))
-    ("fstat", std::make_pair(elf::k_infoGathering, "fstat() found"))
-    ("uname", std::make_pair(elf::k_infoGathering, "uname() found"))
-    ("access", std::make_pair(elf::k_infoGathering, "access() found"))
-    ("sysinfo", std::make_pair(elf::k_infoGathering, "sysinfo() found"))
-    ("setenv", std::make_pair(elf::k_envVariables, "setenv() found"))
-    ("clearenv", std::make_pair(elf::k_envVariables, "clearenv() found"))
-    ("unsetenv", std::make_pair(elf::k_envVariables, "unsetenv() found"))
-    ("getenv", std::make_pair(elf::k_envVariables, "getenv() found"))
-    ("secure_getenv", std::make_pair(elf::k_envVariables, "secure_getenv() found"))
-    ("chown", std::make_pair(elf::k_permissions, "chown() found"))
-    ("chmod", std::make_pair(elf::k_permissions, "chmod() found"))
-    ("openlog", std::make_pair(elf::k_syslog, "openlog() found"))
-    ("closelog", std::make_pair(elf::k_syslog, "closelog() found"))
-    ("vsyslog", std::make_pair(elf::k_syslog, "vsyslog() found"))
-    ("pcap_open_live", std::make_pair(elf::k_packetSniff, "pcap_open_live() found"))
-    ("pcap_close", std::make_pair(elf::k_packetSniff, "pcap_close() found"))
-    ("pcap_read", std::make_pair(elf::k_packetSniff, "pcap_read() found"))
-    ("pcap_loop", std::make_pair(elf::k_packetSniff, "pcap_loop() found"))
-    ("system", std::make_pair(elf::k_shell, "system() found"))
-    ("tshd_runshell", std::make_pair(elf::k_shell, "tinysh function found."))
-    ("dlsym", std::make_pair(elf::k_hooking, "dlsym() found in hooking context"))
-    ("ptrace", std::make_pair(elf::k_antidebug, "ptrace detection found"));
-
-Symbols::Symbols()
+    const CapabilityEntry s_files[] =
+    {
+        { "adler32.c", elf::k_compression, "Compiled with adler32.c" },
+        { "gzip.c", elf::k_compression, "Compiled with gzip.c" }
+    };
+
+    // functions that we think should be noted as dangerous
+    const CapabilityEntry s_functions[] =
+    {
+        { "fclose", elf::k_fileFunctions, "fclose() found" },
+        { "feof", elf::k_fileFunctions, "feof() found" },
+        { "fopen", elf::k_fileFunctions, "fopen() found" },
+        { "fmemopen", elf::k_fileFunctions, "fmemopen() found" },
+        { "funlockfile", elf::k_fileFunctions, "funlockfile() found" },
+        { "unlink", elf::k_fileFunctions, "unlink() found" },
+        { "accept", elf::k_networkFunctions, "accept() found" },
+        { "bind", elf::k_networkFunctions, "bind() found" },
+        { "connect", elf::k_networkFunctions, "connect() found" },
+        { "listen", elf::k_networkFunctions, "listen() found" },
+        { "socket", elf::k_networkFunctions, "socket() found" },
+        { "sendto", elf::k_networkFunctions, "sendto() found" },
+        { "recv", elf::k_networkFunctions, "recv() found" },
+        { "gethostbyname", elf::k_networkFunctions, "gethostbyname() found" },
+        { "gethostbyname_r", elf::k_networkFunctions, "gethostbyname_r() found" },
+        { "inet_addr", elf::k_networkFunctions, "inet_addr() found" },
+        { "fork", elf::k_processManipulation, "fork() found" },
+        { "kill", elf::k_processManipulation, "kill() found" },
+        { "clone", elf::k_processManipulation, "clone() found" },
+        { "execl", elf::k_processManipulation, "execl() found" },
+        { "execle", elf::k_processManipulation, "execle() found" },
+        { "execve", elf::k_processManipulation, "execve() found" },
+        { "raise", elf::k_processManipulation, "raise() found" },
+        { "daemon", elf::k_processManipulation, "daemon() found" },
+        { "pclose", elf::k_pipeFunctions, "pclose() found" },
+        { "popen", elf::k_pipeFunctions, "popen() found" },
+        { "rand", elf::k_crypto, "rand() found" },
+        { "srand", elf::k_crypto, "srand() found" },
+        { "srandom_r", elf::k_crypto, "srandom_r() found" },
+        { "random_r", elf::k_crypto, "random_r() found" },
+        { "phys_pages_info", elf::k_infoGathering, "phys_pages_info() found" },
+        { "getpagesize", elf::k_infoGathering, "getpagesize() found" },
+        { "fstat", elf::k_infoGathering, "fstat() found" },
+        { "uname", elf::k_infoGathering, "uname() found" },
+        { "access", elf::k_infoGathering, "access() found" },
+        { "sysinfo", elf::k_infoGathering, "sysinfo() found" },
+        { "setenv", elf::k_envVariables, "setenv() found" },
+        { "clearenv", elf::k_envVariables, "clearenv() found" },
+        { "unsetenv", elf::k_envVariables, "unsetenv() found" },
+        { "getenv", elf::k_envVariables, "getenv() found" },
+        { "secure_getenv", elf::k_envVariables, "secure_getenv() found" },
+        { "chown", elf::k_permissions, "chown() found" },
+        { "chmod", elf::k_permissions, "chmod() found" },
+        { "openlog", elf::k_syslog, "openlog() found" },
+        { "closelog", elf::k_syslog, "closelog() found" },
+        { "vsyslog", elf::k_syslog, "vsyslog() found" },
+        { "pcap_open_live", elf::k_packetSniff, "pcap_open_live() found" },
+        { "pcap_close", elf::k_packetSniff, "pcap_close() found" },
+        { "pcap_read", elf::k_packetSniff, "pcap_read() found" },
+        { "pcap_loop", elf::k_packetSniff, "pcap_loop() found" },
+        { "system", elf::k_shell, "system() found" },
+        { "tshd_runshell", elf::k_shell, "tinysh function found." },
+        { "dlsym", elf::k_hooking, "dlsym() found in hooking context" },
+        { "ptrace", elf::k_antidebug, "ptrace detection found" }
+    };
+
+    const CapabilityTable s_fileTable(s_files, sizeof(s_files) / sizeof(s_files[0]));
+    const CapabilityTable s_functionTable(s_functions, sizeof(s_functions) / sizeof(s_functions[0]));
+}
+
+Symbols::Symbols() : m_isDY(false),
+                     m_demangle(true),
+                     m_symbols(),
+                     m_pool(),
+                     m_files(),
+                     m_byAddress(),
+                     m_definedByAddress(),
+                     m_indexed(false)
 {
-    m_isDY = false;
 }
 
 Symbols::~Symbols()
@@ -88,6 +103,16 @@ const std::vector<AbstractSymbol>& Symbols::getSymbols() const
     return m_symbols;
 }
 
+void Symbols::setDemangle(bool p_demangle)
+{
+    m_demangle = p_demangle;
+}
+
+std::string Symbols::getDisplayName(const AbstractSymbol &p_symbol) const
+{
+    return m_demangle ? p_symbol.getDemangledName() : p_symbol.getName().to_string();
+}
+
 std::set<std::string> Symbols::getFiles() const
 {
     return m_files;
@@ -103,12 +128,30 @@ void Symbols::createSymbols(const char* p_data,
                             bool p_is64, bool p_isLE, bool p_isDY)
 {
     m_isDY = p_isDY;
+    m_indexed = false;
+
+    elf::view::dispatch(p_is64, p_isLE, [&](auto p_class, auto p_order)
+    {
+        readSymbols<decltype(p_class), decltype(p_order)>(p_data, p_dataSize, p_symTabOffset,
+                                                           p_symTabSize, p_strTabOffset,
+                                                           p_strTableSize);
+    });
+}
 
-    boost::uint8_t multiplier = p_is64 ? sizeof(elf::symbol::symtable_entry64) : sizeof(elf::symbol::symtable_entry32);
+template <typename Class, typename Order>
+void Symbols::readSymbols(const char* p_data,
+                          boost::uint64_t p_dataSize,
+                          boost::uint64_t p_symTabOffset,
+                          boost::uint32_t p_symTabSize,
+                          boost::uint64_t p_strTabOffset,
+                          boost::uint64_t p_strTableSize)
+{
+    const boost::uint8_t multiplier = sizeof(typename Class::symbol);
     for (boost::uint32_t i = 0; p_symTabOffset + i < p_dataSize; i += multiplier)
     {
         // create a temp symbol to work with
-        AbstractSymbol symbol(p_data, p_symTabOffset + i, p_is64, p_isLE);
+        const elf::view::SymbolView<Class, Order> view(p_data + p_symTabOffset + i);
+        AbstractSymbol symbol(view);
 
         // we get the symbol table size from the hash in dynamic since we
         // can't rely on the section table. However, the size from the hash
@@ -123,63 +166,81 @@ void Symbols::createSymbols(const char* p_data,
         if (symbol.getNameIndex() < p_strTableSize)
         {
             // find a null terminator
-            bool nullFound = false;
-            for (std::size_t j = symbol.getNameIndex(); p_strTabOffset + j < p_dataSize; ++j)
-            {
-                if (p_data[p_strTabOffset + j] == 0)
-                {
-                    nullFound = true;
-                    break;
-                }
-            }
-            if (nullFound)
+            const boost::uint64_t start = p_strTabOffset + symbol.getNameIndex();
+            const char* terminator = NULL;
+            if (start < p_dataSize)
+                terminator = static_cast<const char*>(std::memchr(p_data + start, 0, p_dataSize - start));
+
+            if (terminator != NULL)
             {
-                if (symbol.getType() == elf::symbol::k_function)
-                {
-#ifndef WINDOWS
-                    char* unmangled = NULL;
-                    std::size_t length = 0;
-                    int status = 0;
-                    unmangled  = abi::__cxa_demangle(p_data + p_strTabOffset + symbol.getNameIndex(), unmangled, &length, &status);
-                    if (unmangled != NULL)
-                    {
-                        if (status == 0)
-                        {
-                            std::string fixed(unmangled);
-                            symbol.setName(fixed);
-                        }
-                        else
-                            symbol.setName("FailedDemangling");
-                        
-                        delete unmangled;
-                    }
-                    else
-#endif
-                        symbol.setName(p_data + p_strTabOffset + symbol.getNameIndex());
-                }
-                else
-                    symbol.setName(p_data + p_strTabOffset + symbol.getNameIndex());
+                // function names are demangled when they are displayed
+                const boost::string_view name(p_data + start, terminator - (p_data + start));
+                symbol.setName(name, symbol.getType() == elf::symbol::k_function);
             }
             else
                 symbol.setName("NoNullTerminator");
+        }
 
-            if ((symbol.getType() & 0x0f) == 4 && !symbol.getName().empty())
-                m_files.insert(symbol.getName());
+        // symbols without a name go by their value
+        if (symbol.getName().empty())
+        {
+            std::stringstream value;
+            value << "0x" << std::hex << symbol.getValue();
+            symbol.setName(m_pool.add(value.str()));
         }
+
+        if (symbol.getNameIndex() < p_strTableSize && (symbol.getType() & 0x0f) == 4)
+            m_files.insert(symbol.getName().to_string());
+
         m_symbols.push_back(symbol);
     }
 }
 
-std::string Symbols::findSymbol(boost::uint64_t p_address) const
+void Symbols::indexAddresses() const
 {
-    std::string str;
-    BOOST_FOREACH(const AbstractSymbol& entry, m_symbols)
+    m_byAddress.clear();
+    m_definedByAddress.clear();
+    m_byAddress.reserve(m_symbols.size());
+    for (std::size_t i = 0; i < m_symbols.size(); ++i)
     {
-        if (entry.getValue() == p_address)
-            str = entry.getName();
+        m_byAddress.push_back(std::make_pair(m_symbols[i].getValue(), i));
+        if (m_symbols[i].getValue() != 0 && m_symbols[i].getSectionIndex() != 0)
+            m_definedByAddress.push_back(m_byAddress.back());
     }
 
-    return str;
+    // the index breaks the ties, so the last symbol at an address sorts last
+    std::sort(m_byAddress.begin(), m_byAddress.end());
+    std::sort(m_definedByAddress.begin(), m_definedByAddress.end());
+    m_indexed = true;
+}
+
+std::string Symbols::findSymbol(boost::uint64_t p_address) const
+{
+    if (!m_indexed)
+        indexAddresses();
+
+    // the first entry past p_address. the one before it is the last at p_address
+    std::vector<std::pair<boost::uint64_t, std::size_t>>::const_iterator it =
+        std::upper_bound(m_byAddress.begin(), m_byAddress.end(),
+                         std::make_pair(p_address, static_cast<std::size_t>(-1)));
+    if (it == m_byAddress.begin() || (it - 1)->first != p_address)
+        return std::string();
+
+    return getDisplayName(m_symbols[(it - 1)->second]);
+}
+
+const AbstractSymbol *Symbols::findNearestSymbol(boost::uint64_t p_address) const
+{
+    if (!m_indexed)
+        indexAddresses();
+
+    std::vector<std::pair<boost::uint64_t, std::size_t>>::const_iterator it =
+        std::upper_bound(m_definedByAddress.begin(), m_definedByAddress.end(),
+                         std::make_pair(p_address, static_cast<std::size_t>(-1)));
+    if (it == m_definedByAddress.begin())
+        return NULL;
+
+    return &m_symbols[(it - 1)->second];
 }
 
 
@@ -190,10 +251,10 @@ void Symbols::evaluate(std::vector<std::pair<boost::int32_t, std::string> >& p_r
     {
         if ((entry.getType() & 0x0f) == elf::symbol::k_file)
         {
-            std::map<std::string, std::pair<elf::Capabilties, std::string> >::const_iterator it = files.find(entry.getName());
-            if (it != files.end())
+            const CapabilityEntry *file = s_fileTable.find(entry.getName());
+            if (file != NULL)
             {
-                p_capabilities[it->second.first].insert(it->second.second);
+                p_capabilities[file->m_capability].insert(file->m_reason);
             }
         }
         else if ((entry.getType() & 0x0f) == elf::symbol::k_function || (entry.getType() & 0x0f) == elf::symbol::k_notype)
@@ -201,14 +262,7 @@ void Symbols::evaluate(std::vector<std::pair<boost::int32_t, std::string> >& p_r
             if ((entry.getType() & 0x0f) == elf::symbol::k_notype)
                 ++noType;
 
-            std::map<std::string, std::pair<elf::Capabilties, std::string> >::const_iterator it = capabilities.find(entry.getName());
-            if (it != capabilities.end())
-            {
-                if (it->first == "dlsym" && !m_isDY)
-                    continue;
-
-                p_capabilities[it->second.first].insert(it->second.second);
-            }
+            evaluateFunction(entry, p_capabilities);
         }
     }
 
@@ -217,6 +271,29 @@ void Symbols::evaluate(std::vector<std::pair<boost::int32_t, std::string> >& p_r
         p_capabilities[elf::k_antidebug].insert("Almost all symbols marked as NO_TYPE in they symbol table");
 }
 
+void Symbols::evaluateImports(const std::vector<boost::uint32_t> &p_indexes,
+                              std::map<elf::Capabilties, std::set<std::string> > &p_capabilities) const
+{
+    BOOST_FOREACH (boost::uint32_t index, p_indexes)
+    {
+        if (index != 0 && index < m_symbols.size())
+            evaluateFunction(m_symbols[index], p_capabilities);
+    }
+}
+
+void Symbols::evaluateFunction(const AbstractSymbol &p_symbol,
+                               std::map<elf::Capabilties, std::set<std::string> > &p_capabilities) const
+{
+    const CapabilityEntry *function = s_functionTable.find(p_symbol.getName());
+    if (function == NULL)
+        return;
+
+    if (std::strcmp(function->m_name, "dlsym") == 0 && !m_isDY)
+        return;
+
+    p_capabilities[function->m_capability].insert(function->m_reason);
+}
+
 std::string Symbols::printToStdOut() const
 {
     std::stringstream returnValue;
@@ -228,7 +305,8 @@ std::string Symbols::printToStdOut() const
         {
             returnValue << "\t type= " << symbol.getTypeName() << ", binding= "
                         << symbol.getBinding() << ", value= 0x" << std::hex
-                        << symbol.getValue() << ", name= " << symbol.getName() << std::endl;
+                        << symbol.getValue() << ", name= "
+                        << getDisplayName(symbol) << std::endl;
         }
     }
     return returnValue.str();
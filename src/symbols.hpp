@@ -8,6 +8,7 @@
 #define CEXIT_SUCCESS " ";
 
 #include "abstract_symbol.hpp"
+#include "string_pool.hpp"
 #include "structures/capabilities.hpp"
 #include <set>
 #include <map>
@@ -29,9 +30,26 @@ class Symbols
 
         const std::vector<AbstractSymbol> &getSymbols() const;
 
-        // find a symbol based on a passed in address
+        // display the C++ names demangled (the default) or as they are in the file
+        void setDemangle(bool p_demangle);
+
+        // return the name of p_symbol the way it's displayed (demangled or not)
+        std::string getDisplayName(const AbstractSymbol &p_symbol) const;
+
+        /*
+            * find a symbol based on a passed in address. if several symbols
+            * are at p_address the last one wins.
+            * return the symbol's displayed name. empty if there is none
+            */
         std::string findSymbol(boost::uint64_t p_address) const;
 
+        /*
+            * find the defined symbol closest to p_address at or below it
+            * (addr2sym). undefined symbols and symbols at 0 are ignored.
+            * return the symbol. NULL if there is none
+            */
+        const AbstractSymbol *findNearestSymbol(boost::uint64_t p_address) const;
+
         // return the set of files found in the symbols
         std::set<std::string> getFiles() const;
 
@@ -43,9 +61,32 @@ class Symbols
         void evaluate(std::vector<std::pair<boost::int32_t, std::string>> &p_reasons,
                     std::map<elf::Capabilties, std::set<std::string>> &p_capabilities) const;
 
+        /*
+            * scores the functions a binary imports through its PLT
+            * p_indexes the symbol indexes of the PLT relocations. 0 and those
+            * past the table are skipped
+            * p_capabilities stores information about what the binary does
+            */
+        void evaluateImports(const std::vector<boost::uint32_t> &p_indexes,
+                             std::map<elf::Capabilties, std::set<std::string>> &p_capabilities) const;
+
         std::string printToStdOut() const;
 
     private:
+
+        // notes the capability p_symbol's name stands for, if any
+        void evaluateFunction(const AbstractSymbol &p_symbol,
+                              std::map<elf::Capabilties, std::set<std::string>> &p_capabilities) const;
+
+        // reads the symbol table with the class and byte order of the binary
+        template <typename Class, typename Order>
+        void readSymbols(const char *p_data, boost::uint64_t p_dataSize, boost::uint64_t p_symTabOffset,
+                         boost::uint32_t p_symTabSize, boost::uint64_t p_strTabOffset,
+                         boost::uint64_t p_strTableSize);
+
+        // sorts the symbols by address. done on the first lookup
+        void indexAddresses() const;
+
         #ifdef UNIT_TESTS
             FRIEND_TEST(LSTest, Sixtyfour_Intel_ls);
             FRIEND_TEST(LSTest, Thirtytwo_Intel_ls);
@@ -55,11 +96,26 @@ class Symbols
         //! indicates if the executable is an executable
         bool m_isDY;
 
+        //! indicates if the names are displayed demangled
+        bool m_demangle;
+
         //! Contains a vector
         std::vector<AbstractSymbol> m_symbols;
 
+        //! The names that aren't in the file (placeholders)
+        StringPool m_pool;
+
         //! Contains the file names listed in the symbols
         std::set<std::string> m_files;
+
+        //! (address, index into m_symbols) of every symbol, sorted
+        mutable std::vector<std::pair<boost::uint64_t, std::size_t>> m_byAddress;
+
+        //! the same for the defined symbols, for findNearestSymbol()
+        mutable std::vector<std::pair<boost::uint64_t, std::size_t>> m_definedByAddress;
+
+        //! indicates if the address indexes are up to date
+        mutable bool m_indexed;
 };
 
 #endif
@@ -0,0 +1,42 @@
+#include "gtest/gtest.h"
+#include "../address_index.hpp"
+
+#include <vector>
+
+TEST(AddressIndexTest, precedence_and_batches)
+{
+    AddressIndex index;
+    index.add(0x1000, 0x1000, 0x100);           // wins where it overlaps
+    index.add(0x800, 0x2000, 0x5000);
+    index.add(0x1800, 0, 0x9000);               // empty
+    index.add(0xfffffffffffff000ULL, 0x2000, 0); // wraps
+    index.build();
+
+    boost::uint64_t offset = 0;
+    EXPECT_FALSE(index.translate(0x7ff, offset));
+    EXPECT_TRUE(index.translate(0x800, offset));
+    EXPECT_EQ(0x5000, offset);
+    EXPECT_TRUE(index.translate(0x1800, offset));
+    EXPECT_EQ(0x900, offset);
+    EXPECT_TRUE(index.translate(0x2000, offset));
+    EXPECT_EQ(0x6800, offset);
+    EXPECT_FALSE(index.translate(0x2800, offset));
+    EXPECT_FALSE(index.translate(0xfffffffffffff800ULL, offset));
+
+    // the batch agrees with one at a time, whatever the order
+    std::vector<boost::uint64_t> addresses;
+    for (boost::uint64_t address = 0; address < 0x3000; address += 0x7f)
+    {
+        addresses.push_back(address);
+        addresses.push_back(0x3000 - address);
+    }
+    std::vector<boost::uint64_t> offsets;
+    index.translate(addresses, offsets);
+    ASSERT_EQ(addresses.size(), offsets.size());
+    for (std::size_t i = 0; i < addresses.size(); ++i)
+    {
+        boost::uint64_t expected = 0;
+        index.translate(addresses[i], expected);
+        EXPECT_EQ(expected, offsets[i]);
+    }
+}
@@ -0,0 +1,36 @@
+#include "gtest/gtest.h"
+#include "../byte_histogram.hpp"
+
+#include <string>
+#include <algorithm>
+
+TEST(ByteHistogramTest, runs_and_odd_lengths)
+{
+    // padding runs, mixed bytes and a tail that isn't a whole block
+    std::string input(1000, '\0');
+    for (std::size_t i = 300; i < input.size(); ++i)
+    {
+        input[i] = static_cast<char>(i * 7);
+    }
+    input[40] = 'x';
+
+    ByteHistogram histogram;
+    boost::uint64_t expected[256] = { 0 };
+    for (std::size_t start = 0; start < input.size(); start += 333)
+    {
+        const std::size_t length = std::min<std::size_t>(333, input.size() - start);
+        histogram.add(reinterpret_cast<const unsigned char*>(input.data()) + start, length);
+    }
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        ++expected[static_cast<unsigned char>(input[i])];
+    }
+
+    boost::uint64_t counts[256];
+    histogram.getCounts(counts);
+    EXPECT_EQ(input.size(), histogram.getTotal());
+    for (std::size_t i = 0; i < 256; ++i)
+    {
+        EXPECT_EQ(expected[i], counts[i]);
+    }
+}
@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+#include "../datastructures/search_tree.hpp"
+#include "../byte_pipeline.hpp"
+
+#include <string>
+#include <vector>
+
+namespace
+{
+    char s_he = 0;
+    char s_she = 0;
+    char s_his = 0;
+    char s_hers = 0;
+
+    void addWords(SearchTree& p_tree)
+    {
+        p_tree.addWord("he", &s_he);
+        p_tree.addWord("she", &s_she);
+        p_tree.addWord("his", &s_his);
+        p_tree.addWord("hers", &s_hers);
+    }
+}
+
+TEST(BytePipelineTest, matches_straddle_blocks)
+{
+    SearchTree tree;
+    addWords(tree);
+    tree.compile();
+
+    // put a word across every block boundary
+    std::string input(BytePipeline::k_blockSize * 3 + 100, 'x');
+    for (std::size_t i = 1; i <= 3; ++i)
+    {
+        input.replace(i * BytePipeline::k_blockSize - 2, 4, "hers");
+    }
+
+    std::vector<SearchMatch> expected;
+    tree.search(input.data(), input.size(), expected);
+
+    std::vector<SearchMatch> streamed;
+    SearchConsumer search(tree, streamed);
+    HistogramConsumer histogram;
+    BytePipeline pipeline;
+    pipeline.addConsumer(search);
+    pipeline.addConsumer(histogram);
+    pipeline.run(input.data(), input.size());
+
+    ASSERT_EQ(6, expected.size());
+    ASSERT_EQ(expected.size(), streamed.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].m_pattern, streamed[i].m_pattern);
+        EXPECT_EQ(expected[i].m_offset, streamed[i].m_offset);
+    }
+    EXPECT_EQ(input.size(), histogram.getTotal());
+    EXPECT_EQ(3, histogram.getCounts()['h']);
+}
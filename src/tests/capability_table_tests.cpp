@@ -0,0 +1,27 @@
+#include "gtest/gtest.h"
+#include "../capability_table.hpp"
+
+TEST(CapabilityTableTest, lookups)
+{
+    const CapabilityEntry entries[] =
+    {
+        { "fork", elf::k_processManipulation, "fork() found" },
+        { "socket", elf::k_networkFunctions, "socket() found" },
+        { "fork", elf::k_shell, "shadowed" }
+    };
+    const CapabilityTable table(entries, 3);
+
+    ASSERT_TRUE(table.find("fork") != NULL);
+    EXPECT_EQ(elf::k_processManipulation, table.find("fork")->m_capability);
+    EXPECT_EQ(&entries[1], table.find("socket"));
+    EXPECT_TRUE(table.find("forks") == NULL);
+    EXPECT_TRUE(table.find("") == NULL);
+
+    // names come out of the string table unterminated
+    const char name[] = "socketpair";
+    EXPECT_EQ(&entries[1], table.find(boost::string_view(name, 6)));
+
+    // fnv-1a test vectors
+    EXPECT_EQ(0x811c9dc5u, CapabilityTable::hash(""));
+    EXPECT_EQ(0xe40c292cu, CapabilityTable::hash("a"));
+}
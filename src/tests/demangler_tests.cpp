@@ -0,0 +1,20 @@
+#include "gtest/gtest.h"
+#include "../demangler.hpp"
+
+#include <string>
+
+TEST(DemanglerTest, cached_and_growing)
+{
+    EXPECT_EQ("foo(int)", Demangler::demangle("_Z3fooi"));
+    EXPECT_EQ("main", Demangler::demangle("main"));
+    EXPECT_EQ("", Demangler::demangle(""));
+
+    // a longer name than the thread's buffer holds, then a short one again
+    const std::string longName("_ZN" + std::string("31aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa") + "3barEv");
+    EXPECT_EQ(std::string(31, 'a') + "::bar()", Demangler::demangle(longName));
+    EXPECT_EQ("foo(int)", Demangler::demangle("_Z3fooi"));
+
+    // the view doesn't have to be terminated
+    const char name[] = "_Z3fooix";
+    EXPECT_EQ("foo(int)", Demangler::demangle(boost::string_view(name, 7)));
+}
@@ -0,0 +1,94 @@
+#include "gtest/gtest.h"
+#include "../byte_pipeline.hpp"
+#include "../entropy_profile.hpp"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdlib>
+
+TEST(EntropyProfileTest, windows_and_ranges)
+{
+    // random half, zeros half. the windows span block boundaries
+    std::string input(BytePipeline::k_blockSize * 2 + 3000, '\0');
+    std::srand(1);
+    for (std::size_t i = 0; i < input.size() / 2; ++i)
+    {
+        input[i] = static_cast<char>(std::rand());
+    }
+
+    EntropyProfile profile(5000, 3000);
+    profile.addRange(EntropyProfile::k_section, "random", 0, input.size() / 2, true);
+    profile.addRange(EntropyProfile::k_segment, "zeros", input.size() / 2, ~0ULL, false);
+    BytePipeline pipeline;
+    pipeline.addConsumer(profile);
+    pipeline.run(input.data(), input.size());
+
+    // every window against a histogram of its own
+    const std::vector<double>& windows(profile.getWindows());
+    ASSERT_EQ((input.size() - 5000) / 3000 + 1, windows.size());
+    for (std::size_t i = 0; i < windows.size(); ++i)
+    {
+        HistogramConsumer histogram;
+        histogram.consume(reinterpret_cast<const unsigned char*>(input.data()) + i * 3000, 5000, 0);
+        histogram.finish();
+        EXPECT_NEAR(histogram.getEntropy(), windows[i], 1e-9);
+    }
+    EXPECT_LT(7.9, profile.getMaxWindow());
+
+    ASSERT_EQ(2, profile.getRanges().size());
+    EXPECT_LT(7.9, profile.getRanges()[0].m_entropy);
+    EXPECT_EQ(0., profile.getRanges()[1].m_entropy);
+
+    // a file smaller than a window gets one window
+    EntropyProfile small;
+    small.consume(reinterpret_cast<const unsigned char*>("aabb"), 4, 0);
+    small.finish();
+    ASSERT_EQ(1, small.getWindows().size());
+    EXPECT_DOUBLE_EQ(1., small.getWindows()[0]);
+}
+
+TEST(EntropyProfileTest, overlapping_ranges)
+{
+    std::string input(BytePipeline::k_blockSize * 2 + 777, '\0');
+    std::srand(2);
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = static_cast<char>(std::rand() % (1 + i % 97));
+    }
+
+    // nested, overlapping, duplicated, empty, wrapping and past the end
+    EntropyProfile profile;
+    std::vector<std::pair<boost::uint64_t, boost::uint64_t> > ranges;
+    for (std::size_t i = 0; i < 500; ++i)
+    {
+        const boost::uint64_t offset = (i * 7919) % input.size();
+        ranges.push_back(std::make_pair(offset, (i * 104729) % (input.size() - offset + 1)));
+    }
+    ranges.push_back(ranges[3]);
+    ranges.push_back(std::make_pair(0, input.size()));
+    ranges.push_back(std::make_pair(100, 0));
+    ranges.push_back(std::make_pair(5000, ~0ULL));
+    ranges.push_back(std::make_pair(input.size() + 10, 10));
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        profile.addRange(EntropyProfile::k_section, "", ranges[i].first, ranges[i].second, false);
+    }
+
+    BytePipeline pipeline;
+    pipeline.addConsumer(profile);
+    pipeline.run(input.data(), input.size());
+
+    // every range against a histogram of its own
+    ASSERT_EQ(ranges.size(), profile.getRanges().size());
+    for (std::size_t i = 0; i < ranges.size(); ++i)
+    {
+        const std::size_t start = std::min<boost::uint64_t>(ranges[i].first, input.size());
+        const std::size_t length = std::min<boost::uint64_t>(ranges[i].second, input.size() - start);
+        HistogramConsumer histogram;
+        histogram.consume(reinterpret_cast<const unsigned char*>(input.data()) + start, length, 0);
+        histogram.finish();
+        EXPECT_NEAR(histogram.getEntropy(), profile.getRanges()[i].m_entropy, 1e-9);
+    }
+}
@@ -7,9 +7,48 @@
 #include "../segment_types/segment_type.hpp"
 #include "../dynamicsection.hpp"
 #include "../symbols.hpp"
+#include "../elf_carver.hpp"
 
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <cstring>
+#include <ctime>
 #include <boost/foreach.hpp>
 
+namespace
+{
+    std::string readFile(const std::string& p_path)
+    {
+        std::ifstream file(p_path.c_str(), std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+
+    // overwrites the little endian value at p_offset of p_data
+    template <typename Value>
+    void patch(std::string& p_data, std::size_t p_offset, Value p_value)
+    {
+        std::memcpy(&p_data[p_offset], &p_value, sizeof(p_value));
+    }
+
+    // where 64_intel_ls keeps its unwind tables
+    const std::size_t k_ehFrameHdr = 0x1759c;
+    const std::size_t k_ehFrame = 0x17cb8;
+    const std::size_t k_ehFrameSize = 0x210c;
+
+    // .gnu.version_r and .dynamic
+    const std::size_t k_verneed = 0x15b0;
+    const std::size_t k_dynamic = 0x19df0;
+
+    // .text, and where .rodata ends
+    const std::size_t k_text = 0x28b0;
+    const std::size_t k_rodataEnd = 0x1759c;
+
+    // the GNU_EH_FRAME program header and the .eh_frame section header
+    const std::size_t k_ehFrameProgram = 0x40 + 6 * 56;
+    const std::size_t k_ehFrameSection = 108296 + 17 * 64;
+}
+
 class LSTest : public testing::Test
 {
 protected:
@@ -99,7 +138,7 @@ TEST_F(LSTest, Sixtyfour_Intel_ls)
     EXPECT_EQ(4198168, m_parser.getSegments().getDynamicSection().getStringTableVirtualAddress());
     EXPECT_EQ(1427, m_parser.getSegments().getDynamicSection().getStringTableSize());
     EXPECT_EQ(4195072, m_parser.getSegments().getDynamicSection().getSymbolTableVirtAddress());
-    EXPECT_EQ(114, m_parser.getSegments().getDynamicSection().getSymbolTableSize());
+    EXPECT_EQ(129, m_parser.getSegments().getDynamicSection().getSymbolTableSize());
     EXPECT_EQ(129, m_parser.getSegments().getDynamicSymbols().getSymbols().size());
 }
 
@@ -175,7 +214,7 @@ TEST_F(LSTest, Thirtytwo_Intel_ls)
     EXPECT_EQ(0x8048a38, m_parser.getSegments().getDynamicSection().getStringTableVirtualAddress());
     EXPECT_EQ(1493, m_parser.getSegments().getDynamicSection().getStringTableSize());
     EXPECT_EQ(0x8048218, m_parser.getSegments().getDynamicSection().getSymbolTableVirtAddress());
-    EXPECT_EQ(114, m_parser.getSegments().getDynamicSection().getSymbolTableSize());
+    EXPECT_EQ(130, m_parser.getSegments().getDynamicSection().getSymbolTableSize());
     EXPECT_EQ(130, m_parser.getSegments().getDynamicSymbols().getSymbols().size());
 }
 
@@ -300,3 +339,383 @@ TEST_F(LSTest, mips_be_ping)
     EXPECT_EQ(82, m_parser.getSegments().getDynamicSection().getSymbolTableSize());
     EXPECT_EQ(82, m_parser.getSegments().getDynamicSymbols().getSymbols().size());
 }
+
+TEST_F(LSTest, carve_embedded_ls)
+{
+    // the 64 bit ls appended to the 32 bit one
+    std::ifstream outer("../src/tests/test_files/32_intel_ls", std::ios::binary);
+    std::ifstream inner("../src/tests/test_files/64_intel_ls", std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(outer)), std::istreambuf_iterator<char>());
+    const std::size_t offset = data.size();
+    data.append((std::istreambuf_iterator<char>(inner)), std::istreambuf_iterator<char>());
+
+    m_parser.parse(data.data(), data.size(), "dropper", 0);
+    m_parser.evaluate();
+    ASSERT_EQ(1, m_parser.getEmbeddedOffsets().size());
+    EXPECT_EQ(offset, m_parser.getEmbeddedOffsets()[0]);
+
+    ElfCarver carver;
+    EXPECT_EQ(1, carver.carve(m_parser));
+    EXPECT_TRUE(carver.getNotes().empty());
+    ASSERT_EQ(1, m_parser.getChildren().size());
+
+    // the child is exactly the 64 bit ls
+    ELFParser standalone;
+    standalone.parse("../src/tests/test_files/64_intel_ls");
+    standalone.evaluate();
+    const ELFParser& child(m_parser.getChildren()[0]);
+    EXPECT_EQ(offset, child.getBaseOffset());
+    EXPECT_EQ(data.size() - offset, child.getFileSize());
+    EXPECT_EQ(standalone.getScore(), child.getScore());
+    EXPECT_EQ(standalone.getSha256(), child.getSha256());
+    EXPECT_TRUE(child.getChildren().empty());
+
+    // too deep to carve
+    ELFParser shallow;
+    shallow.parse(data.data(), data.size(), "dropper", 0);
+    shallow.evaluate();
+    carver.setMaxDepth(0);
+    EXPECT_EQ(0, carver.carve(shallow));
+    EXPECT_EQ(1, carver.getNotes().size());
+}
+
+TEST_F(LSTest, section_table_columns)
+{
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    const std::vector<AbstractSectionHeader>& headers(m_parser.getSectionHeaders().getSections());
+    const SectionTable& table(m_parser.getSectionHeaders().getTable());
+    ASSERT_EQ(headers.size(), table.size());
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+        EXPECT_EQ(headers[i].getPhysOffset(), table.getOffset(i));
+        EXPECT_EQ(headers[i].getSize(), table.getSize(i));
+        EXPECT_EQ(headers[i].getVirtAddress(), table.getAddress(i));
+        EXPECT_EQ(headers[i].getType(), table.getType(i));
+        EXPECT_EQ(headers[i].getName(), table.getName(i));
+    }
+
+    // .text
+    EXPECT_EQ(13, table.findAddress(0x402900));
+    EXPECT_EQ(SectionTable::k_npos, table.findAddress(0x10000000));
+}
+
+TEST_F(LSTest, symbol_address_lookup)
+{
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    const Symbols& symbols(m_parser.getSegments().getDynamicSymbols());
+    EXPECT_EQ("_fini", symbols.findSymbol(0x41246c));
+    EXPECT_TRUE(symbols.findSymbol(0x41246d).empty());
+
+    // free is undefined, _init is the closest defined symbol below it
+    const AbstractSymbol* nearest = symbols.findNearestSymbol(0x402210);
+    ASSERT_TRUE(nearest != NULL);
+    EXPECT_EQ("_init", nearest->getName());
+    EXPECT_TRUE(symbols.findNearestSymbol(0x1000) == NULL);
+
+    nearest = m_parser.getSegments().findNearestSymbol(0x412470);
+    ASSERT_TRUE(nearest != NULL);
+    EXPECT_EQ("_fini", nearest->getName());
+}
+
+TEST_F(LSTest, relocations)
+{
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    const Relocations& relocations(m_parser.getSegments().getRelocations());
+    const std::vector<AbstractSymbol>& symbols(m_parser.getSegments().getDynamicSymbols().getSymbols());
+    ASSERT_EQ(119, relocations.getRelocations().size());
+    EXPECT_EQ(112, relocations.getPltCount());
+
+    // .rela.dyn comes first: __gmon_start__ (R_X86_64_GLOB_DAT)
+    const Relocations::Relocation& first(relocations.getRelocations()[0]);
+    EXPECT_EQ(0x619ff0, first.m_offset);
+    EXPECT_EQ(6, first.m_type);
+    ASSERT_GT(symbols.size(), first.m_symbol);
+    EXPECT_EQ("__gmon_start__", symbols[first.m_symbol].getName());
+
+    // then .rela.plt: __ctype_toupper_loc (R_X86_64_JUMP_SLOT)
+    const Relocations::Relocation& plt(relocations.getRelocations()[7]);
+    EXPECT_EQ(0x61a018, plt.m_offset);
+    EXPECT_EQ(7, plt.m_type);
+    EXPECT_EQ(1, plt.m_symbol);
+    EXPECT_EQ("__ctype_toupper_loc", symbols[plt.m_symbol].getName());
+}
+
+TEST_F(LSTest, relocations_demangled)
+{
+    // give the import of the first PLT slot a C++ name
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    const std::string::size_type name = data.find(std::string("__ctype_toupper_loc", 20));
+    ASSERT_NE(std::string::npos, name);
+    data.replace(name, 20, std::string("_ZN3foo3barEv\0\0\0\0\0\0\0", 20));
+
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+    const AbstractSegments& segments(m_parser.getSegments());
+    EXPECT_NE(std::string::npos, segments.getRelocations().printToStdOut(segments.getDynamicSymbols())
+                                     .find(", symbol= foo::bar()\n"));
+
+    m_parser.setDemangle(false);
+    EXPECT_NE(std::string::npos, segments.getRelocations().printToStdOut(segments.getDynamicSymbols())
+                                     .find(", symbol= _ZN3foo3barEv\n"));
+}
+
+TEST_F(LSTest, dynamic_hash_lookup)
+{
+    // GNU_HASH only
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    const AbstractSegments& segments(m_parser.getSegments());
+    const SymbolHash& hash(segments.getDynamicSection().getHash());
+    const std::vector<AbstractSymbol>& symbols(segments.getDynamicSymbols().getSymbols());
+    ASSERT_FALSE(hash.empty());
+    EXPECT_EQ(129, hash.getSymbolCount());
+
+    // the defined symbols are in the table, the imports before getFirstHashed() aren't
+    const AbstractSymbol* fini = hash.lookup("_fini", symbols);
+    ASSERT_TRUE(fini != NULL);
+    EXPECT_EQ(0x41246c, fini->getValue());
+    EXPECT_TRUE(hash.lookup("_fini_", symbols) == NULL);
+    EXPECT_TRUE(hash.lookup("getenv", symbols) == NULL);
+
+    const AbstractSymbol* getenv = segments.findDynamicSymbol("getenv");
+    ASSERT_TRUE(getenv != NULL);
+    EXPECT_EQ("getenv", getenv->getName());
+    EXPECT_TRUE(segments.findDynamicSymbol("tsunami") == NULL);
+
+    EXPECT_EQ(0x1505u, SymbolHash::gnuHash(""));
+    EXPECT_EQ(0x156b2bb8u, SymbolHash::gnuHash("printf"));
+    EXPECT_EQ(0x077905a6u, SymbolHash::sysvHash("printf"));
+}
+
+TEST_F(LSTest, sysv_hash_lookup)
+{
+    // SysV HASH, big endian
+    m_parser.parse("../src/tests/test_files/32_mips_be_ping");
+
+    const SymbolHash& hash(m_parser.getSegments().getDynamicSection().getHash());
+    const std::vector<AbstractSymbol>& symbols(m_parser.getSegments().getDynamicSymbols().getSymbols());
+    EXPECT_EQ(0, hash.getFirstHashed());
+
+    const AbstractSymbol* found = hash.lookup("stdout", symbols);
+    ASSERT_TRUE(found != NULL);
+    EXPECT_EQ(0x416ec0, found->getValue());
+    EXPECT_TRUE(hash.lookup("stdout_", symbols) == NULL);
+}
+
+TEST_F(LSTest, symbol_versions)
+{
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    const SymbolVersions& versions(m_parser.getSegments().getSymbolVersions());
+    EXPECT_EQ(129, versions.getSymbolVersions().size());
+    EXPECT_EQ(7, versions.getNeeded().size());
+    EXPECT_EQ("GLIBC_2.14", versions.getRequiredGlibc());
+
+    // the null symbol is local, the next two need GLIBC_2.3 and GLIBC_2.2.5
+    EXPECT_TRUE(versions.getVersion(0) == NULL);
+    const SymbolVersions::Version* version = versions.getVersion(1);
+    ASSERT_TRUE(version != NULL);
+    EXPECT_EQ("GLIBC_2.3", version->m_name);
+    EXPECT_EQ("libc.so.6", version->m_file);
+    version = versions.getVersion(2);
+    ASSERT_TRUE(version != NULL);
+    EXPECT_EQ("GLIBC_2.2.5", version->m_name);
+    EXPECT_TRUE(versions.getVersion(129) == NULL);
+}
+
+TEST_F(LSTest, symbol_versions_shared_chain)
+{
+    // the first verneed leads to 0x8000 more, all sharing one 0xffff long
+    // vernaux chain. the count of verneeds is unknown
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    const std::size_t needs = 0x8000;
+    const std::size_t auxes = 0xffff;
+    const std::size_t first = (data.size() + 15) & ~static_cast<std::size_t>(15);
+    const std::size_t chain = first + needs * 16;
+    data.resize(chain + auxes * 16, '\0');
+    for (std::size_t i = 0; i < needs; ++i)
+    {
+        const std::size_t need = first + i * 16;
+        patch<boost::uint16_t>(data, need, 1);
+        patch<boost::uint16_t>(data, need + 2, 0xffff);
+        patch<boost::uint32_t>(data, need + 8, static_cast<boost::uint32_t>(chain - need));
+        patch<boost::uint32_t>(data, need + 12, i + 1 < needs ? 16 : 0);
+    }
+    for (std::size_t i = 0; i + 1 < auxes; ++i)
+    {
+        patch<boost::uint32_t>(data, chain + i * 16 + 12, 16);
+    }
+    patch<boost::uint32_t>(data, k_verneed + 12, static_cast<boost::uint32_t>(first - k_verneed));
+    for (std::size_t entry = k_dynamic; entry < k_dynamic + 0x200; entry += 16)
+    {
+        boost::uint64_t tag = 0;
+        std::memcpy(&tag, &data[entry], sizeof(tag));
+        if (tag == 0x6fffffff)
+        {
+            patch<boost::uint64_t>(data, entry + 8, 0);
+        }
+    }
+
+    // a walk that doesn't share its budget takes billions of steps
+    const std::clock_t start = std::clock();
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+    EXPECT_GT(2., static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC);
+
+    // what was read before the chain is still there
+    const SymbolVersions& versions(m_parser.getSegments().getSymbolVersions());
+    EXPECT_EQ(129, versions.getSymbolVersions().size());
+    ASSERT_EQ(1, versions.getNeeded().size());
+    EXPECT_EQ("librt.so.1", versions.getNeeded()[0].m_file);
+}
+
+TEST_F(LSTest, notes)
+{
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    // the build id has bytes below 0x10
+    EXPECT_EQ(20, m_parser.getSegments().getBuildId().size());
+    EXPECT_EQ("21991ef334704d8b055782cfa2bc8656013c5a2f", m_parser.getBuildId());
+}
+
+TEST_F(LSTest, function_index)
+{
+    m_parser.parse("../src/tests/test_files/64_intel_ls");
+
+    // ls is stripped, the functions only come from .eh_frame_hdr
+    const FunctionIndex& index(m_parser.getSegments().getFunctionIndex());
+    ASSERT_EQ(226, index.getFunctions().size());
+    EXPECT_EQ(0x4021a0, index.getFunctions()[0].m_start);
+    EXPECT_EQ(1808, index.getFunctions()[0].m_size);
+    for (std::size_t i = 1; i < index.getFunctions().size(); ++i)
+    {
+        EXPECT_LE(index.getFunctions()[i - 1].m_start, index.getFunctions()[i].m_start);
+    }
+
+    EXPECT_EQ(&index.getFunctions()[0], index.find(0x4021a0));
+    EXPECT_EQ(&index.getFunctions()[0], index.find(0x4021a0 + 1807));
+    EXPECT_EQ(&index.getFunctions()[1], index.find(0x4028b0 + 10));
+    EXPECT_TRUE(index.find(0x40219f) == NULL);
+}
+
+TEST_F(LSTest, function_index_walk)
+{
+    ELFParser table;
+    table.parse("../src/tests/test_files/64_intel_ls");
+
+    // an unknown .eh_frame_hdr version, so .eh_frame is walked instead
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    data[k_ehFrameHdr] = 2;
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+
+    const std::vector<FunctionIndex::Function>& expected(table.getSegments().getFunctionIndex().getFunctions());
+    const std::vector<FunctionIndex::Function>& walked(m_parser.getSegments().getFunctionIndex().getFunctions());
+    ASSERT_EQ(expected.size(), walked.size());
+    for (std::size_t i = 0; i < walked.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].m_start, walked[i].m_start);
+        EXPECT_EQ(expected[i].m_size, walked[i].m_size);
+    }
+}
+
+TEST_F(LSTest, function_index_past_the_file)
+{
+    // GNU_EH_FRAME maps both tables to an offset far past the end of the file
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    patch<boost::uint64_t>(data, k_ehFrameProgram + 8, 0x7fff0000);
+    patch<boost::uint64_t>(data, k_ehFrameProgram + 16, 0x900000);
+    patch<boost::uint64_t>(data, k_ehFrameProgram + 32, 0x3000);
+    patch<boost::uint64_t>(data, k_ehFrameProgram + 40, 0x3000);
+    patch<boost::uint64_t>(data, k_ehFrameSection + 16, 0x900000);
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+
+    EXPECT_TRUE(m_parser.getSegments().getFunctionIndex().getFunctions().empty());
+}
+
+TEST_F(LSTest, function_index_garbage)
+{
+    // random tables, then tables cut off by the end of the file
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    boost::uint32_t random = 1;
+    for (std::size_t i = k_ehFrameHdr + 4; i < k_ehFrame + k_ehFrameSize; ++i)
+    {
+        random = random * 1103515245 + 12345;
+        data[i] = static_cast<char>(random >> 16);
+    }
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+
+    const std::vector<FunctionIndex::Function>& functions(m_parser.getSegments().getFunctionIndex().getFunctions());
+    for (std::size_t i = 1; i < functions.size(); ++i)
+    {
+        EXPECT_LE(functions[i - 1].m_start, functions[i].m_start);
+    }
+
+    ELFParser truncated;
+    data = readFile("../src/tests/test_files/64_intel_ls");
+    data.resize(k_ehFrame + k_ehFrameSize / 2);
+    truncated.parse(data.data(), data.size(), "ls", 0);
+    EXPECT_LT(truncated.getSegments().getFunctionIndex().getFunctions().size(), 226);
+}
+
+TEST_F(LSTest, packed_text)
+{
+    // a packed .text in a packed PT_LOAD is one packed region
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    boost::uint32_t random = 1;
+    for (std::size_t i = k_text; i < k_rodataEnd; ++i)
+    {
+        random = random * 1103515245 + 12345;
+        data[i] = static_cast<char>(random >> 16);
+    }
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+    m_parser.evaluate();
+
+    std::stringstream capabilities;
+    m_parser.printCapabilities(capabilities);
+    const std::string output(capabilities.str());
+    const std::string::size_type first = output.find("High entropy executable section .text");
+    ASSERT_NE(std::string::npos, first);
+    EXPECT_EQ(std::string::npos, output.find("High entropy executable", first + 1));
+    EXPECT_EQ(first, output.find("High entropy executable"));
+}
+
+TEST_F(LSTest, many_program_headers)
+{
+    // a program header table as big as e_phnum allows, at the end of the file
+    std::string data(readFile("../src/tests/test_files/64_intel_ls"));
+    const std::size_t count = 0xfffe;
+    const std::size_t table = data.size();
+    data.resize(table + count * 56, '\0');
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // ranges that repeat, ranges that overlap and ranges past the file
+        const std::size_t entry = table + i * 56;
+        patch<boost::uint32_t>(data, entry, 1);
+        patch<boost::uint64_t>(data, entry + 8, i % 3 == 2 ? data.size() + i : (i % 5000) * 16);
+        patch<boost::uint64_t>(data, entry + 32, 4096 + (i % 7) * 512);
+    }
+    patch<boost::uint64_t>(data, 0x20, table);
+    patch<boost::uint16_t>(data, 0x38, count);
+    m_parser.parse(data.data(), data.size(), "ls", 0);
+
+    // the ones past the file are dropped, the rest measure what they cover
+    HistogramConsumer first;
+    first.consume(reinterpret_cast<const unsigned char*>(data.data()), 4096, 0);
+    first.finish();
+
+    std::size_t segments = 0;
+    BOOST_FOREACH (const EntropyProfile::Range& range, m_parser.getEntropyProfile().getRanges())
+    {
+        if (range.m_kind == EntropyProfile::k_segment)
+        {
+            ++segments;
+            ASSERT_GT(data.size(), range.m_offset);
+            if (range.m_offset == 0 && range.m_size == 4096)
+            {
+                EXPECT_NEAR(first.getEntropy(), range.m_entropy, 1e-9);
+            }
+        }
+    }
+    EXPECT_EQ(count - count / 3, segments);
+}
@@ -0,0 +1,36 @@
+#include "gtest/gtest.h"
+#include "../notes.hpp"
+#include "../structures/elfheader.hpp"
+#include "../structures/noteformat.hpp"
+
+TEST(NoteIteratorTest, big_endian_region)
+{
+    // a property note and a build id padded to 8 bytes, then a note that
+    // runs past the end of the region
+    const unsigned char region[] =
+    {
+        0, 0, 0, 4, 0, 0, 0, 16, 0, 0, 0, 5, 'G', 'N', 'U', 0,
+        0xc0, 0, 0, 2, 0, 0, 0, 4, 0, 0, 0, 3, 0, 0, 0, 0,
+        0, 0, 0, 4, 0, 0, 0, 4, 0, 0, 0, 3, 'G', 'N', 'U', 0,
+        0x00, 0x0f, 0xa0, 0xff, 0, 0, 0, 0,
+        0, 0, 0, 4, 0, 0, 0, 100, 0, 0, 0, 1, 'G', 'N', 'U', 0
+    };
+
+    NoteIterator notes(reinterpret_cast<const char*>(region), sizeof(region), 8, false);
+    NoteIterator::Note note;
+    ASSERT_TRUE(notes.next(note));
+    EXPECT_EQ("GNU", note.m_name);
+    EXPECT_EQ("NT_GNU_PROPERTY_TYPE_0", NoteDecoder::getTypeName(note));
+    EXPECT_EQ(elf::k_x86FeatureIBT | elf::k_x86FeatureSHSTK,
+              NoteDecoder::decodeFeatures(note, elf::k_emx8664, true, false));
+    EXPECT_EQ(0, NoteDecoder::decodeFeatures(note, elf::k_emAArch64, true, false));
+    EXPECT_EQ("x86 feature: IBT, SHSTK", NoteDecoder::describe(note, elf::k_emx8664, true, false));
+
+    ASSERT_TRUE(notes.next(note));
+    EXPECT_TRUE(NoteDecoder::isNote(note, "GNU", elf::k_gnuBuildId));
+    EXPECT_EQ(reinterpret_cast<const char*>(region) + 48, note.m_description.data());
+    EXPECT_EQ("000fa0ff", NoteDecoder::decodeBuildId(note.m_description));
+
+    EXPECT_FALSE(notes.next(note));
+    EXPECT_TRUE(notes.isTruncated());
+}
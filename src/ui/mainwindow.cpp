@@ -232,11 +232,29 @@ void MainWindow::parser ( QString filename )
   m_tableItems.push_back ( tableItem );
   m_VEntropy = m_parser->getEntropy();
 
-  if ( m_VEntropy < m_Entropy )
+  // the whole file can stay under the threshold while its code is packed
+  std::string hottest;
+  double hottestEntropy = 0;
+  BOOST_FOREACH ( const EntropyProfile::Range & range, m_parser->getEntropyProfile().getRanges() )
+  {
+    if ( range.m_executable && range.m_size >= ELFParser::k_packedMinimumSize && range.m_entropy > hottestEntropy )
+    {
+      hottest = range.m_name;
+      hottestEntropy = range.m_entropy;
+    }
+  }
+
+  if ( m_VEntropy < m_Entropy && hottestEntropy < m_Entropy )
   {
     tableItem = new QTableWidgetItem (  QString::number ( m_VEntropy ) + " (Not Packed)" );
     m_ui->overviewTable->setItem ( 6, 0, tableItem );
   }
+  else if ( hottestEntropy >= m_Entropy )
+  {
+    tableItem = new QTableWidgetItem (  QString::number ( m_VEntropy ) + " (Packed: " + QString ( hottest.c_str() ) +
+                                        " " + QString::number ( hottestEntropy, 'f', 2 ) + ")" );
+    m_ui->overviewTable->setItem ( 6, 0, tableItem );
+  }
   else
   {
     tableItem = new QTableWidgetItem (  QString::number ( m_VEntropy ) + " (Packed)" );
@@ -392,7 +410,7 @@ void MainWindow::parser ( QString filename )
     tableItem = new QTableWidgetItem ( QString ( symbol.getBinding().c_str() ) );
     m_ui->symbolsTable->setItem ( i, 1, tableItem );
     m_tableItems.push_back ( tableItem );
-    tableItem = new QTableWidgetItem ( QString ( symbol.getName().c_str() ) );
+    tableItem = new QTableWidgetItem ( QString::fromStdString ( symbol.getDemangledName() ) );
     m_ui->symbolsTable->setItem ( i, 2, tableItem );
     m_tableItems.push_back ( tableItem );
     ++i;